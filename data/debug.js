@@ -4,6 +4,7 @@ class DebugConsole {
         this.isEnabled = false;
         this.maxTableRows = 24; // REDUCED from 30 to 24
         this.messageSequence = [];
+        this.lastSeq = 0; // Highest debug record seq received from the gateway
         this.init();
     }
 
@@ -36,7 +37,7 @@ class DebugConsole {
 
     async loadDebugState() {
         try {
-            const data = await ApiClient.get('/getdebugstate');
+            const data = await StatusClient.get('debug');
             this.isEnabled = data.enabled;
             this.updateToggle();
             this.updateStatusMessages();
@@ -70,23 +71,30 @@ class DebugConsole {
     // ========== MESSAGE PROCESSING ==========
     
     createMessageObject(messageData) {
+        // JSON payloads arrive embedded as-is; anything else as a string
+        const rawJson = typeof messageData.message === 'string'
+            ? messageData.message
+            : JSON.stringify(messageData.message);
+
         try {
-            const parsed = JSON.parse(messageData.message);
+            const parsed = typeof messageData.message === 'string'
+                ? JSON.parse(messageData.message)
+                : messageData.message;
             
             if (parsed.type === "batch_separator") {
                 return {
                     isSeparator: true,
                     message: parsed.message || "Query Loop Completed",
                     realTime: messageData.realTime || this.getCurrentTime(),
-                    rawJson: messageData.message
+                    rawJson
                 };
             }
             
             return {
-                deviceName: parsed.name || 'Unknown',
-                deviceId: parsed.id || 'N/A',
+                deviceName: messageData.name || parsed.name || 'Unknown',
+                deviceId: messageData.id || parsed.id || 'N/A',
                 topic: messageData.topic,
-                rawJson: messageData.message,
+                rawJson,
                 realTime: messageData.realTime || this.getCurrentTime(),
                 sincePrev: messageData.timeDelta || "+0ms",
                 sinceSame: messageData.sameDeviceDelta || "+0ms",
@@ -99,7 +107,7 @@ class DebugConsole {
                 deviceName: 'Parse Error',
                 deviceId: 'N/A',
                 topic: messageData.topic,
-                rawJson: messageData.message,
+                rawJson,
                 realTime: messageData.realTime || this.getCurrentTime(),
                 sincePrev: messageData.timeDelta || "+0ms",
                 sinceSame: messageData.sameDeviceDelta || "+0ms",
@@ -353,16 +361,39 @@ class DebugConsole {
     async checkForMessages() {
         if (!this.isEnabled) return;
 
+        const since = this.lastSeq;
         try {
-            const messages = await ApiClient.get('/getdebugmessages');
-            messages.forEach(msg => this.addTableRow(msg));
+            const messages = await ApiClient.get(`/getdebugmessages?since=${since}`);
+            
+            // Only newer records are returned, unless the gateway restarted and replays from 1
+            if (messages.some(msg => msg.seq <= since)) {
+                this.lastSeq = 0;
+            }
+            messages.forEach(msg => this.acceptMessage(msg));
         } catch (error) {
             // Silent fail - no new messages
         }
     }
 
+    acceptMessage(msg) {
+        // Live events and the catch-up fetch after (re)connecting may overlap
+        if (msg.seq <= this.lastSeq) return;
+        this.lastSeq = msg.seq;
+        this.addTableRow(msg);
+    }
+
     startMessagePolling() {
-        setInterval(() => this.checkForMessages(), 3000);
+        // Pushed live over /events; polling only while the stream is down
+        LiveFeed.on('debug', (msg) => {
+            if (!this.isEnabled) return;
+            // Records too large for an event are only announced; fetch them
+            if (msg.more) this.checkForMessages();
+            else this.acceptMessage(msg);
+        });
+        LiveFeed.on('open', () => this.checkForMessages());
+        setInterval(() => {
+            if (!LiveFeed.connected) this.checkForMessages();
+        }, 3000);
     }
 
     refreshUI() {
@@ -35,8 +35,11 @@ class WifiManager {
     }
 
     startAutoRefresh() {
-        // Auto-refresh IP info every 5 seconds (more frequent for connection status)
-        setInterval(() => this.loadIPInfo(), 5000);
+        // WiFi state is pushed on change; poll every 5 seconds only without the live feed
+        LiveFeed.on('wifi', (data) => this.updateIPDisplay(data));
+        setInterval(() => {
+            if (!LiveFeed.connected) this.loadIPInfo();
+        }, 5000);
     }
 
     async loadSettings() {
@@ -57,6 +60,16 @@ class WifiManager {
                 FormHelper.setValue(id, value);
             });
             
+            const mqttConfig = await ApiClient.get('/getmqttconfig');
+            FormHelper.setValue('sparkplug_group', mqttConfig.groupId);
+            FormHelper.setValue('sparkplug_node', mqttConfig.edgeNodeId);
+            FormHelper.setValue('queue_policy', mqttConfig.queuePolicy || 'drop_oldest');
+            
+            const timeConfig = await ApiClient.get('/gettimeconfig');
+            FormHelper.setValue('ntp_server', timeConfig.ntpServer || '');
+            const sparkplugToggle = FormHelper.getElement('sparkplug_enabled');
+            if (sparkplugToggle) sparkplugToggle.checked = !!mqttConfig.sparkplug;
+            
         } catch (error) {
             // Error handled by ApiClient
         }
@@ -77,6 +90,15 @@ class WifiManager {
 
         try {
             await ApiClient.postForm('/savewifi', formData);
+            await ApiClient.post('/savemqttconfig', {
+                sparkplug: !!FormHelper.getElement('sparkplug_enabled')?.checked,
+                groupId: FormHelper.getValue('sparkplug_group') || 'ModBus',
+                edgeNodeId: FormHelper.getValue('sparkplug_node'),
+                queuePolicy: FormHelper.getValue('queue_policy') || 'drop_oldest'
+            });
+            await ApiClient.post('/savetimeconfig', {
+                ntpServer: FormHelper.getValue('ntp_server') || 'pool.ntp.org'
+            });
             StatusManager.showStatus(
                 'WiFi & MQTT settings saved successfully!', 
                 'success'
@@ -88,7 +110,7 @@ class WifiManager {
 
     async loadIPInfo() {
         try {
-            const data = await ApiClient.get('/getipinfo');
+            const data = await StatusClient.get('ip');
             this.updateIPDisplay(data);
         } catch (error) {
             // Error handled by ApiClient
@@ -6,6 +6,7 @@ class SlavesManager {
         this.pollInterval = 10;
         this.timeout = 1;
         this.statsPollInterval = null;
+        this.latestStats = new Map();
         this.MAX_SLAVES = 9;
         this.queryEnabled = false;
         this.init();
@@ -39,6 +40,7 @@ class SlavesManager {
             await Promise.all([
                 this.loadSlaveConfig(),
                 this.loadPollingConfig(),
+                this.loadDeviceTypes(),
             ]);
         } catch (error) {
             console.error('Error loading configurations:', error);
@@ -52,7 +54,7 @@ class SlavesManager {
     const statusSpan = document.getElementById('queryStatus');
     
     if (toggleCheckbox) {
-        // ALWAYS START DISABLED - no localStorage
+        // Real state arrives with the polling config - the gateway persists it
         this.queryEnabled = false;
         toggleCheckbox.checked = false;
         this.updateQueryStatusDisplay();
@@ -61,7 +63,6 @@ class SlavesManager {
             this.queryEnabled = e.target.checked;
             this.updateQueryStatusDisplay();
             this.sendQueryToggleState();
-            // No localStorage - state won't be remembered
         });
     }
 }
@@ -292,6 +293,31 @@ class SlavesManager {
         }
     }
 
+    // Device types come from templates.json, so templates added on the gateway show up here
+    async loadDeviceTypes() {
+        const select = document.getElementById('device_type');
+        if (!select) return;
+        
+        try {
+            const templates = await ApiClient.get('/gettemplates');
+            const types = Object.keys(templates || {});
+            if (types.length === 0) return;
+            
+            const current = select.value;
+            select.innerHTML = '';
+            types.forEach(type => {
+                const option = document.createElement('option');
+                option.value = type;
+                option.textContent = type;
+                select.appendChild(option);
+            });
+            select.value = types.includes(current) ? current : types[0];
+            select.dispatchEvent(new Event('change'));
+        } catch (error) {
+            // Keep the built-in list
+        }
+    }
+
     async savePollingConfig() {
         const interval = FormHelper.getValue('poll_interval');
         const timeoutValue = FormHelper.getValue('timeout');
@@ -302,14 +328,17 @@ class SlavesManager {
         }
 
         try {
+            const mode = FormHelper.getValue('poll_mode') || 'fixed_delay';
             await ApiClient.post('/savepollingconfig', { 
                 pollInterval: parseInt(interval), 
-                timeout: parseInt(timeoutValue) 
+                timeout: parseInt(timeoutValue),
+                mode: mode,
+                align: !!FormHelper.getElement('poll_align')?.checked
             });
             
             this.pollInterval = parseInt(interval);
             this.timeout = parseInt(timeoutValue);
-            StatusManager.showStatus(`Polling config saved: ${this.pollInterval}s interval, ${this.timeout}s timeout`, 'success');
+            StatusManager.showStatus(`Polling config saved: ${this.pollInterval}s interval, ${this.timeout}s timeout, ${mode.replace('_', ' ')}`, 'success');
         } catch (error) {
             // Error handled by ApiClient
         }
@@ -317,12 +346,20 @@ class SlavesManager {
 
     async loadPollingConfig() {
         try {
-            const config = await ApiClient.get('/getpollingconfig');
+            const config = await StatusClient.get('polling');
             this.pollInterval = config.pollInterval || 10;
             this.timeout = config.timeout || 1;
             
             FormHelper.setValue('poll_interval', this.pollInterval);
             FormHelper.setValue('timeout', this.timeout);
+            FormHelper.setValue('poll_mode', config.mode || 'fixed_delay');
+            const alignToggle = FormHelper.getElement('poll_align');
+            if (alignToggle) alignToggle.checked = !!config.align;
+            
+            this.queryEnabled = !!config.enabled;
+            const queryToggle = FormHelper.getElement('queryToggle');
+            if (queryToggle) queryToggle.checked = this.queryEnabled;
+            this.updateQueryStatusDisplay();
             
             StatusManager.showStatus(`Polling config loaded: ${this.pollInterval}s interval, ${this.timeout}s timeout`, 'success');
         } catch (error) {
@@ -333,12 +370,21 @@ class SlavesManager {
     // ==================== STATISTICS MANAGEMENT ====================
 
     startStatsPolling() {
-        this.statsPollInterval = setInterval(() => this.fetchStatistics(), 3000);
+        // Each query result arrives as a single-slave 'stats' event
+        LiveFeed.on('stats', (stats) => {
+            this.latestStats.set(`${stats.slaveId}:${stats.slaveName}`, stats);
+            this.updateStatsDisplay([...this.latestStats.values()]);
+        });
+        LiveFeed.on('open', () => this.fetchStatistics());
+        this.statsPollInterval = setInterval(() => {
+            if (!LiveFeed.connected) this.fetchStatistics();
+        }, 3000);
     }
 
     async fetchStatistics() {
         try {
-            const statsArray = await ApiClient.get('/getstatistics');
+            const statsArray = await StatusClient.get('stats');
+            this.latestStats = new Map(statsArray.map(stats => [`${stats.slaveId}:${stats.slaveName}`, stats]));
             this.updateStatsDisplay(statsArray);
         } catch (error) {
             console.log('Error fetching statistics:', error);
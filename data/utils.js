@@ -97,6 +97,76 @@ class ApiClient {
     }
 }
 
+// ==================== STATUS CLIENT ====================
+
+class StatusClient {
+    static fields = new Set();
+    static pending = null;
+
+    // Sections asked for in the same tick share one /api/status request;
+    // the browser revalidates with the ETag, so an unchanged poll is a 304
+    static get(field) {
+        this.fields.add(field);
+        if (!this.pending) {
+            this.pending = Promise.resolve().then(() => {
+                const fields = [...this.fields].join(',');
+                this.fields.clear();
+                this.pending = null;
+                return ApiClient.get(`/api/status?fields=${fields}`);
+            });
+        }
+        return this.pending.then(status => status[field]);
+    }
+}
+
+// ==================== LIVE FEED (SERVER-SENT EVENTS) ====================
+
+class LiveFeed {
+    static source = null;
+    static connected = false;
+    static handlers = {};
+
+    // Subscribe to a device event ('debug', 'stats', 'wifi'); opens the stream on first use
+    static on(eventName, handler) {
+        if (!this.handlers[eventName]) {
+            this.handlers[eventName] = [];
+            this.source?.addEventListener(eventName, (e) => this.dispatch(eventName, e));
+        }
+        this.handlers[eventName].push(handler);
+        this.connect();
+    }
+
+    static connect() {
+        if (this.source || typeof EventSource === 'undefined') return;
+
+        this.source = new EventSource('/events');
+        Object.keys(this.handlers).forEach(name => {
+            this.source.addEventListener(name, (e) => this.dispatch(name, e));
+        });
+
+        this.source.onopen = () => {
+            this.connected = true;
+            this.dispatch('open', null);
+        };
+        this.source.onerror = () => {
+            // Polling takes over until the browser reconnects on its own
+            this.connected = false;
+        };
+    }
+
+    static dispatch(eventName, e) {
+        let data = null;
+        if (e) {
+            try {
+                data = JSON.parse(e.data);
+            } catch {
+                return;
+            }
+        }
+        (this.handlers[eventName] || []).forEach(handler => handler(data));
+    }
+}
+
 // ==================== FORM HELPER ====================
 
 class FormHelper {
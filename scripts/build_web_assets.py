@@ -0,0 +1,117 @@
+"""
+PlatformIO pre-script: builds the LittleFS image from data/ as minified,
+gzipped, content-hashed web assets.
+
+    data/style.css  ->  www/style.<hash>.css.gz   (served as /style.<hash>.css)
+    data/index.html ->  www/index.<hash>.html.gz  (served as /index.html)
+
+HTML references to the other assets are rewritten to the hashed names so
+those can be cached forever; the HTML itself is revalidated by ETag.
+Files that are not web assets are copied unchanged.
+"""
+
+import gzip
+import hashlib
+import os
+import re
+import shutil
+
+WEB_EXTENSIONS = (".html", ".css", ".js")
+ASSET_DIR = "www"
+HASH_LENGTH = 8
+
+
+def minify_css(text):
+    text = re.sub(r"/\*.*?\*/", "", text, flags=re.S)
+    text = re.sub(r"\s+", " ", text)
+    text = re.sub(r"\s*([{};,>])\s*", r"\1", text)
+    text = re.sub(r":\s+", ":", text)
+    return text.replace(";}", "}").strip()
+
+
+def minify_js(text):
+    # Conservative: only whole-line comments and indentation, so strings,
+    # template literals and regex literals are never touched
+    lines = []
+    for line in text.splitlines():
+        stripped = line.strip()
+        if not stripped or stripped.startswith("//"):
+            continue
+        lines.append(stripped)
+    return "\n".join(lines)
+
+
+def minify_html(text):
+    text = re.sub(r"<!--.*?-->", "", text, flags=re.S)
+    return "\n".join(line.strip() for line in text.splitlines() if line.strip())
+
+
+MINIFIERS = {".css": minify_css, ".js": minify_js, ".html": minify_html}
+
+
+def content_hash(data):
+    return hashlib.sha1(data).hexdigest()[:HASH_LENGTH]
+
+
+def write_gzip(path, data):
+    # mtime=0 keeps the image byte-identical between builds
+    with open(path, "wb") as out:
+        out.write(gzip.compress(data, compresslevel=9, mtime=0))
+
+
+def build_web_assets(source_dir, output_dir):
+    if os.path.isdir(output_dir):
+        shutil.rmtree(output_dir)
+    asset_dir = os.path.join(output_dir, ASSET_DIR)
+    os.makedirs(asset_dir)
+
+    hashed_names = {}
+    html_files = []
+
+    for name in sorted(os.listdir(source_dir)):
+        source_path = os.path.join(source_dir, name)
+        if not os.path.isfile(source_path):
+            continue
+
+        stem, ext = os.path.splitext(name)
+        if ext not in WEB_EXTENSIONS:
+            shutil.copy2(source_path, os.path.join(output_dir, name))
+            continue
+
+        with open(source_path, encoding="utf-8") as f:
+            text = MINIFIERS[ext](f.read())
+
+        if ext == ".html":
+            html_files.append((stem, ext, text))
+            continue
+
+        data = text.encode("utf-8")
+        hashed = "%s.%s%s" % (stem, content_hash(data), ext)
+        hashed_names[name] = hashed
+        write_gzip(os.path.join(asset_dir, hashed + ".gz"), data)
+
+    # HTML last: its hash has to cover the rewritten asset names
+    for stem, ext, text in html_files:
+        for original, hashed in hashed_names.items():
+            pattern = r'((?:href|src)=")/?%s"' % re.escape(original)
+            text = re.sub(pattern, lambda m, hashed=hashed: m.group(1) + hashed + '"', text)
+        data = text.encode("utf-8")
+        write_gzip(os.path.join(asset_dir, "%s.%s%s.gz" % (stem, content_hash(data), ext)), data)
+
+    print("Web assets: %d files -> %s" % (len(hashed_names) + len(html_files), asset_dir))
+
+
+try:
+    Import("env")  # noqa: F821 - provided by PlatformIO
+except NameError:
+    env = None
+
+if env is not None:
+    source = env.subst("$PROJECT_DATA_DIR")
+    output = os.path.join(env.subst("$BUILD_DIR"), "webdata")
+    build_web_assets(source, output)
+    env.Replace(PROJECT_DATA_DIR=output)
+elif __name__ == "__main__":
+    import sys
+    build_web_assets(sys.argv[1] if len(sys.argv) > 1 else "data",
+                     sys.argv[2] if len(sys.argv) > 2 else "webdata")
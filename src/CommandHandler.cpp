@@ -0,0 +1,175 @@
+#include "CommandHandler.h"
+#include "MQTTHandler.h"
+#include "PublishQueue.h"
+#include "ModBusHandler.h"
+#include "TaskScheduler.h"
+
+// ==================== COMMAND TOPICS ====================
+
+String getCommandTopic() {
+    return String(kGatewayTopicRoot) + "/" + getGatewayId() + "/cmd";
+}
+
+String getResponseTopic() {
+    return String(kGatewayTopicRoot) + "/" + getGatewayId() + "/resp";
+}
+
+bool isCommandTopic(const char* topic) {
+    return getCommandTopic() == topic;
+}
+
+void subscribeCommandTopic() {
+    String topic = getCommandTopic();
+    if (mqttClient.subscribe(topic.c_str())) {
+        Serial.printf("📥 Listening for commands on %s\n", topic.c_str());
+    } else {
+        Serial.printf("❌ Failed to subscribe to %s\n", topic.c_str());
+    }
+}
+
+// ==================== RESPONSES ====================
+
+void publishCommandResponse(const char* correlationId, const char* command, const char* error, JsonObjectConst data) {
+    JsonDocument doc;
+    doc["cid"] = correlationId;
+    doc["cmd"] = command;
+    doc["status"] = (error == nullptr) ? "ok" : "error";
+    if (error != nullptr) {
+        doc["message"] = error;
+    }
+    if (!data.isNull()) {
+        doc["data"] = data;
+    }
+
+    String output;
+    serializeJson(doc, output);
+
+    // Every response answers a distinct request - never coalesce them away
+    String topic = getResponseTopic();
+    enqueuePublish(topic.c_str(), reinterpret_cast<const uint8_t*>(output.c_str()), output.length(), false, false);
+
+    Serial.printf("📨 Command %s [%s] → %s\n", command, correlationId, error == nullptr ? "ok" : error);
+}
+
+// ==================== COMMAND PARSING ====================
+
+/**
+ * @brief Fill the slave key (id + name) of a bus command; both are required
+ *        because ids are only unique per device type.
+ */
+bool resolveCommandSlave(JsonDocument& doc, BusCommand& command, const char* commandName) {
+    uint8_t slaveId = doc["id"] | 0;
+    const char* slaveName = doc["name"];
+
+    if (slaveId == 0 || slaveName == nullptr || findSlaveIndex(slaveId, slaveName) < 0) {
+        publishCommandResponse(command.correlationId, commandName, "Unknown slave (id and name required)");
+        return false;
+    }
+
+    command.slaveId = slaveId;
+    strlcpy(command.slaveName, slaveName, sizeof(command.slaveName));
+    return true;
+}
+
+bool parseWriteValues(JsonDocument& doc, BusCommand& command) {
+    if (!doc["register"].is<uint16_t>()) return false;
+    command.startRegister = doc["register"];
+
+    if (doc["value"].is<uint16_t>()) {
+        command.values[0] = doc["value"];
+        command.valueCount = 1;
+        return true;
+    }
+
+    JsonArray values = doc["values"];
+    if (values.isNull() || values.size() == 0 || values.size() > kMaxWriteRegisters) return false;
+
+    for (JsonVariant value : values) {
+        if (!value.is<uint16_t>()) return false;
+        command.values[command.valueCount++] = value.as<uint16_t>();
+    }
+    return true;
+}
+
+void handleSetPollCommand(JsonDocument& doc, const char* correlationId) {
+    int interval = doc["pollInterval"] | (int)(pollInterval / 1000);
+    int timeout = doc["timeout"] | (int)(timeoutDuration / 1000);
+
+    if (interval < kMinPollIntervalSeconds || interval > kMaxPollIntervalSeconds) {
+        publishCommandResponse(correlationId, "setPoll", "pollInterval must be 1-86400 seconds");
+        return;
+    }
+    if (timeout < kMinTimeoutSeconds || timeout > kMaxTimeoutSeconds) {
+        publishCommandResponse(correlationId, "setPoll", "timeout must be 1-60 seconds");
+        return;
+    }
+
+    // Persisted first, so a failed write leaves the running schedule untouched
+    PollSchedule schedule = { parsePollMode(doc["mode"] | getPollModeName(pollSchedule.mode)),
+                              doc["align"] | pollSchedule.alignToClock };
+    if (!savePollingConfig(interval, timeout, schedule, false)) {
+        publishCommandResponse(correlationId, "setPoll", "Failed to persist polling config");
+        return;
+    }
+
+    // Timing only - the slave table stays as it is
+    updatePollInterval(interval);
+    updateTimeout(timeout);
+    updatePollSchedule(schedule.mode, schedule.alignToClock);
+    publishCommandResponse(correlationId, "setPoll", nullptr);
+}
+
+void handleMqttCommand(const uint8_t* payload, unsigned int length) {
+    if (length > kMaxCommandPayload) {
+        publishCommandResponse("", "", "Command too large");
+        return;
+    }
+
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, payload, length);
+    if (error) {
+        publishCommandResponse("", "", "Invalid JSON");
+        return;
+    }
+
+    const char* commandName = doc["cmd"] | "";
+
+    BusCommand command = {};
+    strlcpy(command.correlationId, doc["cid"] | "", sizeof(command.correlationId));
+
+    Serial.printf("📩 MQTT command: %s [%s]\n", commandName, command.correlationId);
+
+    if (strcmp(commandName, "setPoll") == 0) {
+        handleSetPollCommand(doc, command.correlationId);
+        return;
+    }
+
+    if (strcmp(commandName, "read") == 0) {
+        command.type = BUS_CMD_READ;
+    } else if (strcmp(commandName, "write") == 0) {
+        command.type = BUS_CMD_WRITE;
+        if (!parseWriteValues(doc, command)) {
+            publishCommandResponse(command.correlationId, commandName, "register and value (or values[] up to 16) required");
+            return;
+        }
+    } else if (strcmp(commandName, "patchSlave") == 0) {
+        command.type = BUS_CMD_PATCH;
+        if (!doc["patch"].is<JsonObject>()) {
+            publishCommandResponse(command.correlationId, commandName, "patch object required");
+            return;
+        }
+    } else {
+        publishCommandResponse(command.correlationId, commandName, "Unknown command");
+        return;
+    }
+
+    if (!resolveCommandSlave(doc, command, commandName)) return;
+
+    if (!queueBusCommand(command, doc["patch"].as<JsonObject>())) {
+        publishCommandResponse(command.correlationId, commandName, "Busy - previous command still pending");
+        return;
+    }
+
+    // Served by the modbus task, between polls or straight away when polling is off
+    wakeScheduler();
+}
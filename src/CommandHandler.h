@@ -0,0 +1,19 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// ==================== COMMAND TOPIC CONSTANTS ====================
+constexpr const char* kGatewayTopicRoot = "modbus";     // modbus/<gatewayId>/cmd, /resp, /health
+constexpr size_t kMaxCommandPayload = 768;
+
+// ==================== COMMAND TOPICS ====================
+String getCommandTopic();
+String getResponseTopic();
+bool isCommandTopic(const char* topic);
+void subscribeCommandTopic();
+
+// ==================== COMMAND PROCESSING ====================
+void handleMqttCommand(const uint8_t* payload, unsigned int length);
+void publishCommandResponse(const char* correlationId, const char* command, const char* error,
+                            JsonObjectConst data = JsonObjectConst());
@@ -0,0 +1,287 @@
+#include "ConfigBlob.h"
+#include "ConfigStore.h"
+#include "ModBusHandler.h"
+#include "ParamCache.h"
+#include <LittleFS.h>
+#include <coredecls.h>
+
+// ==================== GLOBAL VARIABLES ====================
+
+bool configBlobStale = false;       // Saved config changed; recompile once the write-back settles
+
+// ==================== COMPILE ====================
+
+/**
+ * @brief Feed bytes to the running CRC and, when a file is given, to flash
+ */
+bool emitBlobBytes(File* file, const void* data, size_t length, uint32_t& crc, uint32_t& total) {
+    crc = crc32(data, length, crc);
+    total += length;
+    return file == nullptr || file->write(static_cast<const uint8_t*>(data), length) == length;
+}
+
+/**
+ * @brief Distinct decode programs in first-use order; slaves share them in the blob
+ *        as they do in RAM
+ */
+int collectBlobPrograms(const DecodeProgram** programs) {
+    int count = 0;
+    for (int i = 0; i < slaveCount; i++) {
+        int index = 0;
+        while (index < count && programs[index] != slaves[i].program) {
+            index++;
+        }
+        if (index == count) {
+            programs[count++] = slaves[i].program;
+        }
+    }
+    return count;
+}
+
+uint8_t findBlobProgram(const DecodeProgram* const* programs, int count, const DecodeProgram* program) {
+    for (int i = 0; i < count; i++) {
+        if (programs[i] == program) return i;
+    }
+    return 0;
+}
+
+/**
+ * @brief Walk the resolved slave table once. Called twice when compiling: first
+ *        without a file to size and checksum the payload, then to write it.
+ */
+bool emitBlobPayload(File* file, const DecodeProgram* const* programs, int programCount, uint32_t& crc,
+                     uint32_t& total) {
+    crc = 0xffffffff;
+    total = 0;
+
+    for (int p = 0; p < programCount; p++) {
+        const DecodeProgram& program = *programs[p];
+
+        ConfigBlobProgram record = {};
+        record.opCount = program.opCount;
+        record.namesLength = program.namesLength;
+
+        if (!emitBlobBytes(file, &record, sizeof(record), crc, total) ||
+            !emitBlobBytes(file, program.ops, program.opCount * sizeof(DecodeOp), crc, total) ||
+            !emitBlobBytes(file, program.names, program.namesLength, crc, total)) {
+            return false;
+        }
+    }
+
+    for (int i = 0; i < slaveCount; i++) {
+        const SensorSlave& slave = slaves[i];
+
+        ConfigBlobSlave record = {};
+        record.id = slave.id;
+        record.program = findBlobProgram(programs, programCount, slave.program);
+        record.registerSize = slave.registerSize;
+        record.nameLength = slave.name.length();
+        record.startRegister = slave.startRegister;
+        record.registerCount = slave.registerCount;
+        record.ct = slave.ct;
+        record.pt = slave.pt;
+        record.topicLength = slave.mqttTopic.length();
+
+        if (!emitBlobBytes(file, &record, sizeof(record), crc, total) ||
+            !emitBlobBytes(file, slave.config, sizeof(DeviceParams), crc, total) ||
+            !emitBlobBytes(file, slave.name.c_str(), record.nameLength, crc, total) ||
+            !emitBlobBytes(file, slave.mqttTopic.c_str(), record.topicLength, crc, total)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Snapshot the live slave table and poll settings. The table is what
+ *        modbusReloadSlaves() resolved from the saved files, so no JSON is touched.
+ */
+bool compileConfigBlob() {
+    configBlobStale = false;    // A failed write is not retried; boot just stays on JSON
+    
+    for (int i = 0; i < slaveCount; i++) {
+        if (slaves[i].name.length() > 255 || slaves[i].mqttTopic.length() > 255) {
+            Serial.printf("⚠️  Slave %s does not fit the config blob, boot stays on JSON\n", slaves[i].name.c_str());
+            return false;
+        }
+    }
+
+    const DecodeProgram** programs = new const DecodeProgram*[slaveCount + 1];
+    int programCount = collectBlobPrograms(programs);
+    if (programCount > 255) {
+        delete[] programs;
+        Serial.println("⚠️  Too many decode programs for the config blob, boot stays on JSON");
+        return false;
+    }
+
+    ConfigBlobHeader header = {};
+    header.magic = kConfigBlobMagic;
+    header.version = kConfigBlobVersion;
+    header.configBytes = sizeof(DeviceParams);
+    header.slaveCount = slaveCount;
+    header.programCount = programCount;
+    header.pollIntervalSeconds = pollInterval / 1000;
+    header.timeoutSeconds = timeoutDuration / 1000;
+    header.pollMode = pollSchedule.mode;
+    header.alignToClock = pollSchedule.alignToClock;
+    header.queriesEnabled = modbusQueriesEnabled;
+    emitBlobPayload(nullptr, programs, programCount, header.crc, header.payloadLength);
+
+    File file = LittleFS.open(kConfigBlobTempPath, "w");
+    if (!file) {
+        delete[] programs;
+        Serial.println("❌ Failed to open config.bin.tmp for writing");
+        return false;
+    }
+
+    uint32_t crc, written;
+    bool ok = file.write(reinterpret_cast<const uint8_t*>(&header), sizeof(header)) == sizeof(header) &&
+              emitBlobPayload(&file, programs, programCount, crc, written);
+    file.close();
+    delete[] programs;
+
+    if (!ok || crc != header.crc) {
+        Serial.println("❌ Failed to write config blob");
+        LittleFS.remove(kConfigBlobTempPath);
+        return false;
+    }
+
+    if (!LittleFS.rename(kConfigBlobTempPath, kConfigBlobPath)) {
+        Serial.println("❌ Failed to replace config.bin");
+        return false;
+    }
+
+    Serial.printf("✅ Compiled config blob: %d slaves, %d decode programs, %u bytes\n", slaveCount, programCount,
+                  (unsigned)(sizeof(header) + header.payloadLength));
+    return true;
+}
+
+// ==================== LOAD ====================
+
+bool readBlobBytes(File& file, void* data, size_t length, uint32_t& crc) {
+    if (file.read(static_cast<uint8_t*>(data), length) != length) return false;
+    crc = crc32(data, length, crc);
+    return true;
+}
+
+/**
+ * @brief Read and intern one decode program. Interned before the CRC is known;
+ *        a rejected blob's programs are freed with its slave table.
+ */
+const DecodeProgram* readBlobProgram(File& file, uint32_t& crc) {
+    ConfigBlobProgram record;
+    if (!readBlobBytes(file, &record, sizeof(record), crc) || record.opCount > kMaxRegisterFields) {
+        return nullptr;
+    }
+
+    DecodeOp* ops = new DecodeOp[record.opCount];
+    char* names = new char[record.namesLength];
+    if (!readBlobBytes(file, ops, record.opCount * sizeof(DecodeOp), crc) ||
+        !readBlobBytes(file, names, record.namesLength, crc) ||
+        (record.namesLength > 0 && names[record.namesLength - 1] != '\0')) {
+        delete[] ops;
+        delete[] names;
+        return nullptr;
+    }
+    return internDecodeProgram(ops, record.opCount, names, record.namesLength);
+}
+
+/**
+ * @brief Boot path: build the slave table straight from config.bin. Any mismatch
+ *        (missing, old layout, bad CRC) returns false and the caller falls back to
+ *        parsing slaves.json and templates.json.
+ */
+bool loadConfigBlob() {
+    File file = LittleFS.open(kConfigBlobPath, "r");
+    if (!file) return false;
+
+    ConfigBlobHeader header;
+    bool valid = file.read(reinterpret_cast<uint8_t*>(&header), sizeof(header)) == sizeof(header) &&
+                 header.magic == kConfigBlobMagic && header.version == kConfigBlobVersion &&
+                 header.configBytes == sizeof(DeviceParams) &&
+                 header.payloadLength == file.size() - sizeof(header);
+    if (!valid) {
+        file.close();
+        Serial.println("⚠️  Config blob missing or outdated, loading JSON");
+        return false;
+    }
+
+    SensorSlave* table = (header.slaveCount > 0) ? new SensorSlave[header.slaveCount]() : nullptr;
+    const DecodeProgram** programs = new const DecodeProgram*[header.programCount + 1];
+    char text[256];
+    uint32_t crc = 0xffffffff;
+
+    for (uint16_t p = 0; p < header.programCount && valid; p++) {
+        programs[p] = readBlobProgram(file, crc);
+        valid = (programs[p] != nullptr);
+    }
+
+    for (uint16_t i = 0; i < header.slaveCount && valid; i++) {
+        SensorSlave& slave = table[i];
+        ConfigBlobSlave record;
+        DeviceParams params;
+
+        valid = readBlobBytes(file, &record, sizeof(record), crc) &&
+                readBlobBytes(file, &params, sizeof(params), crc) &&
+                record.program < header.programCount;
+        if (!valid) break;
+
+        slave.program = programs[record.program];
+        slave.config = internDeviceParams(params);
+        slave.id = record.id;
+        slave.registerSize = static_cast<RegisterSize>(record.registerSize);
+        slave.startRegister = record.startRegister;
+        slave.registerCount = record.registerCount;
+        slave.ct = record.ct;
+        slave.pt = record.pt;
+
+        valid = readBlobBytes(file, text, record.nameLength, crc);
+        text[record.nameLength] = '\0';
+        slave.name = text;
+
+        valid = valid && readBlobBytes(file, text, record.topicLength, crc);
+        text[record.topicLength] = '\0';
+        slave.mqttTopic = text;
+    }
+    file.close();
+    delete[] programs;
+
+    if (!valid || crc != header.crc) {
+        delete[] table;
+        releaseUnusedParams();
+        Serial.println("❌ Config blob failed its CRC check, loading JSON");
+        return false;
+    }
+
+    updatePollInterval(header.pollIntervalSeconds);
+    updateTimeout(header.timeoutSeconds);
+    updatePollSchedule(static_cast<PollMode>(header.pollMode), header.alignToClock);
+    modbusQueriesEnabled = header.queriesEnabled;
+    installBootSlaves(table, header.slaveCount);
+
+    Serial.printf("✅ Loaded %d slaves from config blob\n", header.slaveCount);
+    return true;
+}
+
+// ==================== INVALIDATION ====================
+
+/**
+ * @brief Called before any config file is rewritten. The blob is removed first so
+ *        a power cut mid-save can never boot from a blob older than the JSON.
+ */
+void invalidateConfigBlob() {
+    if (LittleFS.exists(kConfigBlobPath)) {
+        LittleFS.remove(kConfigBlobPath);
+    }
+    configBlobStale = true;
+}
+
+void markConfigBlobStale() {
+    configBlobStale = true;
+}
+
+void serviceConfigBlob() {
+    // Wait for slaves.json to be written; the slave table already reflects the edit
+    if (!configBlobStale || isSlaveConfigDirty()) return;
+    compileConfigBlob();
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <Arduino.h>
+#include "RegisterMap.h"
+
+// ==================== CONFIG BLOB CONSTANTS ====================
+constexpr const char* kConfigBlobPath = "/config.bin";
+constexpr const char* kConfigBlobTempPath = "/config.bin.tmp";   // Written, then renamed over kConfigBlobPath
+constexpr uint32_t kConfigBlobMagic = 0x42474643;                // "CFGB"
+constexpr uint16_t kConfigBlobVersion = 4;                       // Bump when the record layout changes
+
+// ==================== BLOB FORMAT ====================
+
+/**
+ * @brief File header. The CRC covers everything after the header; configBytes
+ *        rejects a blob written by firmware with a different parameter layout.
+ *        The decode programs come first, then the slaves that index them.
+ */
+struct ConfigBlobHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t configBytes;
+    uint32_t payloadLength;
+    uint32_t crc;
+    uint16_t slaveCount;
+    uint16_t programCount;
+    uint32_t pollIntervalSeconds;   // Up to kMaxPollIntervalSeconds, past uint16_t
+    uint32_t timeoutSeconds;
+    uint8_t pollMode;
+    uint8_t alignToClock;
+    uint8_t queriesEnabled;
+};
+
+/**
+ * @brief One compiled register map. Followed by the ops, then the output names.
+ */
+struct ConfigBlobProgram {
+    uint8_t opCount;
+    uint8_t reserved;
+    uint16_t namesLength;
+};
+
+/**
+ * @brief One resolved slave (template merged with its override). Followed by the
+ *        device parameter bytes, then the name and topic without terminators.
+ */
+struct ConfigBlobSlave {
+    uint8_t id;
+    uint8_t program;            // Index into the blob's programs
+    uint8_t registerSize;
+    uint8_t nameLength;
+    uint16_t startRegister;
+    uint16_t registerCount;
+    float ct;
+    float pt;
+    uint8_t topicLength;
+    uint8_t reserved[3];
+};
+
+// Records are written and read as raw bytes: a layout change must bump kConfigBlobVersion
+static_assert(sizeof(ConfigBlobHeader) == 32, "ConfigBlobHeader layout changed; bump kConfigBlobVersion");
+static_assert(sizeof(ConfigBlobProgram) == 4, "ConfigBlobProgram layout changed; bump kConfigBlobVersion");
+static_assert(sizeof(ConfigBlobSlave) == 20, "ConfigBlobSlave layout changed; bump kConfigBlobVersion");
+static_assert(sizeof(DecodeOp) == 16, "DecodeOp layout changed; bump kConfigBlobVersion");
+
+// ==================== CONFIG BLOB API ====================
+bool loadConfigBlob();
+bool compileConfigBlob();
+void invalidateConfigBlob();
+void markConfigBlobStale();
+void serviceConfigBlob();
@@ -0,0 +1,198 @@
+#include "ConfigStore.h"
+#include "FSHandler.h"
+
+// ==================== GLOBAL VARIABLES ====================
+
+JsonDocument slaveConfigDoc;
+JsonDocument replacedSlaveConfigDoc;    // Live slaves' sources until the next reload
+bool holdingReplacedConfig = false;
+bool configStoreLoaded = false;
+bool configDirty = false;
+unsigned long firstDirtyTime = 0;
+unsigned long lastDirtyTime = 0;
+uint32_t slaveConfigVersion = 0;        // Bumped on every edit; keys views derived from the config
+
+// Slot holds the slave's array position + 1, 0 = empty
+uint16_t* slaveIndexSlots = nullptr;
+JsonObject* slaveIndexObjects = nullptr;
+size_t slaveIndexMask = 0;
+bool slaveIndexValid = false;
+
+// ==================== RESIDENT SLAVE CONFIG ====================
+
+bool loadConfigStore() {
+    if (configStoreLoaded) return true;
+
+    if (!loadSlaveConfig(slaveConfigDoc)) {
+        // Start from an empty model so the first save creates the file
+        slaveConfigDoc.clear();
+        slaveConfigDoc["slaves"].to<JsonArray>();
+        configStoreLoaded = true;
+        return false;
+    }
+
+    if (!slaveConfigDoc["slaves"].is<JsonArray>()) {
+        slaveConfigDoc["slaves"].to<JsonArray>();
+    }
+    configStoreLoaded = true;
+    return true;
+}
+
+JsonDocument& getSlaveConfigDoc() {
+    loadConfigStore();
+    return slaveConfigDoc;
+}
+
+JsonArray getConfiguredSlaves() {
+    return getSlaveConfigDoc()["slaves"].as<JsonArray>();
+}
+
+// ==================== ID+NAME INDEX ====================
+// Built on the first lookup after the list is loaded or replaced. Edits made in
+// place keep both the array positions and the id/name keys, so they keep it valid.
+
+uint32_t hashSlaveKey(uint8_t slaveId, const char* slaveName) {
+    // FNV-1a over the id byte followed by the name
+    uint32_t hash = 2166136261u;
+    hash = (hash ^ slaveId) * 16777619u;
+    for (const char* c = slaveName; *c != '\0'; c++) {
+        hash = (hash ^ (uint8_t)*c) * 16777619u;
+    }
+    return hash;
+}
+
+void freeSlaveIndex() {
+    delete[] slaveIndexSlots;
+    delete[] slaveIndexObjects;
+    slaveIndexSlots = nullptr;
+    slaveIndexObjects = nullptr;
+    slaveIndexMask = 0;
+}
+
+/**
+ * @brief Open addressing at load <= 1/2; duplicates probe in array order, so the
+ *        first entry wins as with the old linear scan
+ */
+void buildSlaveIndex() {
+    freeSlaveIndex();
+
+    JsonArray storedSlaves = getConfiguredSlaves();
+    size_t storedCount = storedSlaves.size();
+    size_t slotCount = 4;
+    while (slotCount < storedCount * 2) {
+        slotCount <<= 1;
+    }
+    slaveIndexMask = slotCount - 1;
+    slaveIndexSlots = new uint16_t[slotCount]();
+    slaveIndexObjects = new JsonObject[storedCount > 0 ? storedCount : 1];
+
+    size_t position = 0;
+    for (JsonObject stored : storedSlaves) {
+        slaveIndexObjects[position] = stored;
+        const char* name = stored["name"];
+        if (name != nullptr) {
+            size_t slot = hashSlaveKey(stored["id"], name) & slaveIndexMask;
+            while (slaveIndexSlots[slot] != 0) {
+                slot = (slot + 1) & slaveIndexMask;
+            }
+            slaveIndexSlots[slot] = position + 1;
+        }
+        position++;
+    }
+    slaveIndexValid = true;
+}
+
+JsonObject findSlaveConfig(uint8_t slaveId, const char* slaveName) {
+    if (slaveName == nullptr) return JsonObject();
+    if (!slaveIndexValid) buildSlaveIndex();
+
+    for (size_t slot = hashSlaveKey(slaveId, slaveName) & slaveIndexMask; slaveIndexSlots[slot] != 0;
+         slot = (slot + 1) & slaveIndexMask) {
+        JsonObject stored = slaveIndexObjects[slaveIndexSlots[slot] - 1];
+        if (stored["id"] == slaveId && strcmp(stored["name"], slaveName) == 0) {
+            return stored;
+        }
+    }
+    return JsonObject();
+}
+
+uint32_t getSlaveConfigVersion() {
+    return slaveConfigVersion;
+}
+
+/**
+ * @brief Copy each stored slave's override onto the matching entry of a new list,
+ *        one index lookup per new slave
+ */
+void carryOverOverrides(JsonArray newSlaves) {
+    for (JsonObject newSlave : newSlaves) {
+        JsonObject stored = findSlaveConfig(newSlave["id"], newSlave["name"]);
+        if (stored["override"].is<JsonObject>()) {
+            newSlave["override"] = stored["override"];
+        }
+    }
+}
+
+// ==================== WHOLE-LIST REPLACEMENT ====================
+
+/**
+ * @brief Adopt a whole new slave list (moved in, not copied) and schedule the write.
+ *        The list the live slaves were built from stays allocated until the reload
+ *        has diffed against it.
+ */
+void replaceSlaveConfig(JsonDocument& config) {
+    if (!holdingReplacedConfig) {
+        replacedSlaveConfigDoc = std::move(slaveConfigDoc);
+        holdingReplacedConfig = true;
+    }
+    slaveConfigDoc = std::move(config);
+    if (!slaveConfigDoc["slaves"].is<JsonArray>()) {
+        slaveConfigDoc["slaves"].to<JsonArray>();
+    }
+    configStoreLoaded = true;
+    slaveIndexValid = false;
+    markSlaveConfigDirty();
+}
+
+void releaseReplacedSlaveConfig() {
+    replacedSlaveConfigDoc.clear();
+    replacedSlaveConfigDoc.shrinkToFit();
+    holdingReplacedConfig = false;
+}
+
+// ==================== WRITE-BACK ====================
+
+void markSlaveConfigDirty() {
+    unsigned long now = millis();
+    if (!configDirty) {
+        firstDirtyTime = now;
+    }
+    lastDirtyTime = now;
+    configDirty = true;
+    slaveConfigVersion++;
+}
+
+bool isSlaveConfigDirty() {
+    return configDirty;
+}
+
+bool flushSlaveConfig() {
+    if (!configDirty) return true;
+
+    if (!saveSlaveConfig(slaveConfigDoc)) {
+        // Stay dirty and retry after another quiet period
+        firstDirtyTime = lastDirtyTime = millis();
+        return false;
+    }
+    configDirty = false;
+    return true;
+}
+
+void serviceConfigStore() {
+    if (!configDirty) return;
+
+    unsigned long now = millis();
+    if (now - lastDirtyTime >= kConfigWriteBackDelay || now - firstDirtyTime >= kConfigMaxWriteDelay) {
+        flushSlaveConfig();
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// ==================== CONFIG STORE CONSTANTS ====================
+constexpr unsigned long kConfigWriteBackDelay = 2000;    // Quiet time before an edit is flushed
+constexpr unsigned long kConfigMaxWriteDelay = 10000;    // Upper bound while edits keep arriving
+
+// ==================== RESIDENT SLAVE CONFIG ====================
+// slaves.json is parsed once and kept in RAM as the source of truth; handlers
+// edit it in place and the file is rewritten behind them.
+bool loadConfigStore();
+JsonDocument& getSlaveConfigDoc();
+JsonArray getConfiguredSlaves();
+JsonObject findSlaveConfig(uint8_t slaveId, const char* slaveName);   // Hashed on id+name
+uint32_t getSlaveConfigVersion();
+void replaceSlaveConfig(JsonDocument& config);
+void releaseReplacedSlaveConfig();
+void carryOverOverrides(JsonArray newSlaves);
+
+// ==================== WRITE-BACK ====================
+void markSlaveConfigDirty();
+bool isSlaveConfigDirty();
+bool flushSlaveConfig();
+void serviceConfigStore();
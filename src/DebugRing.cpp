@@ -0,0 +1,279 @@
+#include "DebugRing.h"
+
+// ==================== RECORD LAYOUT ====================
+// Records are stored as [header][topic][name][timeDelta][sameDeviceDelta][message]
+// without terminators, in the same early-wrapping byte ring as the publish queue.
+// The message is the payload exactly as published, so a JSON payload is emitted
+// as-is instead of being escaped into a string a second time.
+
+struct DebugRecord {
+    uint16_t size;              // Whole record incl. header, 4-byte aligned
+    uint16_t messageLength;
+    uint32_t seq;
+    uint32_t timestamp;
+    uint8_t slaveId;
+    uint8_t topicLength;
+    uint8_t nameLength;
+    uint8_t timeDeltaLength;
+    uint8_t sameDeltaLength;
+    uint8_t flags;
+    char realTime[kDebugTimeLength];
+};
+
+constexpr uint8_t kDebugHasSlave = 0x01;
+constexpr uint8_t kDebugRawJson = 0x02;
+
+// ==================== GLOBAL VARIABLES ====================
+
+alignas(4) uint8_t debugArena[kDebugRingBytes];
+size_t debugHead = 0;
+size_t debugTail = 0;
+size_t debugWrapEnd = 0;        // 0 = not wrapped
+uint16_t debugCount = 0;
+uint32_t debugNextSeq = 1;      // Keeps counting across clears so readers' cursors stay valid
+
+// ==================== RING HELPERS ====================
+
+DebugRecord* debugRecordAt(size_t offset) {
+    return reinterpret_cast<DebugRecord*>(debugArena + offset);
+}
+
+size_t advanceDebugOffset(size_t offset) {
+    offset += debugRecordAt(offset)->size;
+    if (debugWrapEnd != 0 && offset >= debugWrapEnd) {
+        offset = 0;
+    }
+    return offset;
+}
+
+bool debugRingHasRoom(size_t size) {
+    if (debugCount == 0) {
+        debugHead = debugTail = debugWrapEnd = 0;
+        return size <= kDebugRingBytes;
+    }
+    if (debugWrapEnd == 0) {
+        return (kDebugRingBytes - debugTail >= size) || (debugHead >= size);
+    }
+    return (debugHead - debugTail) >= size;
+}
+
+void popDebugHead() {
+    debugHead = advanceDebugOffset(debugHead);
+    if (debugHead == 0) {
+        debugWrapEnd = 0;
+    }
+    if (--debugCount == 0) {
+        debugHead = debugTail = debugWrapEnd = 0;
+    }
+}
+
+uint8_t clampFieldLength(const char* text) {
+    if (text == nullptr) return 0;
+    size_t length = strlen(text);
+    return length > 255 ? 255 : length;
+}
+
+bool looksLikeJson(const char* message, size_t length) {
+    return length > 0 && (message[0] == '{' || message[0] == '[');
+}
+
+// ==================== JSON OUTPUT ====================
+
+/**
+ * @brief The String operations formatDebugRecord uses, over a caller's buffer.
+ *        Anything past the end is dropped and flagged.
+ */
+struct FixedJsonWriter {
+    char* buffer;
+    size_t size;
+    size_t used;
+    bool overflow;
+
+    size_t length() const { return used; }
+    void reserve(size_t) {}
+    void concat(const char* text, size_t count) {
+        if (used + count >= size) {
+            overflow = true;
+            return;
+        }
+        memcpy(buffer + used, text, count);
+        used += count;
+        buffer[used] = '\0';
+    }
+    FixedJsonWriter& operator+=(char c) {
+        concat(&c, 1);
+        return *this;
+    }
+    FixedJsonWriter& operator+=(const char* text) {
+        concat(text, strlen(text));
+        return *this;
+    }
+    FixedJsonWriter& operator+=(uint32_t value) {
+        char digits[11];
+        snprintf(digits, sizeof(digits), "%lu", (unsigned long)value);
+        return *this += digits;
+    }
+};
+
+template <typename Out>
+void appendJsonString(Out& out, const char* text, size_t length) {
+    out += '"';
+    for (size_t i = 0; i < length; i++) {
+        char c = text[i];
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if ((uint8_t)c < 0x20) {
+            char escaped[7];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+template <typename Out>
+void appendJsonField(Out& out, const char* key, const char* text, size_t length) {
+    out += ",\"";
+    out += key;
+    out += "\":";
+    appendJsonString(out, text, length);
+}
+
+template <typename Out>
+void formatDebugRecord(const DebugRecord* record, Out& out) {
+    const char* topic = reinterpret_cast<const char*>(record + 1);
+    const char* name = topic + record->topicLength;
+    const char* timeDelta = name + record->nameLength;
+    const char* sameDelta = timeDelta + record->timeDeltaLength;
+    const char* message = sameDelta + record->sameDeltaLength;
+
+    out.reserve(out.length() + record->size + 128);
+
+    out += "{\"seq\":";
+    out += (uint32_t)record->seq;
+    appendJsonField(out, "topic", topic, record->topicLength);
+    if (record->flags & kDebugHasSlave) {
+        out += ",\"id\":";
+        out += (uint32_t)record->slaveId;
+        appendJsonField(out, "name", name, record->nameLength);
+    }
+    out += ",\"message\":";
+    if (record->flags & kDebugRawJson) {
+        out.concat(message, record->messageLength);
+    } else {
+        appendJsonString(out, message, record->messageLength);
+    }
+    out += ",\"timestamp\":";
+    out += (uint32_t)record->timestamp;
+    appendJsonField(out, "timeDelta", timeDelta, record->timeDeltaLength);
+    appendJsonField(out, "sameDeviceDelta", sameDelta, record->sameDeltaLength);
+    appendJsonField(out, "realTime", record->realTime, strnlen(record->realTime, kDebugTimeLength));
+    out += '}';
+}
+
+// ==================== DEBUG RING OPERATIONS ====================
+
+uint32_t pushDebugRecord(const char* topic, const char* message, const char* timeDelta, const char* sameDeviceDelta,
+                         uint8_t slaveId, const char* slaveName, const char* realTime) {
+    uint8_t topicLength = clampFieldLength(topic);
+    uint8_t nameLength = clampFieldLength(slaveName);
+    uint8_t timeDeltaLength = clampFieldLength(timeDelta);
+    uint8_t sameDeltaLength = clampFieldLength(sameDeviceDelta);
+    size_t messageLength = strlen(message);
+
+    size_t recordSize = (sizeof(DebugRecord) + topicLength + nameLength + timeDeltaLength +
+                         sameDeltaLength + messageLength + 3) & ~(size_t)3;
+
+    if (recordSize > kMaxDebugRecordBytes) {
+        Serial.printf("⚠️ Debug message for %s too large for ring (%d bytes)\n", topic, messageLength);
+        return 0;
+    }
+
+    while (!debugRingHasRoom(recordSize)) {
+        popDebugHead();
+    }
+
+    if (debugWrapEnd == 0 && kDebugRingBytes - debugTail < recordSize) {
+        debugWrapEnd = debugTail;
+        debugTail = 0;
+    }
+
+    DebugRecord* record = debugRecordAt(debugTail);
+    record->size = recordSize;
+    record->messageLength = messageLength;
+    record->seq = debugNextSeq++;
+    record->timestamp = millis();
+    record->slaveId = slaveId;
+    record->topicLength = topicLength;
+    record->nameLength = nameLength;
+    record->timeDeltaLength = timeDeltaLength;
+    record->sameDeltaLength = sameDeltaLength;
+    record->flags = (slaveName != nullptr ? kDebugHasSlave : 0) |
+                    (looksLikeJson(message, messageLength) ? kDebugRawJson : 0);
+    strncpy(record->realTime, realTime, kDebugTimeLength);
+
+    char* data = reinterpret_cast<char*>(record + 1);
+    memcpy(data, topic, topicLength);
+    data += topicLength;
+    memcpy(data, slaveName, nameLength);
+    data += nameLength;
+    memcpy(data, timeDelta, timeDeltaLength);
+    data += timeDeltaLength;
+    memcpy(data, sameDeviceDelta, sameDeltaLength);
+    data += sameDeltaLength;
+    memcpy(data, message, messageLength);
+
+    debugTail += recordSize;
+    debugCount++;
+
+    return record->seq;
+}
+
+/**
+ * @brief Appends the oldest record with minSeq <= seq <= maxSeq as JSON
+ * @return false when no such record is left in the ring
+ */
+bool appendDebugRecordJson(uint32_t minSeq, uint32_t maxSeq, String& out, uint32_t& seq) {
+    size_t offset = debugHead;
+    for (uint16_t i = 0; i < debugCount; i++) {
+        const DebugRecord* record = debugRecordAt(offset);
+        if (record->seq > maxSeq) return false;
+        if (record->seq >= minSeq) {
+            formatDebugRecord(record, out);
+            seq = record->seq;
+            return true;
+        }
+        offset = advanceDebugOffset(offset);
+    }
+    return false;
+}
+
+/**
+ * @brief Formats record seq into out without touching the heap
+ * @return JSON length, or 0 when the record is gone or does not fit
+ */
+size_t formatDebugRecordJson(uint32_t seq, char* out, size_t size) {
+    size_t offset = debugHead;
+    for (uint16_t i = 0; i < debugCount; i++) {
+        const DebugRecord* record = debugRecordAt(offset);
+        if (record->seq == seq) {
+            FixedJsonWriter writer = { out, size, 0, false };
+            formatDebugRecord(record, writer);
+            return writer.overflow ? 0 : writer.used;
+        }
+        offset = advanceDebugOffset(offset);
+    }
+    return 0;
+}
+
+uint32_t getLatestDebugSeq() {
+    return debugNextSeq - 1;
+}
+
+void clearDebugRing() {
+    debugHead = debugTail = debugWrapEnd = 0;
+    debugCount = 0;
+}
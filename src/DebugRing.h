@@ -0,0 +1,18 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ==================== DEBUG RING CONSTANTS ====================
+constexpr size_t kDebugRingBytes = 8192;        // Fixed arena for debug console records
+constexpr size_t kMaxDebugRecordBytes = kDebugRingBytes / 2;
+constexpr uint8_t kDebugTimeLength = 8;         // "HH:MM:SS"
+
+// ==================== DEBUG RING OPERATIONS ====================
+// Records carry a monotonic sequence number and stay in the ring until evicted
+// by newer ones, so any number of readers can fetch incrementally.
+uint32_t pushDebugRecord(const char* topic, const char* message, const char* timeDelta, const char* sameDeviceDelta,
+                         uint8_t slaveId, const char* slaveName, const char* realTime);
+bool appendDebugRecordJson(uint32_t minSeq, uint32_t maxSeq, String& out, uint32_t& seq);
+size_t formatDebugRecordJson(uint32_t seq, char* out, size_t size);
+uint32_t getLatestDebugSeq();
+void clearDebugRing();
@@ -0,0 +1,77 @@
+#include "EventStream.h"
+#include "WebServer.h"
+
+// ==================== GLOBAL VARIABLES ====================
+
+AsyncEventSource events("/events");
+unsigned long lastKeepAlive = 0;
+unsigned long lastWifiEventCheck = 0;
+String lastWifiEvent;
+
+// ==================== CONNECTION HANDLING ====================
+
+/**
+ * @brief GET /events - debug, stats and wifi events pushed to the browser
+ */
+void setupEventStream(AsyncWebServer& webServer) {
+    events.onConnect([](AsyncEventSourceClient* client) {
+        if (events.count() > kMaxEventClients) {
+            // Browser falls back to polling
+            client->close();
+            return;
+        }
+
+        client->send("{}", "hello", millis(), 5000);
+
+        // New subscriber gets the current WiFi state straight away
+        lastWifiEvent = "";
+        Serial.println("📡 Event stream client connected");
+    });
+
+    webServer.addHandler(&events);
+}
+
+bool hasEventClients() {
+    return events.count() > 0;
+}
+
+// ==================== EVENT EMISSION ====================
+
+bool emitEvent(const char* eventName, const char* data) {
+    if (events.count() == 0) return false;
+
+    // The server queues per client; a stalled browser misses events instead of piling up RAM
+    if (events.avgPacketsWaiting() > kMaxEventBacklog) return false;
+
+    events.send(data, eventName, millis());
+    return true;
+}
+
+// ==================== PERIODIC SERVICE ====================
+
+void emitWifiStateIfChanged() {
+    JsonDocument doc;
+    buildIpInfo(doc);
+
+    String wifiState;
+    serializeJson(doc, wifiState);
+    if (wifiState != lastWifiEvent && emitEvent("wifi", wifiState.c_str())) {
+        lastWifiEvent = wifiState;
+    }
+}
+
+void serviceEventStream() {
+    if (!hasEventClients()) return;
+
+    unsigned long now = millis();
+
+    if (now - lastWifiEventCheck >= kWifiEventCheckInterval) {
+        lastWifiEventCheck = now;
+        emitWifiStateIfChanged();
+    }
+
+    if (now - lastKeepAlive >= kEventKeepAliveInterval) {
+        lastKeepAlive = now;
+        emitEvent("ping", "{}");
+    }
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+
+// ==================== EVENT STREAM CONSTANTS ====================
+constexpr uint8_t kMaxEventClients = 2;                     // Open browser tabs served live
+constexpr unsigned long kEventKeepAliveInterval = 15000;    // Ping so proxies keep the stream
+constexpr unsigned long kWifiEventCheckInterval = 1000;
+constexpr size_t kMaxEventBacklog = 8;                      // Queued messages before a client is skipped
+constexpr size_t kMaxDebugEventBytes = 768;                 // Larger debug records are fetched by seq instead
+
+// ==================== SERVER-SENT EVENTS ====================
+void setupEventStream(AsyncWebServer& webServer);
+void serviceEventStream();
+bool hasEventClients();
+bool emitEvent(const char* eventName, const char* data);
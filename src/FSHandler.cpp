@@ -1,4 +1,7 @@
 #include "FSHandler.h"
+#include "PublishQueue.h"
+#include "TimeSync.h"
+#include "ConfigBlob.h"
 
 // ==================== FILE SYSTEM OPERATIONS ====================
 
@@ -8,21 +11,13 @@ bool initFileSystem() {
         Serial.println("❌ ERROR: Failed to mount LittleFS");
         return false;
     }
-    Serial.println("✅ LittleFS mounted successfully");
     
-    Serial.println("📁 Listing files in LittleFS:");
-    Dir dir = LittleFS.openDir("/");
-    int fileCount = 0;
-    
-    while (dir.next()) {
-        Serial.printf("   📄 %s (%d bytes)\n", dir.fileName().c_str(), dir.fileSize());
-        fileCount++;
-    }
-    
-    if (fileCount == 0) {
-        Serial.println("⚠️  No files found in LittleFS - did you upload filesystem?");
+    // Usage only - walking the directory here made boot time grow with the archive
+    FSInfo info;
+    if (LittleFS.info(info)) {
+        Serial.printf("✅ LittleFS mounted: %u of %u bytes used\n", (unsigned)info.usedBytes, (unsigned)info.totalBytes);
     } else {
-        Serial.printf("✅ Found %d files in LittleFS\n", fileCount);
+        Serial.println("✅ LittleFS mounted successfully");
     }
     
     return true;
@@ -60,22 +55,31 @@ bool writeFile(const String& path, const String& content) {
     return (bytesWritten > 0);
 }
 
+// ==================== BINARY FILE OPERATIONS ====================
+// Used on hot paths (sample archive), so they stay quiet on success.
+
+size_t readFileAt(const char* path, size_t offset, uint8_t* buffer, size_t length) {
+    File file = LittleFS.open(path, "r");
+    if (!file) return 0;
+    
+    size_t bytesRead = 0;
+    if (offset < file.size() && file.seek(offset, SeekSet)) {
+        bytesRead = file.read(buffer, length);
+    }
+    file.close();
+    return bytesRead;
+}
+
 // ==================== SLAVE CONFIGURATION FUNCTIONS ====================
 
 bool saveSlaveConfig(const JsonDocument& config) {
     Serial.println("💾 Saving slave configuration to LittleFS (STREAMING MODE)...");
+    invalidateConfigBlob();
     
-    uint32_t freeHeap = ESP.getFreeHeap();
-    Serial.printf("📊 Free heap before save: %d bytes\n", freeHeap);
-    
-    if (freeHeap < 10000) {
-        Serial.println("🆘 CRITICAL: Not enough memory for JSON serialization - ABORTING");
-        return false;
-    }
-    
-    File file = LittleFS.open("/slaves.json", "w");
+    // Serialized straight to flash - no heap copy of the document is made
+    File file = LittleFS.open(kSlavesTempPath, "w");
     if (!file) {
-        Serial.println("❌ Failed to open slaves.json for writing");
+        Serial.println("❌ Failed to open slaves.json.tmp for writing");
         return false;
     }
     
@@ -84,6 +88,13 @@ bool saveSlaveConfig(const JsonDocument& config) {
     
     if (bytesWritten == 0) {
         Serial.println("❌ Failed to write slave configuration");
+        LittleFS.remove(kSlavesTempPath);
+        return false;
+    }
+    
+    // Rename replaces the old file in one step; a power cut leaves either version intact
+    if (!LittleFS.rename(kSlavesTempPath, kSlavesPath)) {
+        Serial.println("❌ Failed to replace slaves.json");
         return false;
     }
     
@@ -103,12 +114,12 @@ bool loadSlaveConfig(JsonDocument& config) {
         return false;
     }
     
-    if (!fileExists("/slaves.json")) {
+    if (!fileExists(kSlavesPath)) {
         Serial.println("⚠️  No slave configuration found, using defaults");
         return false;
     }
     
-    File file = LittleFS.open("/slaves.json", "r");
+    File file = LittleFS.open(kSlavesPath, "r");
     if (!file) {
         Serial.println("❌ Failed to open slaves.json for reading");
         return false;
@@ -135,12 +146,16 @@ bool loadSlaveConfig(JsonDocument& config) {
 
 // ==================== POLLING CONFIGURATION FUNCTIONS ====================
 
-bool savePollingConfig(int interval, int timeoutSeconds) {
+bool savePollingConfig(int interval, int timeoutSeconds, const PollSchedule& schedule, bool reloadSlaves) {
     Serial.printf("💾 Saving polling config (interval: %ds, timeout: %ds) to LittleFS...\n", interval, timeoutSeconds);
     
     JsonDocument doc;
     doc["pollInterval"] = interval;
     doc["timeout"] = timeoutSeconds;
+    doc["mode"] = getPollModeName(schedule.mode);
+    doc["align"] = schedule.alignToClock;
+    doc["enabled"] = modbusQueriesEnabled;
+    invalidateConfigBlob();
     
     File file = LittleFS.open("/polling.json", "w");
     if (!file) {
@@ -154,7 +169,9 @@ bool savePollingConfig(int interval, int timeoutSeconds) {
     bool success = (bytesWritten > 0);
     if (success) {
         Serial.println("✅ Polling config saved successfully");
-        modbusReloadSlaves();
+        if (reloadSlaves) {
+            modbusReloadSlaves();
+        }
     } else {
         Serial.println("❌ Failed to save polling config");
     }
@@ -162,9 +179,13 @@ bool savePollingConfig(int interval, int timeoutSeconds) {
     return success;
 }
 
-bool loadPollingConfig(int& interval, int& timeoutSeconds) {
+bool loadPollingConfig(int& interval, int& timeoutSeconds, PollSchedule& schedule, bool& queriesEnabled) {
     Serial.println("📖 Loading polling config from LittleFS...");
     
+    schedule.mode = POLL_FIXED_DELAY;
+    schedule.alignToClock = false;
+    queriesEnabled = false;
+    
     if (!fileExists("/polling.json")) {
         Serial.println("⚠️  No polling config found, using defaults (interval: 10s, timeout: 1s)");
         interval = 10;
@@ -193,6 +214,146 @@ bool loadPollingConfig(int& interval, int& timeoutSeconds) {
     
     interval = doc["pollInterval"] | 10;
     timeoutSeconds = doc["timeout"] | 1;
-    Serial.printf("✅ Polling config loaded: interval=%ds, timeout=%ds\n", interval, timeoutSeconds);
+    if (interval < kMinPollIntervalSeconds || interval > kMaxPollIntervalSeconds) {
+        Serial.printf("⚠️  Polling interval %d s out of range, using 10s\n", interval);
+        interval = 10;
+    }
+    if (timeoutSeconds < kMinTimeoutSeconds || timeoutSeconds > kMaxTimeoutSeconds) {
+        Serial.printf("⚠️  Timeout %d s out of range, using 1s\n", timeoutSeconds);
+        timeoutSeconds = 1;
+    }
+    schedule.mode = parsePollMode(doc["mode"] | "fixed_delay");
+    schedule.alignToClock = doc["align"] | false;
+    queriesEnabled = doc["enabled"] | false;
+    Serial.printf("✅ Polling config loaded: interval=%ds, timeout=%ds, mode=%s%s, queries %s\n", interval,
+                  timeoutSeconds, getPollModeName(schedule.mode), schedule.alignToClock ? " (aligned)" : "",
+                  queriesEnabled ? "on" : "off");
+    return true;
+}
+
+// ==================== MQTT PUBLISH CONFIGURATION FUNCTIONS ====================
+
+bool saveMqttConfig(const MqttConfig& config) {
+    Serial.printf("💾 Saving MQTT config (sparkplug: %s, group: %s) to LittleFS...\n",
+                  config.sparkplugEnabled ? "on" : "off", config.groupId);
+    
+    JsonDocument doc;
+    doc["sparkplug"] = config.sparkplugEnabled;
+    doc["groupId"] = config.groupId;
+    doc["edgeNodeId"] = config.edgeNodeId;
+    doc["queuePolicy"] = getQueuePolicyName(config.queuePolicy);
+    
+    File file = LittleFS.open("/mqtt.json", "w");
+    if (!file) {
+        Serial.println("❌ Failed to open mqtt.json for writing");
+        return false;
+    }
+    
+    size_t bytesWritten = serializeJson(doc, file);
+    file.close();
+    
+    bool success = (bytesWritten > 0);
+    if (success) {
+        Serial.println("✅ MQTT config saved successfully");
+    } else {
+        Serial.println("❌ Failed to save MQTT config");
+    }
+    
+    return success;
+}
+
+bool loadMqttConfig(MqttConfig& config) {
+    Serial.println("📖 Loading MQTT config from LittleFS...");
+    
+    config.sparkplugEnabled = false;
+    strcpy(config.groupId, "ModBus");
+    config.edgeNodeId[0] = '\0';
+    config.queuePolicy = QUEUE_DROP_OLDEST;
+    
+    if (!fileExists("/mqtt.json")) {
+        Serial.println("⚠️  No MQTT config found, using defaults (plain JSON publishing)");
+        return false;
+    }
+    
+    File file = LittleFS.open("/mqtt.json", "r");
+    if (!file) {
+        Serial.println("❌ Failed to open mqtt.json for reading");
+        return false;
+    }
+    
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, file);
+    file.close();
+    
+    if (error) {
+        Serial.printf("❌ Failed to parse MQTT config: %s, using defaults\n", error.c_str());
+        return false;
+    }
+    
+    config.sparkplugEnabled = doc["sparkplug"] | false;
+    strlcpy(config.groupId, doc["groupId"] | "ModBus", sizeof(config.groupId));
+    strlcpy(config.edgeNodeId, doc["edgeNodeId"] | "", sizeof(config.edgeNodeId));
+    config.queuePolicy = parseQueuePolicy(doc["queuePolicy"] | "drop_oldest");
+    
+    Serial.printf("✅ MQTT config loaded: sparkplug=%s, group=%s, node=%s, queue=%s\n",
+                  config.sparkplugEnabled ? "on" : "off", config.groupId, config.edgeNodeId,
+                  getQueuePolicyName(config.queuePolicy));
+    return true;
+}
+
+// ==================== TIME CONFIGURATION FUNCTIONS ====================
+
+bool saveTimeConfig(const TimeConfig& config) {
+    Serial.printf("💾 Saving time config (ntp: %s) to LittleFS...\n", config.ntpServer);
+    
+    JsonDocument doc;
+    doc["ntpServer"] = config.ntpServer;
+    
+    File file = LittleFS.open("/time.json", "w");
+    if (!file) {
+        Serial.println("❌ Failed to open time.json for writing");
+        return false;
+    }
+    
+    size_t bytesWritten = serializeJson(doc, file);
+    file.close();
+    
+    bool success = (bytesWritten > 0);
+    if (success) {
+        Serial.println("✅ Time config saved successfully");
+    } else {
+        Serial.println("❌ Failed to save time config");
+    }
+    
+    return success;
+}
+
+bool loadTimeConfig(TimeConfig& config) {
+    Serial.println("📖 Loading time config from LittleFS...");
+    
+    strcpy(config.ntpServer, kDefaultNtpServer);
+    
+    if (!fileExists("/time.json")) {
+        Serial.println("⚠️  No time config found, using defaults (pool.ntp.org)");
+        return false;
+    }
+    
+    File file = LittleFS.open("/time.json", "r");
+    if (!file) {
+        Serial.println("❌ Failed to open time.json for reading");
+        return false;
+    }
+    
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, file);
+    file.close();
+    
+    if (error) {
+        Serial.printf("❌ Failed to parse time config: %s, using defaults\n", error.c_str());
+        return false;
+    }
+    
+    strlcpy(config.ntpServer, doc["ntpServer"] | kDefaultNtpServer, sizeof(config.ntpServer));
+    Serial.printf("✅ Time config loaded: ntp=%s\n", config.ntpServer);
     return true;
 }
\ No newline at end of file
@@ -2,8 +2,19 @@
 
 #include <LittleFS.h>
 #include <ArduinoJson.h>
+#include "MQTTHandler.h"
 #include "ModBusHandler.h"
 #include "TemplateManager.h"
+#include "TimeSync.h"
+
+struct PollSchedule;   // ModBusHandler.h includes this header
+
+// ==================== FILE PATHS ====================
+
+constexpr const char* kSlavesPath = "/slaves.json";
+constexpr const char* kSlavesTempPath = "/slaves.json.tmp";       // Written, then renamed over kSlavesPath
+constexpr const char* kSlavesUploadPath = "/slaves.upload";       // Incoming /saveslaves body
+constexpr const char* kArchiveDir = "/archive";                   // Sample archive segments
 
 // ==================== FILE SYSTEM FUNCTIONS ====================
 
@@ -15,6 +26,10 @@ String readFile(const String& path);
 
 bool writeFile(const String& path, const String& content);
 
+// ==================== BINARY FILE FUNCTIONS ====================
+
+size_t readFileAt(const char* path, size_t offset, uint8_t* buffer, size_t length);
+
 // ==================== SLAVE CONFIGURATION FUNCTIONS ====================
 
 bool saveSlaveConfig(const JsonDocument& config);
@@ -23,6 +38,18 @@ bool loadSlaveConfig(JsonDocument& config);
 
 // ==================== POLLING CONFIGURATION FUNCTIONS ====================
 
-bool savePollingConfig(int interval, int timeoutSeconds);
+bool savePollingConfig(int interval, int timeoutSeconds, const PollSchedule& schedule, bool reloadSlaves = true);
+
+bool loadPollingConfig(int& interval, int& timeoutSeconds, PollSchedule& schedule, bool& queriesEnabled);
+
+// ==================== MQTT PUBLISH CONFIGURATION FUNCTIONS ====================
+
+bool saveMqttConfig(const MqttConfig& config);
+
+bool loadMqttConfig(MqttConfig& config);
+
+// ==================== TIME CONFIGURATION FUNCTIONS ====================
+
+bool saveTimeConfig(const TimeConfig& config);
 
-bool loadPollingConfig(int& interval, int& timeoutSeconds);
\ No newline at end of file
+bool loadTimeConfig(TimeConfig& config);
\ No newline at end of file
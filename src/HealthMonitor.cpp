@@ -0,0 +1,270 @@
+#include "HealthMonitor.h"
+#include "MQTTHandler.h"
+#include "PublishQueue.h"
+#include "ModBusHandler.h"
+#include "CommandHandler.h"
+#include "TimeSync.h"
+#include <ESP8266WiFi.h>
+
+// ==================== GLOBAL VARIABLES ====================
+// Everything is fixed-size: the reporter must not churn the heap it reports on
+
+char healthBuffer[kHealthBufferSize];
+
+// Loop busy time in µs, log-bucketed over the whole report window
+uint32_t loopHistogram[kLoopBuckets];
+uint32_t loopSampleCount = 0;
+uint32_t loopStartMicros = 0;
+uint32_t loopMaxMicros = 0;
+
+static_assert(kLatencyBuckets == 8, "health report format lists eight latency buckets");
+uint32_t latencyHistogram[kLatencyBuckets];   // How long due tasks waited to start
+uint32_t taskOverruns = 0;
+
+unsigned long windowStartTime = 0;
+unsigned long busBusyMs = 0;
+uint32_t busTransactions = 0;
+unsigned long lastCycleMs = 0;
+unsigned long maxCycleMs = 0;
+
+// Cycle start lateness vs lastAction + pollInterval, judged against web load in the same window
+unsigned long jitterTotalMs = 0;
+unsigned long jitterMaxMs = 0;
+uint16_t jitterSamples = 0;
+uint32_t pollOverruns = 0;              // Fixed-rate ticks skipped because a cycle ran long
+uint16_t webRequests = 0;
+uint16_t webDeferred = 0;
+
+// Measured from reset (millis() = 0), so the config source's effect on boot shows up
+char bootPhaseText[kBootPhaseTextSize] = "";
+unsigned long lastBootMark = 0;
+unsigned long slavesReadyMs = 0;
+unsigned long firstPollMs = 0;
+bool slavesFromBlob = false;
+
+uint32_t minFreeHeap = UINT32_MAX;
+unsigned long lastHealthReport = 0;
+
+// ==================== LOOP TIMING ====================
+
+/**
+ * @brief Bucket for a loop time: values below kLoopOctaveSteps map to themselves,
+ *        larger ones to (octave, top bits below the leading one)
+ */
+uint8_t loopBucket(uint32_t micros) {
+    if (micros < kLoopOctaveSteps) return micros;
+    uint8_t octave = 31 - __builtin_clz(micros);     // >= 2
+    if (octave >= kLoopMaxOctave) return kLoopBuckets - 1;
+    uint8_t step = (micros >> (octave - 2)) & (kLoopOctaveSteps - 1);
+    return (octave - 1) * kLoopOctaveSteps + step;
+}
+
+/**
+ * @brief Smallest loop time that falls in a bucket (inverse of loopBucket)
+ */
+uint32_t loopBucketFloor(uint8_t bucket) {
+    if (bucket < kLoopOctaveSteps) return bucket;
+    uint8_t octave = bucket / kLoopOctaveSteps + 1;
+    uint8_t step = bucket % kLoopOctaveSteps;
+    return (uint32_t)(kLoopOctaveSteps + step) << (octave - 2);
+}
+
+void healthLoopBegin() {
+    loopStartMicros = micros();
+}
+
+void healthLoopEnd() {
+    uint32_t elapsed = micros() - loopStartMicros;
+
+    loopHistogram[loopBucket(elapsed)]++;
+    loopSampleCount++;
+    if (elapsed > loopMaxMicros) {
+        loopMaxMicros = elapsed;
+    }
+
+    uint32_t freeHeap = ESP.getFreeHeap();
+    if (freeHeap < minFreeHeap) {
+        minFreeHeap = freeHeap;
+    }
+}
+
+// ==================== SCHEDULER ACCOUNTING ====================
+
+void recordTaskLatency(unsigned long lateMs) {
+    uint8_t bucket = 0;
+    while (lateMs > 0 && bucket < kLatencyBuckets - 1) {
+        lateMs >>= 1;
+        bucket++;
+    }
+    latencyHistogram[bucket]++;
+}
+
+void recordTaskOverrun() {
+    taskOverruns++;
+}
+
+// ==================== BUS ACCOUNTING ====================
+
+void recordBusActivity(unsigned long busyMs) {
+    busBusyMs += busyMs;
+    busTransactions++;
+}
+
+void recordPollCycle(unsigned long cycleMs) {
+    lastCycleMs = cycleMs;
+    if (cycleMs > maxCycleMs) {
+        maxCycleMs = cycleMs;
+    }
+}
+
+void recordPollJitter(unsigned long lateMs) {
+    jitterTotalMs += lateMs;
+    jitterSamples++;
+    if (lateMs > jitterMaxMs) {
+        jitterMaxMs = lateMs;
+    }
+}
+
+void recordPollOverrun(unsigned long missedTicks) {
+    pollOverruns += missedTicks;
+}
+
+// ==================== BOOT TIMING ====================
+
+/**
+ * @brief Charge the time since the previous mark (or reset) to the named phase
+ */
+void markBootPhase(const char* name) {
+    unsigned long now = millis();
+    size_t used = strlen(bootPhaseText);
+    snprintf(bootPhaseText + used, sizeof(bootPhaseText) - used, "%s\"%s\":%lu",
+             used > 0 ? "," : "", name, now - lastBootMark);
+    lastBootMark = now;
+}
+
+void recordSlavesReady(bool fromBlob) {
+    slavesReadyMs = millis();
+    slavesFromBlob = fromBlob;
+}
+
+void recordFirstPoll() {
+    if (firstPollMs != 0) return;
+    firstPollMs = millis();
+    Serial.printf("⏱️  First poll %lu ms after boot (slave table ready at %lu ms from %s)\n",
+                  firstPollMs, slavesReadyMs, slavesFromBlob ? "blob" : "JSON");
+}
+
+// ==================== WEB LOAD ====================
+
+void recordWebRequest(bool deferred) {
+    webRequests++;
+    if (deferred) {
+        webDeferred++;
+    }
+}
+
+// ==================== REPORTING ====================
+
+/**
+ * @brief Percentile over every loop of the window, reported as the middle of its
+ *        bucket and never above the window maximum
+ */
+uint32_t loopPercentile(uint8_t percent) {
+    if (loopSampleCount == 0) return 0;
+    uint32_t rank = (uint64_t)(loopSampleCount - 1) * percent / 100;
+    
+    uint32_t seen = 0;
+    for (uint8_t bucket = 0; bucket < kLoopBuckets; bucket++) {
+        seen += loopHistogram[bucket];
+        if (seen > rank) {
+            uint32_t low = loopBucketFloor(bucket);
+            uint32_t high = (bucket + 1 < kLoopBuckets) ? loopBucketFloor(bucket + 1) : loopMaxMicros + 1;
+            return min(low + (high - low) / 2, loopMaxMicros);
+        }
+    }
+    return loopMaxMicros;
+}
+
+void resetHealthWindow(unsigned long now) {
+    windowStartTime = now;
+    busBusyMs = 0;
+    busTransactions = 0;
+    maxCycleMs = 0;
+    jitterTotalMs = 0;
+    jitterMaxMs = 0;
+    jitterSamples = 0;
+    pollOverruns = 0;
+    webRequests = 0;
+    webDeferred = 0;
+    memset(loopHistogram, 0, sizeof(loopHistogram));
+    loopSampleCount = 0;
+    loopMaxMicros = 0;
+    memset(latencyHistogram, 0, sizeof(latencyHistogram));
+    taskOverruns = 0;
+    minFreeHeap = UINT32_MAX;
+}
+
+const char* buildHealthReport() {
+    unsigned long now = millis();
+    unsigned long windowMs = now - windowStartTime;
+
+    // newlib-nano's printf has no %llu; the epoch-ms timestamp goes out as two halves
+    uint64_t timestamp = getTimestampMillis();
+    char timestampText[24];
+    formatUint64(timestamp, timestampText, sizeof(timestampText));
+
+    float busUtilization = (windowMs > 0) ? (busBusyMs * 100.0f / windowMs) : 0.0f;
+    float cycleRatio = (pollInterval > 0) ? ((float)lastCycleMs / pollInterval) : 0.0f;
+    const PublishQueueStats& queue = getPublishQueueStats();
+
+    snprintf(healthBuffer, sizeof(healthBuffer),
+        "{\"timestamp\":%s,\"uptime\":%lu,"
+        "\"heap\":{\"free\":%u,\"min\":%u,\"maxBlock\":%u,\"fragmentation\":%u},"
+        "\"loop\":{\"samples\":%u,\"p50\":%u,\"p95\":%u,\"p99\":%u,\"max\":%u},"
+        "\"sched\":{\"latencyMs\":[%u,%u,%u,%u,%u,%u,%u,%u],\"overruns\":%u},"
+        "\"bus\":{\"utilization\":%.1f,\"transactions\":%u,\"cycleMs\":%lu,\"maxCycleMs\":%lu,"
+        "\"pollIntervalMs\":%lu,\"cycleRatio\":%.2f,\"jitterAvgMs\":%lu,\"jitterMaxMs\":%lu,"
+        "\"pollMode\":\"%s\",\"overruns\":%u},"
+        "\"web\":{\"requests\":%u,\"deferred\":%u},"
+        "\"mqtt\":{\"queueDepth\":%u,\"queueBytes\":%u,\"dropped\":%u,"
+        "\"sampleLatencyAvgMs\":%u,\"sampleLatencyMaxMs\":%u},"
+        "\"time\":{\"synced\":%s,\"syncAgeS\":%lu},"
+        "\"boot\":{\"config\":\"%s\",\"phasesMs\":{%s},\"slavesReadyMs\":%lu,\"firstPollMs\":%lu},"
+        "\"wifi\":{\"rssi\":%d}}",
+        timestampText, now / 1000,
+        ESP.getFreeHeap(), (minFreeHeap == UINT32_MAX) ? ESP.getFreeHeap() : minFreeHeap,
+        ESP.getMaxFreeBlockSize(), ESP.getHeapFragmentation(),
+        loopSampleCount, loopPercentile(50), loopPercentile(95), loopPercentile(99), loopMaxMicros,
+        latencyHistogram[0], latencyHistogram[1], latencyHistogram[2], latencyHistogram[3],
+        latencyHistogram[4], latencyHistogram[5], latencyHistogram[6], latencyHistogram[7], taskOverruns,
+        busUtilization, busTransactions, lastCycleMs, maxCycleMs,
+        pollInterval, cycleRatio, jitterSamples ? jitterTotalMs / jitterSamples : 0UL, jitterMaxMs,
+        getPollModeName(pollSchedule.mode), pollOverruns,
+        webRequests, webDeferred,
+        queue.depth, queue.bytesUsed, queue.dropped,
+        queue.samplesPublished ? queue.totalSampleAgeMs / queue.samplesPublished : 0, queue.maxSampleAgeMs,
+        isTimeSynced() ? "true" : "false", getTimeSyncAge(),
+        slavesFromBlob ? "blob" : "json", bootPhaseText, slavesReadyMs, firstPollMs,
+        (int)WiFi.RSSI());
+
+    return healthBuffer;
+}
+
+void serviceHealthMonitor() {
+    unsigned long now = millis();
+    if (now - lastHealthReport < kHealthReportInterval) return;
+    lastHealthReport = now;
+
+    if (!isMQTTConnected()) {
+        resetHealthWindow(now);
+        return;
+    }
+
+    const char* report = buildHealthReport();
+
+    char topic[96];
+    snprintf(topic, sizeof(topic), "%s/%s/health", kGatewayTopicRoot, getGatewayId().c_str());
+    enqueuePublish(topic, reinterpret_cast<const uint8_t*>(report), strlen(report), false);
+
+    resetHealthWindow(now);
+}
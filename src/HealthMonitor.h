@@ -0,0 +1,38 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ==================== HEALTH REPORT CONSTANTS ====================
+constexpr unsigned long kHealthReportInterval = 60000;  // 1 minute
+constexpr uint8_t kLoopOctaveSteps = 4;                  // Loop histogram: 4 buckets per power of two (<=25% error)
+constexpr uint8_t kLoopMaxOctave = 24;                   // Loop times of 2^24 µs (16 s) and up share the top bucket
+constexpr uint8_t kLoopBuckets = kLoopMaxOctave * kLoopOctaveSteps;
+constexpr size_t kHealthBufferSize = 1152;
+constexpr uint8_t kLatencyBuckets = 8;                   // Task start latency, ms: 0,1,2-3,4-7,...,64+
+constexpr size_t kBootPhaseTextSize = 192;               // "name":ms pairs for every boot phase
+
+// ==================== LOOP TIMING ====================
+void healthLoopBegin();
+void healthLoopEnd();
+
+// ==================== SCHEDULER ACCOUNTING ====================
+void recordTaskLatency(unsigned long lateMs);
+void recordTaskOverrun();
+
+// ==================== BUS ACCOUNTING ====================
+void recordBusActivity(unsigned long busyMs);
+void recordPollCycle(unsigned long cycleMs);
+void recordPollJitter(unsigned long lateMs);
+void recordPollOverrun(unsigned long missedTicks);
+
+// ==================== BOOT TIMING ====================
+void markBootPhase(const char* name);
+void recordSlavesReady(bool fromBlob);
+void recordFirstPoll();
+
+// ==================== WEB LOAD ====================
+void recordWebRequest(bool deferred);
+
+// ==================== REPORTING ====================
+void serviceHealthMonitor();
+const char* buildHealthReport();
@@ -0,0 +1,478 @@
+#include "HistoryStore.h"
+#include "WebServer.h"
+#include "SampleArchive.h"
+#include "TimeSync.h"
+
+// ==================== BLOCK LAYOUT ====================
+// Each series is a chain of fixed blocks. A block opens with its first sample
+// stored raw; later samples are Gorilla-encoded against the previous one:
+//   time   delta-of-delta   '0' | '10'+7 | '110'+9 | '1110'+12 | '1111'+32 bits
+//   value  XOR of float32   '0' same | '10'+bits in the previous window |
+//                           '11'+5 leading zeros+5 (length-1)+bits
+// Slowly changing readings on a steady poll cost a few bits per sample.
+
+constexpr size_t kBlockHeaderBytes = 16;
+constexpr uint16_t kBlockBits = (kHistoryBlockBytes - kBlockHeaderBytes) * 8;
+constexpr uint8_t kMaxSampleBits = 4 + 32 + 2 + 5 + 5 + 32;
+constexpr uint8_t kFreeBlock = 0xFF;
+constexpr uint8_t kNoWindow = 0xFF;
+
+struct HistoryBlock {
+    uint32_t startTime;
+    uint32_t firstValue;        // float bits
+    int16_t next;               // Next block of the series (or of the free list), -1 = none
+    uint8_t series;             // kFreeBlock when unused
+    uint8_t generation;         // Bumped on reuse so open cursors notice eviction
+    uint16_t bitCount;
+    uint16_t sampleCount;
+    uint8_t bits[kHistoryBlockBytes - kBlockHeaderBytes];
+};
+
+struct HistorySeries {
+    uint32_t channelHash;       // 0 = slot unused
+    uint32_t nameHash;
+    uint8_t slaveId;
+    uint8_t lastLeading;
+    uint8_t lastTrailing;
+    int16_t head;
+    int16_t tail;
+    uint32_t lastTime;
+    int32_t lastDelta;
+    uint32_t lastValue;
+};
+
+// ==================== GLOBAL VARIABLES ====================
+
+HistoryBlock* historyBlocks = nullptr;
+uint16_t historyBlockCount = 0;
+HistorySeries* historySeries = nullptr;
+uint8_t historySeriesCount = 0;
+int16_t freeHistoryBlock = -1;
+uint16_t refusedHistorySeries = 0;     // Channels not recorded since the last configure
+
+uint32_t historyClockLastMillis = 0;
+uint32_t historyClockWraps = 0;
+
+// ==================== HELPERS ====================
+
+uint32_t hashHistoryKey(const char* text) {
+    uint32_t hash = 2166136261u;
+    for (const char* c = text; *c != '\0'; c++) {
+        hash = (hash ^ (uint8_t)*c) * 16777619u;
+    }
+    return hash ? hash : 1;     // 0 marks an unused series
+}
+
+uint32_t floatBits(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+uint64_t getHistoryClockMillis() {
+    uint32_t now = millis();
+    if (now < historyClockLastMillis) {
+        historyClockWraps++;
+    }
+    historyClockLastMillis = now;
+    return ((uint64_t)historyClockWraps << 32) | now;
+}
+
+/**
+ * @brief Grow the series table and block pool to fit channelCount. Existing series
+ *        and blocks keep their indices, so open cursors stay valid.
+ */
+void configureHistory(uint16_t channelCount) {
+    uint8_t seriesCount = (channelCount > kMaxHistorySeries) ? kMaxHistorySeries : (channelCount ? channelCount : 1);
+    uint16_t blockCount = seriesCount * kHistoryBlocksPerSeries;
+    if (blockCount < kMinHistoryBlocks) blockCount = kMinHistoryBlocks;
+    if (blockCount > kMaxHistoryBlocks) blockCount = kMaxHistoryBlocks;
+
+    if (refusedHistorySeries > 0) {
+        Serial.printf("⚠️ History: %u channels were not recorded (table full)\n", refusedHistorySeries);
+        refusedHistorySeries = 0;
+    }
+    if (channelCount > kMaxHistorySeries) {
+        Serial.printf("⚠️ History keeps %u of %u channels\n", kMaxHistorySeries, channelCount);
+    }
+
+    if (seriesCount > historySeriesCount) {
+        HistorySeries* grown = new HistorySeries[seriesCount]();
+        if (historySeriesCount > 0) {
+            memcpy(grown, historySeries, historySeriesCount * sizeof(HistorySeries));
+        }
+        for (uint8_t i = historySeriesCount; i < seriesCount; i++) {
+            grown[i].head = grown[i].tail = -1;
+        }
+        delete[] historySeries;
+        historySeries = grown;
+        historySeriesCount = seriesCount;
+    }
+
+    if (blockCount > historyBlockCount) {
+        HistoryBlock* grown = new HistoryBlock[blockCount];
+        if (historyBlockCount > 0) {
+            memcpy(grown, historyBlocks, historyBlockCount * sizeof(HistoryBlock));
+        }
+        // New blocks go on the free list ahead of any already free
+        for (uint16_t i = historyBlockCount; i < blockCount; i++) {
+            grown[i].series = kFreeBlock;
+            grown[i].generation = 0;
+            grown[i].next = (i + 1 < blockCount) ? i + 1 : freeHistoryBlock;
+        }
+        freeHistoryBlock = historyBlockCount;
+        delete[] historyBlocks;
+        historyBlocks = grown;
+        historyBlockCount = blockCount;
+    }
+}
+
+void writeBits(HistoryBlock& block, uint32_t value, uint8_t count) {
+    for (int8_t i = count - 1; i >= 0; i--) {
+        if ((value >> i) & 1) {
+            block.bits[block.bitCount >> 3] |= 0x80 >> (block.bitCount & 7);
+        }
+        block.bitCount++;
+    }
+}
+
+uint32_t readBits(const HistoryBlock& block, uint16_t& position, uint8_t count) {
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        value = (value << 1) | ((block.bits[position >> 3] >> (7 - (position & 7))) & 1);
+        position++;
+    }
+    return value;
+}
+
+// ==================== BLOCK POOL ====================
+
+void releaseHistoryHead(HistorySeries& series) {
+    int16_t index = series.head;
+    HistoryBlock& block = historyBlocks[index];
+
+    series.head = block.next;
+    if (series.head < 0) {
+        series.tail = -1;
+    }
+
+    block.series = kFreeBlock;
+    block.generation++;
+    block.next = freeHistoryBlock;
+    freeHistoryBlock = index;
+}
+
+/**
+ * @brief Take a free block, evicting the oldest block of any series when the pool is full
+ */
+int16_t allocateHistoryBlock(uint8_t seriesIndex) {
+    if (freeHistoryBlock < 0) {
+        int oldest = -1;
+        for (uint8_t i = 0; i < historySeriesCount; i++) {
+            if (historySeries[i].channelHash == 0 || historySeries[i].head < 0) continue;
+            if (oldest < 0 || historyBlocks[historySeries[i].head].startTime <
+                              historyBlocks[historySeries[oldest].head].startTime) {
+                oldest = i;
+            }
+        }
+        if (oldest < 0) return -1;
+        releaseHistoryHead(historySeries[oldest]);
+    }
+
+    int16_t index = freeHistoryBlock;
+    HistoryBlock& block = historyBlocks[index];
+    freeHistoryBlock = block.next;
+
+    block.series = seriesIndex;
+    block.next = -1;
+    block.bitCount = 0;
+    block.sampleCount = 0;
+    memset(block.bits, 0, sizeof(block.bits));
+    return index;
+}
+
+// ==================== SERIES TABLE ====================
+
+int findHistorySeries(uint8_t slaveId, const char* slaveName, const char* channel) {
+    uint32_t channelHash = hashHistoryKey(channel);
+    uint32_t nameHash = (slaveName != nullptr) ? hashHistoryKey(slaveName) : 0;
+
+    for (uint8_t i = 0; i < historySeriesCount; i++) {
+        const HistorySeries& series = historySeries[i];
+        if (series.channelHash == channelHash && series.slaveId == slaveId &&
+            (slaveName == nullptr || series.nameHash == nameHash)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Series for a slave channel, created on first sight. A full table only
+ *        gives up a series that has stopped receiving samples (e.g. a removed
+ *        slave); otherwise the new channel is refused rather than evicting one.
+ * @return -1 when refused
+ */
+int acquireHistorySeries(uint8_t slaveId, const char* slaveName, const char* channel, uint32_t now) {
+    int index = findHistorySeries(slaveId, slaveName, channel);
+    if (index >= 0) return index;
+
+    for (uint8_t i = 0; i < historySeriesCount; i++) {
+        if (historySeries[i].channelHash == 0) {
+            index = i;
+            break;
+        }
+        if (now - historySeries[i].lastTime >= kHistoryStaleSeconds &&
+            (index < 0 || historySeries[i].lastTime < historySeries[index].lastTime)) {
+            index = i;
+        }
+    }
+    if (index < 0) {
+        refusedHistorySeries++;
+        return -1;
+    }
+
+    HistorySeries& series = historySeries[index];
+    while (series.head >= 0) {
+        releaseHistoryHead(series);
+    }
+
+    series.channelHash = hashHistoryKey(channel);
+    series.nameHash = hashHistoryKey(slaveName);
+    series.slaveId = slaveId;
+    series.lastTime = 0;
+    return index;
+}
+
+// ==================== ENCODING ====================
+
+void startHistoryBlock(HistorySeries& series, HistoryBlock& block, uint32_t time, uint32_t valueBits) {
+    block.startTime = time;
+    block.firstValue = valueBits;
+    block.sampleCount = 1;
+
+    series.lastTime = time;
+    series.lastDelta = 0;
+    series.lastValue = valueBits;
+    series.lastTrailing = kNoWindow;
+}
+
+void encodeTime(HistorySeries& series, HistoryBlock& block, uint32_t time) {
+    int32_t delta = (int32_t)(time - series.lastTime);
+    int32_t dod = delta - series.lastDelta;
+
+    if (dod == 0) {
+        writeBits(block, 0b0, 1);
+    } else if (dod >= -63 && dod <= 64) {
+        writeBits(block, 0b10, 2);
+        writeBits(block, dod + 63, 7);
+    } else if (dod >= -255 && dod <= 256) {
+        writeBits(block, 0b110, 3);
+        writeBits(block, dod + 255, 9);
+    } else if (dod >= -2047 && dod <= 2048) {
+        writeBits(block, 0b1110, 4);
+        writeBits(block, dod + 2047, 12);
+    } else {
+        writeBits(block, 0b1111, 4);
+        writeBits(block, (uint32_t)dod, 32);
+    }
+
+    series.lastTime = time;
+    series.lastDelta = delta;
+}
+
+void encodeValue(HistorySeries& series, HistoryBlock& block, uint32_t valueBits) {
+    uint32_t xorBits = valueBits ^ series.lastValue;
+    series.lastValue = valueBits;
+
+    if (xorBits == 0) {
+        writeBits(block, 0b0, 1);
+        return;
+    }
+
+    uint8_t leading = __builtin_clz(xorBits);
+    uint8_t trailing = __builtin_ctz(xorBits);
+    if (leading > 31) leading = 31;
+
+    if (series.lastTrailing != kNoWindow && leading >= series.lastLeading && trailing >= series.lastTrailing) {
+        uint8_t meaningful = 32 - series.lastLeading - series.lastTrailing;
+        writeBits(block, 0b10, 2);
+        writeBits(block, xorBits >> series.lastTrailing, meaningful);
+        return;
+    }
+
+    uint8_t meaningful = 32 - leading - trailing;
+    writeBits(block, 0b11, 2);
+    writeBits(block, leading, 5);
+    writeBits(block, meaningful - 1, 5);
+    writeBits(block, xorBits >> trailing, meaningful);
+
+    series.lastLeading = leading;
+    series.lastTrailing = trailing;
+}
+
+/**
+ * @brief Store a sample unless the series took one less than an interval ago
+ * @return true when the sample was accepted (even if no block could be had for it)
+ */
+bool appendHistorySample(uint8_t seriesIndex, uint32_t time, float value) {
+    HistorySeries& series = historySeries[seriesIndex];
+    uint32_t valueBits = floatBits(value);
+
+    // Checked even when eviction has emptied the series, so the archive rate holds
+    if (series.lastTime != 0 && time - series.lastTime < kHistorySampleInterval) return false;
+
+    if (series.tail >= 0) {
+        HistoryBlock& tail = historyBlocks[series.tail];
+        if (tail.bitCount + kMaxSampleBits <= kBlockBits) {
+            encodeTime(series, tail, time);
+            encodeValue(series, tail, valueBits);
+            tail.sampleCount++;
+            return true;
+        }
+    }
+
+    int16_t index = allocateHistoryBlock(seriesIndex);
+    if (index < 0) {
+        series.lastTime = time;
+        return true;
+    }
+
+    // The eviction may have taken this series' only block
+    if (series.tail >= 0) {
+        historyBlocks[series.tail].next = index;
+    } else {
+        series.head = index;
+    }
+    series.tail = index;
+    startHistoryBlock(series, historyBlocks[index], time, valueBits);
+    return true;
+}
+
+// ==================== RECORDING ====================
+
+/**
+ * @brief Store a decoded reading under the time it was acquired. sampledAt is the
+ *        millis() of the read and sampleTimestamp its published timestamp; 0 = now.
+ */
+void recordHistorySamples(uint8_t slaveId, const char* slaveName, JsonObjectConst values, uint32_t sampledAt,
+                          uint64_t sampleTimestamp) {
+    if (historySeriesCount == 0) {
+        configureHistory(0);
+    }
+
+    // RAM history runs on uptime; the archive outlives reboots and takes the wall clock only
+    uint64_t clock = getHistoryClockMillis();
+    if (sampledAt != 0) {
+        clock -= (uint32_t)(millis() - sampledAt);
+    }
+    uint32_t now = clock / 1000;
+
+    if (sampleTimestamp == 0) {
+        sampleTimestamp = getTimestampMillis();
+    }
+    // Taken before SNTP had set the clock: uptime, not wall time
+    uint32_t wallTime = (isTimeSynced() && sampleTimestamp / 1000 > (uint64_t)kMinValidEpoch)
+                            ? sampleTimestamp / 1000 : 0;
+
+    for (JsonPairConst kv : values) {
+        if (!kv.value().is<float>() || strcmp(kv.key().c_str(), "timestamp") == 0) continue;
+
+        int seriesIndex = acquireHistorySeries(slaveId, slaveName, kv.key().c_str(), now);
+        if (seriesIndex < 0) continue;
+
+        float value = kv.value().as<float>();
+        if (appendHistorySample(seriesIndex, now, value) && wallTime != 0) {
+            // The archive keeps the same downsampled stream on flash
+            const HistorySeries& series = historySeries[seriesIndex];
+            archiveSample(slaveId, series.nameHash, series.channelHash, wallTime, value);
+        }
+    }
+}
+
+// ==================== DECODING ====================
+
+void loadBlockStart(HistoryCursor& cursor, const HistoryBlock& block) {
+    cursor.generation = block.generation;
+    cursor.sample = 0;
+    cursor.bitPosition = 0;
+    cursor.time = block.startTime;
+    cursor.delta = 0;
+    cursor.valueBits = block.firstValue;
+    cursor.trailing = kNoWindow;
+}
+
+bool openHistoryCursor(int series, uint32_t fromTime, HistoryCursor& cursor) {
+    if (series < 0 || series >= historySeriesCount || historySeries[series].head < 0) return false;
+
+    // Skip whole blocks that end before fromTime
+    int16_t block = historySeries[series].head;
+    while (historyBlocks[block].next >= 0 && historyBlocks[historyBlocks[block].next].startTime <= fromTime) {
+        block = historyBlocks[block].next;
+    }
+
+    cursor.series = series;
+    cursor.block = block;
+    loadBlockStart(cursor, historyBlocks[block]);
+    return true;
+}
+
+void decodeTime(HistoryCursor& cursor, const HistoryBlock& block) {
+    int32_t dod;
+    if (readBits(block, cursor.bitPosition, 1) == 0) {
+        dod = 0;
+    } else if (readBits(block, cursor.bitPosition, 1) == 0) {
+        dod = (int32_t)readBits(block, cursor.bitPosition, 7) - 63;
+    } else if (readBits(block, cursor.bitPosition, 1) == 0) {
+        dod = (int32_t)readBits(block, cursor.bitPosition, 9) - 255;
+    } else if (readBits(block, cursor.bitPosition, 1) == 0) {
+        dod = (int32_t)readBits(block, cursor.bitPosition, 12) - 2047;
+    } else {
+        dod = (int32_t)readBits(block, cursor.bitPosition, 32);
+    }
+
+    cursor.delta += dod;
+    cursor.time += cursor.delta;
+}
+
+void decodeValue(HistoryCursor& cursor, const HistoryBlock& block) {
+    if (readBits(block, cursor.bitPosition, 1) == 0) return;
+
+    if (readBits(block, cursor.bitPosition, 1) == 1) {
+        cursor.leading = readBits(block, cursor.bitPosition, 5);
+        uint8_t meaningful = readBits(block, cursor.bitPosition, 5) + 1;
+        cursor.trailing = 32 - cursor.leading - meaningful;
+    }
+
+    uint8_t meaningful = 32 - cursor.leading - cursor.trailing;
+    cursor.valueBits ^= readBits(block, cursor.bitPosition, meaningful) << cursor.trailing;
+}
+
+/**
+ * @brief Next stored sample of the series, oldest first
+ * @return false at the end of the series or if the block under the cursor was evicted
+ */
+bool nextHistoryPoint(HistoryCursor& cursor, uint32_t& time, float& value) {
+    while (cursor.block >= 0) {
+        const HistoryBlock& block = historyBlocks[cursor.block];
+        if (block.generation != cursor.generation || block.series != cursor.series) return false;
+
+        if (cursor.sample < block.sampleCount) {
+            if (cursor.sample > 0) {
+                decodeTime(cursor, block);
+                decodeValue(cursor, block);
+            }
+            cursor.sample++;
+
+            time = cursor.time;
+            memcpy(&value, &cursor.valueBits, sizeof(value));
+            return true;
+        }
+
+        cursor.block = block.next;
+        if (cursor.block >= 0) {
+            loadBlockStart(cursor, historyBlocks[cursor.block]);
+        }
+    }
+    return false;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// ==================== HISTORY CONSTANTS ====================
+// Sized from the configured channel count at each reload and only ever grown. A
+// drifting reading costs ~16 bits a sample, so a block holds ~24 min at one sample
+// a minute: 6 blocks keep ~2.4 h per channel, the 256-block cap ~1.6 h at 64 channels.
+constexpr size_t kHistoryBlockBytes = 64;
+constexpr uint8_t kHistoryBlocksPerSeries = 6;
+constexpr uint16_t kMinHistoryBlocks = 96;              // 6 KB
+constexpr uint16_t kMaxHistoryBlocks = 256;             // 16 KB; shared, oldest block evicted when full
+constexpr uint8_t kMaxHistorySeries = 128;              // slave+channel pairs; more are refused
+constexpr uint32_t kHistorySampleInterval = 60;         // Seconds between stored samples of one channel
+constexpr uint32_t kHistoryStaleSeconds = 3600;         // A series this long without samples may be reused
+
+// ==================== DECODE CURSOR ====================
+
+/**
+ * @brief Position in one series while decoding. Blocks evicted under an open
+ *        cursor are detected through their generation and end the read.
+ */
+struct HistoryCursor {
+    int16_t series;
+    int16_t block;
+    uint8_t generation;
+    uint16_t sample;            // Index within the current block
+    uint16_t bitPosition;
+    uint32_t time;              // Seconds of uptime (getHistoryClockMillis)
+    int32_t delta;
+    uint32_t valueBits;
+    uint8_t leading;
+    uint8_t trailing;           // 0xFF = no XOR window yet in this block
+};
+
+// ==================== RECORDING ====================
+// One time domain: seconds of uptime, extended past the millis() wrap. Readers add
+// the wall clock offset when they serve points.
+uint64_t getHistoryClockMillis();
+void configureHistory(uint16_t channelCount);
+uint32_t hashHistoryKey(const char* text);
+void recordHistorySamples(uint8_t slaveId, const char* slaveName, JsonObjectConst values, uint32_t sampledAt = 0,
+                          uint64_t sampleTimestamp = 0);
+
+// ==================== QUERY ====================
+int findHistorySeries(uint8_t slaveId, const char* slaveName, const char* channel);
+bool openHistoryCursor(int series, uint32_t fromTime, HistoryCursor& cursor);
+bool nextHistoryPoint(HistoryCursor& cursor, uint32_t& time, float& value);
@@ -1,4 +1,9 @@
 #include "MQTTHandler.h"
+#include "SparkplugHandler.h"
+#include "PublishQueue.h"
+#include "ModBusHandler.h"
+#include "CommandHandler.h"
+#include "TimeSync.h"
 #include <Arduino.h>
 
 // ==================== GLOBAL VARIABLES ====================
@@ -11,6 +16,8 @@ const unsigned long mqttReconnectInterval = 20000;  // 20 seconds
 WiFiClient espClient;
 PubSubClient mqttClient(espClient);
 
+MqttConfig mqttConfig = { false, "ModBus", "", QUEUE_DROP_OLDEST };
+
 // ==================== MQTT CONNECTION MANAGEMENT ====================
 
 void checkMQTT() {
@@ -25,6 +32,12 @@ void checkMQTT() {
     } else {
         // Process MQTT messages when connected
         mqttClient.loop();
+        
+        if (slaveMetadataPending) {
+            publishSlaveMetadata();
+        }
+        
+        drainPublishQueue();
     }
 }
 
@@ -34,6 +47,8 @@ void reconnectMQTT() {
     uint16_t port = atoi(currentParams.mqttPort); // Convert port string to int
     
     mqttClient.setServer(server, port);
+    mqttClient.setBufferSize(kMqttBufferSize);
+    mqttClient.setCallback(onMqttMessage);
 
     Serial.print("🔌 Attempting MQTT connection to ");
     Serial.print(server);
@@ -41,8 +56,14 @@ void reconnectMQTT() {
     Serial.print(port);
     Serial.println("...");
     
-    if (mqttClient.connect("ESP8266_LoRa_Client")) {
-        Serial.println("✅ MQTT connected");
+    bool connected = isSparkplugEnabled()
+        ? connectSparkplugSession("ESP8266_LoRa_Client")
+        : mqttClient.connect("ESP8266_LoRa_Client");
+    
+    if (connected) {
+        Serial.printf("✅ MQTT connected (%s mode)\n", isSparkplugEnabled() ? "Sparkplug B" : "JSON");
+        subscribeCommandTopic();
+        requestSlaveMetadata();   // Refresh retained metadata for this session
     } else {
         Serial.print("❌ MQTT failed, rc=");
         Serial.print(mqttClient.state());
@@ -50,21 +71,54 @@ void reconnectMQTT() {
     }
 }
 
+void applyMqttConfig(const MqttConfig& newConfig) {
+    bool modeChanged = (newConfig.sparkplugEnabled != mqttConfig.sparkplugEnabled) ||
+                       strcmp(newConfig.groupId, mqttConfig.groupId) != 0 ||
+                       strcmp(newConfig.edgeNodeId, mqttConfig.edgeNodeId) != 0;
+    mqttConfig = newConfig;
+    
+    // Session identity (will message, births) changed - start a fresh session
+    if (modeChanged && mqttClient.connected()) {
+        Serial.println("🔄 MQTT publish mode changed - reconnecting");
+        mqttClient.disconnect();
+        previousMQTTReconnect = millis() - mqttReconnectInterval;
+    }
+}
+
+// ==================== MESSAGE HANDLING ====================
+
+void onMqttMessage(char* topic, uint8_t* payload, unsigned int length) {
+    if (isCommandTopic(topic)) {
+        handleMqttCommand(payload, length);
+    } else if (isSparkplugEnabled()) {
+        handleSparkplugCommand(topic, payload, length);
+    }
+}
+
 // ==================== MESSAGE PUBLISHING ====================
 
-// ✅ Centralized publish function
-void publishMessage(const char* topic, const char* payload) {
-    if (mqttClient.connected()) {
-        mqttClient.publish(topic, payload);
-        Serial.print("📤 MQTT Published → ");
-        Serial.print(topic);
-        Serial.print(": ");
-        Serial.println(payload);
-    } else {
-        Serial.println("⚠️ MQTT not connected, message not sent");
+// ✅ Centralized publish function - queued, sent from loop() as the socket allows
+void publishMessage(const char* topic, const char* payload, bool retained, uint32_t sampledAt) {
+    if (!enqueuePublish(topic, reinterpret_cast<const uint8_t*>(payload), strlen(payload), retained, true, sampledAt)) {
+        Serial.println("⚠️ MQTT message not queued");
     }
 }
 
+// Edge node id when configured, otherwise derived from the chip id. Safe as a topic level.
+String getGatewayId() {
+    if (mqttConfig.edgeNodeId[0] == '\0') {
+        char fallbackId[20];
+        snprintf(fallbackId, sizeof(fallbackId), "ESP8266_%06X", ESP.getChipId());
+        return String(fallbackId);
+    }
+    
+    String gatewayId = mqttConfig.edgeNodeId;
+    gatewayId.replace('/', '_');
+    gatewayId.replace('+', '_');
+    gatewayId.replace('#', '_');
+    return gatewayId;
+}
+
 // 🆕 ADDED: Connection status helper
 bool isMQTTConnected() {
     return mqttClient.connected();
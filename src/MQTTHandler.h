@@ -8,6 +8,21 @@
 // Forward declarations
 extern WifiParams currentParams;
 
+// ==================== MQTT PUBLISH CONFIGURATION ====================
+constexpr uint16_t kMqttBufferSize = 1536;   // Room for Sparkplug births and full meter payloads
+
+/**
+ * @brief Publishing options stored in /mqtt.json (broker address stays in EEPROM)
+ */
+struct MqttConfig {
+    bool sparkplugEnabled;
+    char groupId[32];
+    char edgeNodeId[32];
+    uint8_t queuePolicy;        // QueueOverflowPolicy
+};
+
+extern MqttConfig mqttConfig;
+
 // Global variables
 extern const uint16_t mqttPort;
 extern const char* mqttTopicPub;
@@ -19,8 +34,11 @@ extern PubSubClient mqttClient;
 
 // Function declarations
 void reconnectMQTT();
-void publishMessage(const char* topic, const char* payload);
+void publishMessage(const char* topic, const char* payload, bool retained = false, uint32_t sampledAt = 0);
 void checkMQTT();
+void onMqttMessage(char* topic, uint8_t* payload, unsigned int length);
+void applyMqttConfig(const MqttConfig& newConfig);
+String getGatewayId();
 
 // 🆕 ADDED: Connection status helpers
 bool isMQTTConnected();
@@ -1,22 +1,33 @@
 #include "ModBusHandler.h"
+#include "CommandHandler.h"
+#include "HealthMonitor.h"
+#include "EventStream.h"
+#include "ConfigStore.h"
+#include "StatusApi.h"
+#include "HistoryStore.h"
+#include "ParamCache.h"
+#include "PublishQueue.h"
 
 // ==================== GLOBAL VARIABLES ====================
 
 ModbusMaster node;
 SensorSlave* slaves = nullptr;
 int slaveCount = 0;
+uint32_t builtTemplateGeneration = 0;     // Template generation the live slaves were built against
+bool slaveMetadataPending = false;
+int metadataCursor = 0;                   // Next slave whose retained metadata is queued
 
 // Non-blocking query state
 unsigned long lastQueryTime = 0;
 uint8_t currentSlaveIndex = 0;
 unsigned long pollInterval = kDefaultPollInterval;
 unsigned long timeoutDuration = kDefaultTimeout;
+PollSchedule pollSchedule = { POLL_FIXED_DELAY, false };
 
 // Non-blocking state variables
 enum QueryState { 
     STATE_IDLE, 
     STATE_START_QUERY, 
-    STATE_WAIT_RESPONSE, 
     STATE_PROCESS_DATA, 
     STATE_WAITING 
 };
@@ -24,7 +35,21 @@ enum QueryState {
 QueryState currentState = STATE_IDLE;
 unsigned long lastActionTime = 0;
 unsigned long queryStartTime = 0;
+unsigned long cycleStartTime = 0;
 bool waitingForResponse = false;
+uint8_t queryResult = 0;                // ModbusMaster result of the last poll read
+
+// Fixed-rate schedule
+unsigned long nextCycleTime = 0;        // millis() of the next tick
+uint64_t cycleTimestamp = 0;            // Wall-clock ms the running cycle was scheduled for
+
+// Acquisition time of the last response, taken as soon as the read returns
+uint32_t acquisitionMillis = 0;         // Local clock, for latency through the queues
+uint64_t acquisitionTimestamp = 0;      // Epoch ms once SNTP has synced, uptime before
+
+// Remote command waiting for the bus to go idle
+BusCommand pendingCommand = {};
+JsonDocument pendingPatch;
 
 // Statistics
 SlaveStatistics slaveStats[kMaxStatisticsSlaves];
@@ -43,46 +68,6 @@ void postTransmission() {
     digitalWrite(kRs485DePin, LOW); 
 }
 
-// ==================== DATA CONVERSION FUNCTIONS ====================
-
-float convertRegisterToTemperature(uint16_t registerValue, float divider) {
-    int16_t tempInt;
-    if (registerValue & 0x8000) {
-        tempInt = -((0xFFFF - registerValue) + 1);
-    } else {
-        tempInt = registerValue;
-    }
-    return (tempInt * 0.1f) / divider;
-}
-
-float convertRegisterToHumidity(uint16_t registerValue, float divider) {
-    return (registerValue * 0.1f) / divider;
-}
-
-float calculateCurrent(uint64_t registerValue, float divider) {
-    return (registerValue * slaves[currentSlaveIndex].ct / 10000.0f) / divider;
-}
-
-float calculateSinglePhasePower(int64_t registerValue, float divider, float ct, float pt) {
-    return (registerValue * pt * ct / 100.0f) / divider;
-}
-
-float calculateThreePhasePower(int64_t registerValue, float divider, float ct, float pt) {
-    return (registerValue * pt * ct / 10.0f) / divider;
-}
-
-float calculatePowerFactor(int64_t registerValue, float divider) {
-    return (registerValue / 1000.0f) / divider;
-}
-
-float calculateVoltage(uint64_t registerValue, float divider, float pt) {
-    return (registerValue * pt / 100.0f) / divider;
-}
-
-float readEnergyValue(uint64_t rawValue, float divider) {
-    return (rawValue / 100.0f) / divider;
-}
-
 // ==================== MODBUS INITIALIZATION ====================
 
 bool initModbus() {
@@ -97,272 +82,338 @@ bool initModbus() {
     return true;
 }
 
-// ==================== CONFIGURATION LOADING HELPERS ====================
-
-DeviceType determineDeviceTypeFromString(const String& deviceTypeStr) {
-    if (deviceTypeStr == "G01S") return DEVICE_G01S;
-    if (deviceTypeStr == "HeylaParam") return DEVICE_HEYLA_PARAM;
-    if (deviceTypeStr == "HeylaVoltage") return DEVICE_HEYLA_VOLTAGE;
-    if (deviceTypeStr == "HeylaEnergy9") return DEVICE_HEYLA_ENERGY9;
-    if (deviceTypeStr == "HeylaEnergy27") return DEVICE_HEYLA_ENERGY27;
-    return DEVICE_G01S;
-}
-
-void loadDeviceParameters(SensorSlave& slave, JsonObject slaveObj) {
-    switch(slave.deviceType) {
-        case DEVICE_G01S:
-            loadG01SParameters(slave.config.sensor, slaveObj);
-            break;
-        case DEVICE_HEYLA_PARAM:
-            loadMeterParameters(slave.config.meter, slaveObj);
-            break;
-        case DEVICE_HEYLA_VOLTAGE:
-            loadVoltageParameters(slave.config.voltage, slaveObj);
-            break;
-        case DEVICE_HEYLA_ENERGY9:
-            loadEnergyParameters9(slave.config.energy, slaveObj);
-            break;
-        case DEVICE_HEYLA_ENERGY27:
-            loadEnergyParameters27(slave.config.energy, slaveObj);
-            break;
-    }
-}
-
-void loadG01SParameters(SensorConfig& sensorConfig, JsonObject paramsObj) {
-    JsonObject sensorObj = paramsObj["sensor"].as<JsonObject>();
-    sensorConfig.tempDivider = sensorObj["tempdivider"] | 1.0f;
-    sensorConfig.humidDivider = sensorObj["humiddivider"] | 1.0f;
-}
-
-void loadMeterParameters(MeterConfig& meterConfig, JsonObject paramsObj) {
-    JsonObject meterObj = paramsObj["meter"].as<JsonObject>();
-    
-    // Load grouped dividers
-    #define LOAD_GROUPED_PARAM(group) \
-        if (meterObj[#group].is<JsonObject>()) { \
-            JsonObject paramObj = meterObj[#group].as<JsonObject>(); \
-            meterConfig.group.divider = paramObj["divider"] | 1.0f; \
-        }
-    
-    LOAD_GROUPED_PARAM(Current);
-    LOAD_GROUPED_PARAM(zeroPhaseCurrent);
-    LOAD_GROUPED_PARAM(ActivePower);
-    LOAD_GROUPED_PARAM(totalActivePower);
-    LOAD_GROUPED_PARAM(ReactivePower);
-    LOAD_GROUPED_PARAM(totalReactivePower);
-    LOAD_GROUPED_PARAM(ApparentPower);
-    LOAD_GROUPED_PARAM(totalApparentPower);
-    LOAD_GROUPED_PARAM(PowerFactor);
-    LOAD_GROUPED_PARAM(totalPowerFactor);
-    
-    #undef LOAD_GROUPED_PARAM
-}
-
-void loadVoltageParameters(VoltageConfig& voltageConfig, JsonObject paramsObj) {
-    JsonObject voltageObj = paramsObj["voltage"].as<JsonObject>();
-    
-    #define LOAD_VOLTAGE_PARAM(field) \
-        if (voltageObj[#field].is<JsonObject>()) { \
-            JsonObject paramObj = voltageObj[#field].as<JsonObject>(); \
-            voltageConfig.field.divider = paramObj["divider"] | 1.0f; \
-        }
-    
-    LOAD_VOLTAGE_PARAM(Voltage);
-    LOAD_VOLTAGE_PARAM(phaseVoltageMean);
-    LOAD_VOLTAGE_PARAM(zeroSequenceVoltage);
-    
-    #undef LOAD_VOLTAGE_PARAM
-}
+// ==================== SLAVE CONFIGURATION MANAGEMENT ====================
 
-void loadEnergyParameters9(EnergyConfig& energyConfig, JsonObject paramsObj) {
-    JsonObject energyObj = paramsObj["energy"].as<JsonObject>();
-    
-    #define LOAD_ENERGY_PARAM(field) \
-        if (energyObj[#field].is<JsonObject>()) { \
-            JsonObject paramObj = energyObj[#field].as<JsonObject>(); \
-            energyConfig.field.divider = paramObj["divider"] | 1.0f; \
-        }
+bool buildSlaveFromConfig(SensorSlave& slave, JsonObject slaveObj) {
+    const char* deviceType = slaveObj["deviceType"];
     
-    LOAD_ENERGY_PARAM(totalActiveEnergy);
-    LOAD_ENERGY_PARAM(importActiveEnergy);
-    LOAD_ENERGY_PARAM(exportActiveEnergy);
-    LOAD_ENERGY_PARAM(totalReactiveEnergy);
-    LOAD_ENERGY_PARAM(importReactiveEnergy);
-    LOAD_ENERGY_PARAM(exportReactiveEnergy);
+    const CompiledTemplate* tmpl = findCompiledTemplate(deviceType);
+    if (tmpl == nullptr) {
+        return false;
+    }
     
-    #undef LOAD_ENERGY_PARAM
-}
-
-void loadEnergyParameters27(EnergyConfig& energyConfig, JsonObject paramsObj) {
-    JsonObject energyObj = paramsObj["energy"].as<JsonObject>();
+    slave.id = slaveObj["id"];
+    slave.startRegister = slaveObj["startReg"];
+    slave.registerCount = slaveObj["numReg"];
+    slave.name = slaveObj["name"].as<String>();
+    slave.mqttTopic = slaveObj["mqttTopic"].as<String>();
+    slave.ct = slaveObj["ct"];
+    slave.pt = slaveObj["pt"];
     
-    #define LOAD_ENERGY_PARAM(field) \
-        if (energyObj[#field].is<JsonObject>()) { \
-            JsonObject paramObj = energyObj[#field].as<JsonObject>(); \
-            energyConfig.field.divider = paramObj["divider"] | 1.0f; \
+    if (slaveObj["registerSize"].is<int>()) {
+        int size = slaveObj["registerSize"];
+        if (size >= 1 && size <= 4) {
+            slave.registerSize = static_cast<RegisterSize>(size);
+        } else {
+            slave.registerSize = SIZE_16BIT;
         }
+    } else {
+        slave.registerSize = SIZE_16BIT;
+    }
     
-    LOAD_ENERGY_PARAM(totalActiveEnergy);
-    LOAD_ENERGY_PARAM(importActiveEnergy);
-    LOAD_ENERGY_PARAM(exportActiveEnergy);
-    
-    #undef LOAD_ENERGY_PARAM
+    slave.program = resolveDecodeProgram(*tmpl, slave.registerSize);
+    slave.config = resolveDeviceParams(*tmpl, slaveObj["override"]);
+    slave.source = slaveObj;
+    return true;
 }
 
-// ==================== SLAVE CONFIGURATION MANAGEMENT ====================
-
 bool modbusReloadSlaves() {
     Serial.println("🔄 Reloading slaves with template system...");
+    unsigned long reloadStart = millis();
     
-    JsonDocument config;
-    if (!loadSlaveConfig(config)) {
+    if (!loadConfigStore()) {
         Serial.println("❌ Failed to load slave configuration");
         return false;
     }
     
     int newIntervalSeconds, newTimeoutSeconds;
-    loadPollingConfig(newIntervalSeconds, newTimeoutSeconds);
+    PollSchedule newSchedule;
+    loadPollingConfig(newIntervalSeconds, newTimeoutSeconds, newSchedule, modbusQueriesEnabled);
     
     updatePollInterval(newIntervalSeconds);
     updateTimeout(newTimeoutSeconds);
+    updatePollSchedule(newSchedule.mode, newSchedule.alignToClock);
     
-    currentState = STATE_IDLE;
-    currentSlaveIndex = 0;
-    waitingForResponse = false;
-
-    JsonArray slavesArray = config["slaves"];
+    JsonArray slavesArray = getConfiguredSlaves();
     int newSlaveCount = slavesArray.size();
     
-    if (slaves != nullptr) {
-        delete[] slaves;
-        slaves = nullptr;
+    // Diff keyed by id+name: sourceIndex[j] = old index of an unchanged slave, else -1.
+    // An entry equal to the one its live slave was built from is not rebuilt at all.
+    bool templatesChanged = (builtTemplateGeneration != getTemplateGeneration());
+    SensorSlave* newSlaves = new SensorSlave[newSlaveCount]();
+    int* sourceIndex = new int[newSlaveCount];
+    int* newIndexOfOld = new int[slaveCount];
+    for (int i = 0; i < slaveCount; i++) {
+        newIndexOfOld[i] = -1;
     }
     
-    slaves = new SensorSlave[newSlaveCount]();
-    slaveCount = newSlaveCount;
-    
-    for (int i = 0; i < slaveCount; i++) {
-        JsonObject slaveObj = slavesArray[i];
-        
-        const char* deviceType = slaveObj["deviceType"];
+    int keptCount = 0;
+    int changedCount = 0;
+    int addedCount = 0;
+    int failedCount = 0;
+    int builtCount = 0;
+    int j = 0;
+    for (JsonObject slaveObj : slavesArray) {
+        sourceIndex[j] = -1;
         
-        JsonDocument templateDoc;
-        JsonObject templateConfig = templateDoc.to<JsonObject>();
-        JsonDocument mergedDoc;
-        JsonObject mergedConfig = mergedDoc.to<JsonObject>();
+        int oldIndex = findSlaveIndex(slaveObj["id"], slaveObj["name"] | "");
+        if (oldIndex >= 0 && newIndexOfOld[oldIndex] >= 0) {
+            oldIndex = -1;      // Duplicate entry
+        }
         
-        if (!loadDeviceTemplate(deviceType, templateConfig)) {
+        if (oldIndex >= 0 && !templatesChanged && !slaves[oldIndex].source.isNull() &&
+            slaves[oldIndex].source == slaveObj) {
+            newIndexOfOld[oldIndex] = j;
+            sourceIndex[j] = oldIndex;
+            newSlaves[j].source = slaveObj;
+            keptCount++;
+            j++;
             continue;
         }
         
-        mergeWithOverride(slaveObj, templateConfig, mergedConfig);
-        
-        slaves[i].id = mergedConfig["id"] | slaveObj["id"];
-        slaves[i].startRegister = mergedConfig["startReg"] | slaveObj["startReg"];
-        slaves[i].registerCount = mergedConfig["numReg"] | slaveObj["numReg"];
-        slaves[i].name = mergedConfig["name"] | slaveObj["name"].as<String>();
-        slaves[i].mqttTopic = mergedConfig["mqttTopic"] | slaveObj["mqttTopic"].as<String>();
-        slaves[i].deviceType = determineDeviceTypeFromString(deviceType);
-        slaves[i].ct = mergedConfig["ct"] |  slaveObj["ct"];
-        slaves[i].pt = mergedConfig["pt"] |  slaveObj["pt"];
+        builtCount++;
+        if (!buildSlaveFromConfig(newSlaves[j], slaveObj)) {
+            // Left out of the live table, as a rejected single-slave edit would be
+            Serial.printf("❌ Slave %d (%s): template not found for deviceType %s\n",
+                          slaveObj["id"].as<int>(), slaveObj["name"] | "?", slaveObj["deviceType"] | "?");
+            newSlaves[j] = SensorSlave();
+            failedCount++;
+            continue;
+        }
         
-        if (slaveObj["registerSize"].is<int>()) {
-            int size = slaveObj["registerSize"];
-            if (size >= 1 && size <= 4) {
-                slaves[i].registerSize = static_cast<RegisterSize>(size);
+        if (oldIndex < 0) {
+            addedCount++;
+        } else {
+            newIndexOfOld[oldIndex] = j;
+            if (sameSlaveDefinition(slaves[oldIndex], newSlaves[j])) {
+                sourceIndex[j] = oldIndex;
+                keptCount++;
             } else {
-                slaves[i].registerSize = SIZE_16BIT;
+                changedCount++;
             }
-        } else {
-            slaves[i].registerSize = SIZE_16BIT;
         }
-        
-        loadDeviceParameters(slaves[i], mergedConfig);
+        j++;
+    }
+    newSlaveCount = j;
+    int removedCount = slaveCount - keptCount - changedCount;
+    
+    // Unchanged slaves keep their runtime state (Sparkplug births, report-by-exception values)
+    remapSparkplugDevices(sourceIndex, newSlaveCount);
+    clearRemovedSlaveMetadata(slavesArray);
+    remapSchedule(sourceIndex, newIndexOfOld, newSlaveCount);
+    
+    // Swap in one step - loop() only gets back to the state machine after this returns
+    for (int j = 0; j < newSlaveCount; j++) {
+        if (sourceIndex[j] >= 0) {
+            JsonObjectConst source = newSlaves[j].source;
+            newSlaves[j] = slaves[sourceIndex[j]];
+            newSlaves[j].source = source;
+        }
     }
+    CLEANUP(slaves);
+    slaves = newSlaves;
+    slaveCount = newSlaveCount;
+    builtTemplateGeneration = getTemplateGeneration();
+    releaseUnusedParams();
+    releaseReplacedSlaveConfig();
+    configureHistory(countDecodedChannels());
+    
+    delete[] sourceIndex;
+    delete[] newIndexOfOld;
     
-    Serial.printf("✅ Reloaded %d slaves with template system\n", slaveCount);
+    if (currentState == STATE_START_QUERY && currentSlaveIndex >= slaveCount) {
+        checkCycleCompletion();
+    }
+    
+    if (addedCount > 0 || changedCount > 0 || removedCount > 0) {
+        requestSlaveMetadata();
+    }
+    
+    Serial.printf("✅ Reloaded %d slaves in %lu ms: %d kept, %d changed, %d added, %d removed, %d failed, "
+                  "%d built, %d decode programs, %d parameter sets\n",
+                  slaveCount, millis() - reloadStart, keptCount, changedCount, addedCount, removedCount,
+                  failedCount, builtCount, getDecodeProgramCount(), getParamSetCount());
     return true;
 }
 
-// ==================== DATA PROCESSING HELPERS ====================
-
-void processSensorData(JsonObject& root, const SensorConfig& sensorConfig, uint64_t* combinedValues, RegisterSize regSize) {
-    uint16_t tempRaw = combinedValues[0] & 0xFFFF;
-    uint16_t humidRaw = combinedValues[1] & 0xFFFF;
+/**
+ * @brief Adopt a slave table built outside modbusReloadSlaves() (the boot config
+ *        blob). Only valid while the table is still empty.
+ */
+void installBootSlaves(SensorSlave* table, int count) {
+    int* sourceIndex = new int[count];
+    for (int j = 0; j < count; j++) {
+        sourceIndex[j] = -1;
+    }
+    remapSparkplugDevices(sourceIndex, count);
+    delete[] sourceIndex;
     
-    root["temperature_(C)"] = convertRegisterToTemperature(tempRaw, sensorConfig.tempDivider);
+    CLEANUP(slaves);
+    slaves = table;
+    slaveCount = count;
+    releaseUnusedParams();
+    configureHistory(countDecodedChannels());
+    requestSlaveMetadata();   // Retained metadata goes out once MQTT connects
+}
+
+/**
+ * @brief Outputs of every live slave, i.e. the channels history may see
+ */
+uint16_t countDecodedChannels() {
+    uint16_t channels = 0;
+    for (int i = 0; i < slaveCount; i++) {
+        channels += slaves[i].program->opCount;
+    }
+    return channels;
+}
 
-    root["temperature_(F)"] = ((convertRegisterToTemperature(tempRaw, sensorConfig.tempDivider)) * 9/5) + 32;
+bool sameSlaveDefinition(const SensorSlave& a, const SensorSlave& b) {
+    return a.id == b.id && a.name == b.name && a.mqttTopic == b.mqttTopic &&
+           a.startRegister == b.startRegister && a.registerCount == b.registerCount &&
+           a.registerSize == b.registerSize && a.program == b.program &&
+           a.ct == b.ct && a.pt == b.pt &&
+           (a.config == b.config || memcmp(a.config, b.config, sizeof(DeviceParams)) == 0);
+}
+
+/**
+ * @brief Keep the poll cycle where it is across a reload. A reply in flight for a
+ *        changed or removed slave is dropped; the cycle resumes at the same place.
+ */
+void remapSchedule(const int* sourceIndex, const int* newIndexOfOld, int newSlaveCount) {
+    bool cycleRunning = (currentState == STATE_START_QUERY || currentState == STATE_PROCESS_DATA);
+    if (!cycleRunning || currentSlaveIndex >= slaveCount) return;
+    
+    int newIndex = newIndexOfOld[currentSlaveIndex];
+    if (newIndex >= 0 && sourceIndex[newIndex] == currentSlaveIndex) {
+        currentSlaveIndex = newIndex;
+        return;
+    }
     
-    root["humidity"] = convertRegisterToHumidity(humidRaw, sensorConfig.humidDivider);
+    currentSlaveIndex = (newIndex >= 0) ? newIndex : min((int)currentSlaveIndex, newSlaveCount);
+    if (currentState != STATE_START_QUERY) {
+        currentState = STATE_START_QUERY;
+        waitingForResponse = false;
+    }
+}
+
+int findSlaveIndex(uint8_t slaveId, const char* slaveName) {
+    for (int i = 0; i < slaveCount; i++) {
+        if (slaves[i].id == slaveId && slaves[i].name == slaveName) {
+            return i;
+        }
+    }
+    return -1;
 }
 
-void processMeterData(JsonObject& root, const MeterConfig& meterConfig, uint64_t* combinedValues, RegisterSize regSize, float ct, float pt) {
-    int valueIndex = 0;
+/**
+ * @brief Merge a partial config into one slave, persist it and rebuild only that slave.
+ *        Identity (id, name) is the lookup key and cannot be patched.
+ */
+bool applySlavePatch(int slaveIndex, JsonObject patch, String& error) {
+    static const char* const kPatchableFields[] = {
+        "startReg", "numReg", "registerSize", "mqttTopic", "ct", "pt", "deviceType"
+    };
     
-    // Current measurements - all use the same Current divider
-    root["A_Current_(A)"] = calculateCurrent(combinedValues[valueIndex++], meterConfig.Current.divider);
-    root["B_Current_(A)"] = calculateCurrent(combinedValues[valueIndex++], meterConfig.Current.divider);
-    root["C_Current_(A)"] = calculateCurrent(combinedValues[valueIndex++], meterConfig.Current.divider);
-    root["Zero_Phase_Current_(A)"] = calculateCurrent(combinedValues[valueIndex++], meterConfig.zeroPhaseCurrent.divider);
+    if (slaveIndex < 0 || slaveIndex >= slaveCount) {
+        error = "Slave not found";
+        return false;
+    }
     
-    // Active Power - A/B/C use ActivePower divider, Total uses totalActivePower divider
-    root["A_Active_Power_(kW)"] = calculateSinglePhasePower(convertToSigned(combinedValues[valueIndex++], regSize), meterConfig.ActivePower.divider, ct, pt);
-    root["B_Active_Power_(kW)"] = calculateSinglePhasePower(convertToSigned(combinedValues[valueIndex++], regSize), meterConfig.ActivePower.divider, ct, pt);
-    root["C_Active_Power_(kW)"] = calculateSinglePhasePower(convertToSigned(combinedValues[valueIndex++], regSize), meterConfig.ActivePower.divider, ct, pt);
-    root["Total_Active_Power_(kW)"] = calculateThreePhasePower(convertToSigned(combinedValues[valueIndex++], regSize), meterConfig.totalActivePower.divider, ct, pt);
+    JsonObject storedObj = findSlaveConfig(slaves[slaveIndex].id, slaves[slaveIndex].name.c_str());
+    if (storedObj.isNull()) {
+        error = "Slave missing from slaves.json";
+        return false;
+    }
     
-    // Reactive Power - A/B/C use ReactivePower divider, Total uses totalReactivePower divider
-    root["A_Reactive_Power_(kVAr)"] = calculateSinglePhasePower(convertToSigned(combinedValues[valueIndex++], regSize), meterConfig.ReactivePower.divider, ct, pt);
-    root["B_Reactive_Power_(kVAr)"] = calculateSinglePhasePower(convertToSigned(combinedValues[valueIndex++], regSize), meterConfig.ReactivePower.divider, ct, pt);
-    root["C_Reactive_Power_(kVAr)"] = calculateSinglePhasePower(convertToSigned(combinedValues[valueIndex++], regSize), meterConfig.ReactivePower.divider, ct, pt);
-    root["Total_Reactive_Power_(kVAr)"] = calculateThreePhasePower(convertToSigned(combinedValues[valueIndex++], regSize), meterConfig.totalReactivePower.divider, ct, pt);
+    // Patch a copy so a rejected patch leaves the resident config untouched
+    JsonDocument patchedDoc;
+    patchedDoc.set(storedObj);
+    JsonObject slaveObj = patchedDoc.as<JsonObject>();
     
-    // Apparent Power - A/B/C use ApparentPower divider, Total uses totalApparentPower divider
-    root["A_Apparent_Power_(kVA)"] = calculateSinglePhasePower(convertToSigned(combinedValues[valueIndex++], regSize), meterConfig.ApparentPower.divider, ct, pt);
-    root["B_Apparent_Power_(kVA)"] = calculateSinglePhasePower(convertToSigned(combinedValues[valueIndex++], regSize), meterConfig.ApparentPower.divider, ct, pt);
-    root["C_Apparent_Power_(kVA)"] = calculateSinglePhasePower(convertToSigned(combinedValues[valueIndex++], regSize), meterConfig.ApparentPower.divider, ct, pt);
-    root["Total_Apparent_Power_(kVA)"] = calculateThreePhasePower(convertToSigned(combinedValues[valueIndex++], regSize), meterConfig.totalApparentPower.divider, ct, pt);
+    for (JsonPair kv : patch) {
+        const char* key = kv.key().c_str();
+        
+        if (strcmp(key, "override") == 0 && kv.value().is<JsonObject>()) {
+            JsonObject overrideObj = slaveObj["override"].is<JsonObject>()
+                ? slaveObj["override"].as<JsonObject>()
+                : slaveObj["override"].to<JsonObject>();
+            deepMerge(kv.value().as<JsonObject>(), overrideObj);
+            continue;
+        }
+        
+        bool patchable = false;
+        for (const char* field : kPatchableFields) {
+            if (strcmp(key, field) == 0) {
+                patchable = true;
+                break;
+            }
+        }
+        if (!patchable) {
+            error = String("Field not patchable: ") + key;
+            return false;
+        }
+        slaveObj[key] = kv.value();
+    }
     
-    // Power Factor - A/B/C use PowerFactor divider, Total uses totalPowerFactor divider
-    root["A_Power_Factor"] = calculatePowerFactor(convertToSigned(combinedValues[valueIndex++], regSize), meterConfig.PowerFactor.divider);
-    root["B_Power_Factor"] = calculatePowerFactor(convertToSigned(combinedValues[valueIndex++], regSize), meterConfig.PowerFactor.divider);
-    root["C_Power_Factor"] = calculatePowerFactor(convertToSigned(combinedValues[valueIndex++], regSize), meterConfig.PowerFactor.divider);
-    root["Total_Power_Factor"] = calculatePowerFactor(convertToSigned(combinedValues[valueIndex++], regSize), meterConfig.totalPowerFactor.divider);
+    return commitSlaveConfig(slaveIndex, slaveObj, error);
 }
 
-void processVoltageData(JsonObject& root, const VoltageConfig& voltageConfig, uint64_t* combinedValues, RegisterSize regSize, float pt) {
-    int valueIndex = 0;
+/**
+ * @brief Store a complete slave config and swap in only that slave's rebuilt entry.
+ *        The cycle in progress, the other slaves and all statistics are untouched.
+ */
+bool commitSlaveConfig(int slaveIndex, JsonObject slaveObj, String& error) {
+    if (slaveIndex < 0 || slaveIndex >= slaveCount) {
+        error = "Slave not found";
+        return false;
+    }
     
-    // A/B/C voltages use the same Voltage divider
-    root["A_Voltage_(V)"] = calculateVoltage(combinedValues[valueIndex++], voltageConfig.Voltage.divider, pt);
-    root["B_Voltage_(V)"] = calculateVoltage(combinedValues[valueIndex++], voltageConfig.Voltage.divider, pt);
-    root["C_Voltage_(V)"] = calculateVoltage(combinedValues[valueIndex++], voltageConfig.Voltage.divider, pt);
-    root["Phase_Voltage_Mean"] = calculateVoltage(combinedValues[valueIndex++], voltageConfig.phaseVoltageMean.divider, pt);
-    root["Zero_Sequence_Voltage"] = calculateVoltage(combinedValues[valueIndex++], voltageConfig.zeroSequenceVoltage.divider, pt);
-}
-
-void processEnergyData9(JsonObject& root, const EnergyConfig& energyConfig, uint64_t* combinedValues, RegisterSize regSize) {
-    int valueIndex = 0;
+    JsonObject storedObj = findSlaveConfig(slaves[slaveIndex].id, slaves[slaveIndex].name.c_str());
+    if (storedObj.isNull()) {
+        error = "Slave missing from slaves.json";
+        return false;
+    }
     
-    root["Total_Active_Energy_(kwH)"] = readEnergyValue(combinedValues[valueIndex++], energyConfig.totalActiveEnergy.divider);
-    root["Import_Active_Energy_(kwH)"] = readEnergyValue(combinedValues[valueIndex++], energyConfig.importActiveEnergy.divider);
-    root["Export_Active_Energy_(kwH)"] = readEnergyValue(combinedValues[valueIndex++], energyConfig.exportActiveEnergy.divider);
-    root["Total_Reactive_Energy_(KVArh)"] = readEnergyValue(combinedValues[valueIndex++], energyConfig.totalReactiveEnergy.divider);
-    root["Import_Reactive_Energy_(KVArh)"] = readEnergyValue(combinedValues[valueIndex++], energyConfig.importReactiveEnergy.divider);
-    root["Export_Reactive_Energy_(KVArh)"] = readEnergyValue(combinedValues[valueIndex++], energyConfig.exportReactiveEnergy.divider);
-}
-
-void processEnergyData27(JsonObject& root, const EnergyConfig& energyConfig, uint64_t* combinedValues, RegisterSize regSize) {
-    int valueIndex = 0;
+    // Validate before touching the stored config or the live slave table
+    SensorSlave rebuilt = SensorSlave();
+    if (!buildSlaveFromConfig(rebuilt, slaveObj)) {
+        error = "Template not found for deviceType";
+        return false;
+    }
+    if (rebuilt.id != slaves[slaveIndex].id || rebuilt.name != slaves[slaveIndex].name) {
+        error = "Slave id and name cannot be changed";
+        return false;
+    }
+    storedObj.set(slaveObj);
+    rebuilt.source = storedObj;     // Not the caller's scratch copy
+    markSlaveConfigDirty();
+    
+    if (rebuilt.mqttTopic != slaves[slaveIndex].mqttTopic && !isSparkplugEnabled() && isMQTTConnected()) {
+        String metaTopic = slaves[slaveIndex].mqttTopic + "/meta";
+        publishMessage(metaTopic.c_str(), "", true);
+    }
     
-    root["Total_Active_Energy_(kwH)"] = readEnergyValue(combinedValues[valueIndex++], energyConfig.totalActiveEnergy.divider);
-    root["Import_Active_Energy_(kwH)"] = readEnergyValue(combinedValues[valueIndex++], energyConfig.importActiveEnergy.divider);
-    root["Export_Active_Energy_(kwH)"] = readEnergyValue(combinedValues[valueIndex++], energyConfig.exportActiveEnergy.divider);
+    // DDEATH now, DBIRTH with the new metric set on the next reading
+    publishSparkplugDeviceDeath(slaveIndex);
+    slaves[slaveIndex] = rebuilt;
+    releaseUnusedParams();
+    requestSlaveMetadata();
     
+    Serial.printf("🩹 Updated slave %d: %s\n", rebuilt.id, rebuilt.name.c_str());
+    return true;
+}
+
+/**
+ * @brief True while a poll of this slave has been sent but not yet decoded;
+ *        its entry must not be swapped until the reply is processed.
+ */
+bool isSlaveInTransaction(int slaveIndex) {
+    return currentState == STATE_PROCESS_DATA && currentSlaveIndex == slaveIndex;
 }
 
-void publishData(const SensorSlave& slave, const JsonDocument& doc) {
+// ==================== DATA PROCESSING HELPERS ====================
+
+void publishData(const SensorSlave& slave, const JsonDocument& doc, uint32_t sampledAt, uint64_t sampleTimestamp) {
     String sameDeviceDelta = getSameDeviceDelta(slave.id, slave.name.c_str(), false);
     getSameDeviceDelta(slave.id, slave.name.c_str(), true);
     
@@ -371,10 +422,84 @@ void publishData(const SensorSlave& slave, const JsonDocument& doc) {
     
     String output;
     serializeJson(doc, output);
-    publishMessage(slave.mqttTopic.c_str(), output.c_str());
+    
+    // The acquisition time travels with the reading through the publish queue
+    if (isSparkplugEnabled()) {
+        publishSparkplugDeviceData(&slave - slaves, doc.as<JsonObjectConst>(), sampleTimestamp, sampledAt);
+    } else {
+        publishMessage(slave.mqttTopic.c_str(), output.c_str(), false, sampledAt);
+    }
+    
+    recordHistorySamples(slave.id, slave.name.c_str(), doc.as<JsonObjectConst>(), sampledAt, sampleTimestamp);
     
     if (debugEnabled) {
-        addDebugMessage(slave.mqttTopic.c_str(), output.c_str(), formattedDelta.c_str(), sameDeviceDelta.c_str());
+        addDebugMessage(slave.mqttTopic.c_str(), output.c_str(), formattedDelta.c_str(), sameDeviceDelta.c_str(),
+                        slave.id, slave.name.c_str());
+    }
+}
+
+// ==================== SLAVE METADATA ====================
+
+/**
+ * @brief Restart the retained metadata pass from the first slave
+ */
+void requestSlaveMetadata() {
+    slaveMetadataPending = true;
+    metadataCursor = 0;
+}
+
+/**
+ * @brief Queue the next few slaves' retained metadata. The queue drains a few
+ *        messages per loop and evicts the oldest when full, so a whole table at
+ *        once would push out earlier records before they are sent.
+ */
+void publishSlaveMetadata() {
+    // Sparkplug describes devices in DBIRTH instead
+    if (isSparkplugEnabled() || !isMQTTConnected()) return;
+    if (getPublishQueueStats().depth >= kMaxDrainPerLoop) return;
+    
+    int batchEnd = min(metadataCursor + (int)kMetadataPerLoop, slaveCount);
+    for (; metadataCursor < batchEnd; metadataCursor++) {
+        const SensorSlave& slave = slaves[metadataCursor];
+        
+        JsonDocument doc;
+        doc["id"] = slave.id;
+        doc["name"] = slave.name;
+        doc["mqtt_topic"] = slave.mqttTopic;
+        doc["start_reg"] = slave.startRegister;
+        doc["num_reg"] = slave.registerCount;
+        doc["register_size"] = slave.registerSize;
+        doc["ct"] = slave.ct;
+        doc["pt"] = slave.pt;
+        
+        String output;
+        serializeJson(doc, output);
+        String metaTopic = slave.mqttTopic + "/meta";
+        publishMessage(metaTopic.c_str(), output.c_str(), true);
+    }
+    
+    if (metadataCursor < slaveCount) return;
+    slaveMetadataPending = false;
+    Serial.printf("📋 Published retained metadata for %d slaves\n", slaveCount);
+}
+
+void clearRemovedSlaveMetadata(JsonArray newSlaves) {
+    if (isSparkplugEnabled() || !isMQTTConnected()) return;
+    
+    for (int i = 0; i < slaveCount; i++) {
+        bool stillPublished = false;
+        for (JsonObject newSlave : newSlaves) {
+            if (slaves[i].mqttTopic == newSlave["mqttTopic"].as<const char*>()) {
+                stillPublished = true;
+                break;
+            }
+        }
+        
+        if (!stillPublished) {
+            // Empty retained payload deletes the retained message on the broker
+            String metaTopic = slaves[i].mqttTopic + "/meta";
+            publishMessage(metaTopic.c_str(), "", true);
+        }
     }
 }
 
@@ -383,13 +508,15 @@ void publishData(const SensorSlave& slave, const JsonDocument& doc) {
 void publishSlaveError(uint8_t slaveId, const char* slaveName, const char* errorMsg) {
     JsonDocument doc;
     JsonObject root = doc.to<JsonObject>();
-    root["id"] = slaveId;
-    root["name"] = slaveName;
     root["error"] = errorMsg;
+    root["timestamp"] = getTimestampMillis();
     
     for (int i = 0; i < slaveCount; i++) {
         if (slaves[i].id == slaveId && slaves[i].name == slaveName) {
-            root["mqtt_topic"] = slaves[i].mqttTopic;
+            if (isSparkplugEnabled()) {
+                publishSparkplugDeviceDeath(i);   // Unreachable slave maps to DDEATH
+                return;
+            }
             publishData(slaves[i], doc);
             return;
         }
@@ -398,13 +525,7 @@ void publishSlaveError(uint8_t slaveId, const char* slaveName, const char* error
 
 // ==================== NON-BLOCKING QUERY STATE MACHINE ====================
 
-bool startNonBlockingQuery() {
-    if (currentSlaveIndex >= slaveCount) {
-        return false;
-    }
-    
-    SensorSlave& slave = slaves[currentSlaveIndex];
-    
+void beginSlaveTransaction(const SensorSlave& slave) {
     node.begin(slave.id, Serial);
     node.preTransmission(preTransmission);
     node.postTransmission(postTransmission);
@@ -412,59 +533,118 @@ bool startNonBlockingQuery() {
     node.clearTransmitBuffer();
 
     delay(300);
+}
 
-    uint8_t result = node.readHoldingRegisters(slave.startRegister, slave.registerCount);
+bool startNonBlockingQuery() {
+    if (currentSlaveIndex >= slaveCount) {
+        return false;
+    }
+    
+    SensorSlave& slave = slaves[currentSlaveIndex];
+    unsigned long busStart = millis();
+    recordFirstPoll();
+    beginSlaveTransaction(slave);
+
+    queryResult = node.readHoldingRegisters(slave.startRegister, slave.registerCount);
     queryStartTime = millis();
+    acquisitionMillis = queryStartTime;
+    acquisitionTimestamp = getTimestampMillis();
+    recordBusActivity(queryStartTime - busStart);
     waitingForResponse = true;
 
     Serial.printf("➡️ Querying slave %d: %s\n", slave.id, slave.name.c_str());
-    return (result == node.ku8MBSuccess);
+    return (queryResult == node.ku8MBSuccess);
+}
+
+/**
+ * @brief Run the slave's compiled register map over the response. The registers
+ *        are copied once to the stack; no allocation per reading.
+ */
+void decodeSlaveData(const SensorSlave& slave, JsonObject& root) {
+    uint16_t registerCount = min(slave.registerCount, kMaxResponseRegisters);
+    uint16_t registers[kMaxResponseRegisters];
+    readAllRegistersIntoArray(registers, registerCount);
+    
+    runDecodeProgram(*slave.program, *slave.config, slave.ct, slave.pt, registers, registerCount, root);
 }
 
 void processNonBlockingData() {
     SensorSlave& slave = slaves[currentSlaveIndex];
     JsonDocument doc;
     JsonObject root = doc.to<JsonObject>();
+    uint64_t sampleTimestamp = getSampleTimestamp();
 
-    root["id"] = slave.id;
-    root["name"] = slave.name;
-    root["mqtt_topic"] = slave.mqttTopic;
-    root["start_reg"] = slave.startRegister;
-    root["num_reg"] = slave.registerCount;
-    root["register_size"] = slave.registerSize;
-    root["ct"] = slave.ct;
-    root["pt"] = slave.pt;
-    
+    // Static slave fields live on the retained <topic>/meta message (or DBIRTH)
+    if (!isSparkplugEnabled()) {
+        root["timestamp"] = sampleTimestamp;
+    }
 
-    uint16_t* rawRegisters = new uint16_t[slave.registerCount];
-    readAllRegistersIntoArray(rawRegisters, slave.registerCount);
+    decodeSlaveData(slave, root);
     
-    uint16_t combinedCount = 0;
-    uint64_t* combinedValues = combineRegistersBySize(rawRegisters, slave.registerCount, slave.registerSize, combinedCount);
-    
-    switch(slave.deviceType) {
-        case DEVICE_G01S:
-            processSensorData(root, slave.config.sensor, combinedValues, slave.registerSize);
-            break;
-        case DEVICE_HEYLA_PARAM:
-            processMeterData(root, slave.config.meter, combinedValues, slave.registerSize, slave.ct, slave.pt);
-            break;
-        case DEVICE_HEYLA_VOLTAGE:
-            processVoltageData(root, slave.config.voltage, combinedValues, slave.registerSize, slave.pt);
-            break;
-        case DEVICE_HEYLA_ENERGY9:
-            processEnergyData9(root, slave.config.energy, combinedValues, slave.registerSize);
-            break;
-        case DEVICE_HEYLA_ENERGY27:
-            processEnergyData27(root, slave.config.energy, combinedValues, slave.registerSize);
-            break;
+    publishData(slave, doc, acquisitionMillis, sampleTimestamp);
+    waitingForResponse = false;
+}
+
+// ==================== POLL SCHEDULE ====================
+
+void startPollCycle(unsigned long now) {
+    currentState = STATE_START_QUERY;
+    currentSlaveIndex = 0;
+    lastActionTime = now;
+    cycleStartTime = now;
+    waitingForResponse = false;
+}
+
+bool isPollAlignedToClock() {
+    return pollSchedule.mode == POLL_FIXED_RATE && pollSchedule.alignToClock && isWallClockSet();
+}
+
+/**
+ * @brief ms from now to the next wall-clock multiple of pollInterval, in (0, pollInterval]
+ */
+unsigned long msUntilPollBoundary() {
+    if (pollInterval == 0) return kDefaultPollInterval;
+    return pollInterval - getTimestampMillis() % pollInterval;
+}
+
+void scheduleFirstTick(unsigned long now) {
+    if (isPollAlignedToClock()) {
+        nextCycleTime = now + msUntilPollBoundary();
+    } else if (currentState == STATE_WAITING || currentState == STATE_IDLE) {
+        nextCycleTime = now;
+    } else {
+        nextCycleTime = now + pollInterval;     // Mid-cycle; the new phase starts after it
     }
+}
+
+void startFixedRateCycle(unsigned long now) {
+    unsigned long lateMs = now - nextCycleTime;
+    recordPollJitter(lateMs);
+    cycleTimestamp = getTimestampMillis() - lateMs;
     
-    CLEANUP(rawRegisters);
-    CLEANUP(combinedValues);
+    if (isPollAlignedToClock() && pollInterval > 0) {
+        // Snap to the boundary and re-derive the next tick from the wall clock,
+        // so NTP corrections pull the schedule back into phase
+        cycleTimestamp = (cycleTimestamp + pollInterval / 2) / pollInterval * pollInterval;
+        nextCycleTime = now + msUntilPollBoundary();
+        if (nextCycleTime - now < pollInterval / 2) {
+            nextCycleTime += pollInterval;
+        }
+    } else {
+        nextCycleTime += pollInterval;
+    }
     
-    publishData(slave, doc);
-    waitingForResponse = false;
+    Serial.printf("🔄 NEW CYCLE (fixed rate) | Late: %lums\n", lateMs);
+    startPollCycle(now);
+}
+
+/**
+ * @brief Timestamp for the reading just taken: when its response arrived, or
+ *        for aligned fixed-rate cycles their tick, so gateways polling the same
+ *        interval agree.
+ */
+uint64_t getSampleTimestamp() {
+    return isPollAlignedToClock() ? cycleTimestamp : acquisitionTimestamp;
 }
 
 void checkCycleCompletion() {
@@ -472,9 +652,18 @@ void checkCycleCompletion() {
         unsigned long currentTime = millis();
         
         lastSequenceTime = currentTime;
+        recordPollCycle(currentTime - cycleStartTime);
         currentState = STATE_WAITING;
         lastActionTime = currentTime;
         
+        if (pollSchedule.mode == POLL_FIXED_RATE && pollInterval > 0 && (long)(currentTime - nextCycleTime) >= 0) {
+            // Ran past the next tick: drop the ticks it covered rather than start late
+            unsigned long missed = (currentTime - nextCycleTime) / pollInterval + 1;
+            nextCycleTime += missed * pollInterval;
+            recordPollOverrun(missed);
+            Serial.printf("⚠️ Poll cycle overran, skipped %lu tick(s)\n", missed);
+        }
+        
         addBatchSeparatorMessage();
         
         Serial.printf("🎉 Cycle complete - sequence time reset to: %lu\n", currentTime);
@@ -490,7 +679,7 @@ void handleQueryStartFailure() {
 }
 
 void handleQueryTimeout() {
-    Serial.printf("⏰ TIMEOUT on slave %d after %lu ms - SKIPPING TO NEXT!\n", slaves[currentSlaveIndex].id, timeoutDuration);
+    Serial.printf("⏰ TIMEOUT on slave %d - SKIPPING TO NEXT!\n", slaves[currentSlaveIndex].id);
     updateSlaveStatistic(slaves[currentSlaveIndex].id, slaves[currentSlaveIndex].name.c_str(), false, true);
     publishSlaveError(slaves[currentSlaveIndex].id, slaves[currentSlaveIndex].name.c_str(), "Modbus timeout - no response from device");
     waitingForResponse = false;
@@ -501,10 +690,16 @@ void updateNonBlockingQuery() {
     
     switch (currentState) {
         case STATE_IDLE:
-            currentState = STATE_START_QUERY;
-            currentSlaveIndex = 0;
-            lastActionTime = currentTime;
-            waitingForResponse = false;
+            if (pollSchedule.mode == POLL_FIXED_RATE) {
+                // First cycle waits for its tick (a clock boundary when aligned)
+                currentState = STATE_WAITING;
+                lastActionTime = currentTime;
+                scheduleFirstTick(currentTime);
+                Serial.printf("🚀 Fixed-rate polling, first cycle in %lums\n", nextCycleTime - currentTime);
+                break;
+            }
+            startPollCycle(currentTime);
+            cycleTimestamp = getTimestampMillis();
             Serial.println("🚀 Starting NON-BLOCKING query cycle");
             break;
             
@@ -512,27 +707,28 @@ void updateNonBlockingQuery() {
             if (currentTime - lastActionTime >= kQueryInterval) {
                 lastActionTime = currentTime;
                 
+                // Remote commands take the slot between two slaves
+                if (hasPendingBusCommand()) {
+                    serviceBusCommand();
+                    break;
+                }
+                
+                // The read blocks until the reply or ModbusMaster's timeout; its
+                // result decides, whatever the registers hold
                 if (startNonBlockingQuery()) {
-                    currentState = STATE_WAIT_RESPONSE;
-                    Serial.printf("⏳ Waiting for slave %d response...\n", slaves[currentSlaveIndex].id);
+                    currentState = STATE_PROCESS_DATA;
                 } else {
-                    handleQueryStartFailure();
+                    if (queryResult == node.ku8MBResponseTimedOut) {
+                        handleQueryTimeout();
+                    } else {
+                        handleQueryStartFailure();
+                    }
                     currentSlaveIndex++;
                     checkCycleCompletion();
                 }
             }
             break;
             
-        case STATE_WAIT_RESPONSE:
-            if (currentTime - queryStartTime > timeoutDuration) {
-                handleQueryTimeout();
-                currentSlaveIndex++;
-                checkCycleCompletion();
-            } else if (node.getResponseBuffer(0) != 0xFFFF) {
-                currentState = STATE_PROCESS_DATA;
-            }
-            break;
-            
         case STATE_PROCESS_DATA:
             processNonBlockingData();
             updateSlaveStatistic(slaves[currentSlaveIndex].id, slaves[currentSlaveIndex].name.c_str(), true, false);
@@ -541,38 +737,232 @@ void updateNonBlockingQuery() {
             break;
             
         case STATE_WAITING:
-            if (currentTime - lastActionTime >= pollInterval) {
+            if (hasPendingBusCommand()) {
+                serviceBusCommand();
+            }
+            
+            if (pollSchedule.mode == POLL_FIXED_RATE) {
+                if ((long)(currentTime - nextCycleTime) >= 0) {
+                    startFixedRateCycle(currentTime);
+                }
+            } else if (currentTime - lastActionTime >= pollInterval) {
+                recordPollJitter((currentTime - lastActionTime) - pollInterval);
                 Serial.printf("🔄 NEW CYCLE | Waited: %lums | Expected: %lums | Diff: %lums\n", currentTime - lastActionTime, pollInterval, (currentTime - lastActionTime) - pollInterval);
-                currentState = STATE_START_QUERY;
-                currentSlaveIndex = 0;
-                lastActionTime = currentTime;
-                waitingForResponse = false;
+                startPollCycle(currentTime);
+                cycleTimestamp = getTimestampMillis();
             }
             break;
     }
 }
 
+/**
+ * @brief Milliseconds until updateNonBlockingQuery() has something to do, so the
+ *        scheduler can sleep until then instead of polling
+ */
+unsigned long getModbusDueIn(unsigned long now) {
+    unsigned long elapsed = now - lastActionTime;
+    
+    switch (currentState) {
+        case STATE_START_QUERY:
+            // A pending command also waits for the gap between slaves, so it is not due earlier
+            return (elapsed >= kQueryInterval) ? 0 : kQueryInterval - elapsed;
+            
+        case STATE_WAITING:
+            if (hasPendingBusCommand()) return 0;   // Served on the next run, between cycles
+            if (pollSchedule.mode == POLL_FIXED_RATE) {
+                long remaining = (long)(nextCycleTime - now);
+                return (remaining > 0) ? remaining : 0;
+            }
+            return (elapsed >= pollInterval) ? 0 : pollInterval - elapsed;
+            
+        default:
+            return 0;   // Idle start, or a reply already read and waiting to be decoded
+    }
+}
+
+// ==================== REMOTE COMMAND EXECUTION ====================
+
+bool queueBusCommand(const BusCommand& command, JsonObject patch) {
+    if (pendingCommand.type != BUS_CMD_NONE) {
+        return false;   // One in flight; the caller reports "busy"
+    }
+    
+    pendingCommand = command;
+    pendingPatch.clear();
+    if (command.type == BUS_CMD_PATCH) {
+        pendingPatch.set(patch);
+    }
+    return true;
+}
+
+bool hasPendingBusCommand() {
+    return pendingCommand.type != BUS_CMD_NONE;
+}
+
+void executeRemoteRead(const BusCommand& command, const SensorSlave& slave) {
+    unsigned long busStart = millis();
+    beginSlaveTransaction(slave);
+    uint8_t result = node.readHoldingRegisters(slave.startRegister, slave.registerCount);
+    recordBusActivity(millis() - busStart);
+    updateSlaveStatistic(slave.id, slave.name.c_str(), result == node.ku8MBSuccess, result == node.ku8MBResponseTimedOut);
+    
+    if (result != node.ku8MBSuccess) {
+        char message[32];
+        snprintf(message, sizeof(message), "Modbus error 0x%02X", result);
+        publishCommandResponse(command.correlationId, "read", message);
+        return;
+    }
+    
+    JsonDocument doc;
+    JsonObject root = doc.to<JsonObject>();
+    root["timestamp"] = getTimestampMillis();
+    decodeSlaveData(slave, root);
+    publishCommandResponse(command.correlationId, "read", nullptr, doc.as<JsonObjectConst>());
+}
+
+void executeRemoteWrite(const BusCommand& command, const SensorSlave& slave) {
+    unsigned long busStart = millis();
+    beginSlaveTransaction(slave);
+    
+    uint8_t result;
+    if (command.valueCount == 1) {
+        result = node.writeSingleRegister(command.startRegister, command.values[0]);
+    } else {
+        for (uint8_t i = 0; i < command.valueCount; i++) {
+            node.setTransmitBuffer(i, command.values[i]);
+        }
+        result = node.writeMultipleRegisters(command.startRegister, command.valueCount);
+    }
+    recordBusActivity(millis() - busStart);
+    
+    if (result != node.ku8MBSuccess) {
+        char message[32];
+        snprintf(message, sizeof(message), "Modbus error 0x%02X", result);
+        publishCommandResponse(command.correlationId, "write", message);
+        return;
+    }
+    
+    Serial.printf("✍️ Wrote %d register(s) at %d on slave %d\n", command.valueCount, command.startRegister, slave.id);
+    publishCommandResponse(command.correlationId, "write", nullptr);
+}
+
+void serviceBusCommand() {
+    BusCommand command = pendingCommand;
+    pendingCommand.type = BUS_CMD_NONE;
+    
+    // Resolved now: a reload may have reshuffled the table since the command arrived
+    int slaveIndex = findSlaveIndex(command.slaveId, command.slaveName);
+    const char* commandName = (command.type == BUS_CMD_READ) ? "read"
+                            : (command.type == BUS_CMD_WRITE) ? "write" : "patchSlave";
+    
+    if (slaveIndex < 0) {
+        publishCommandResponse(command.correlationId, commandName, "Slave not found");
+        return;
+    }
+    
+    switch (command.type) {
+        case BUS_CMD_READ:
+            executeRemoteRead(command, slaves[slaveIndex]);
+            break;
+        case BUS_CMD_WRITE:
+            executeRemoteWrite(command, slaves[slaveIndex]);
+            break;
+        case BUS_CMD_PATCH: {
+            String error;
+            bool applied = applySlavePatch(slaveIndex, pendingPatch.as<JsonObject>(), error);
+            publishCommandResponse(command.correlationId, commandName, applied ? nullptr : error.c_str());
+            pendingPatch.clear();
+            break;
+        }
+        default:
+            break;
+    }
+}
+
 // ==================== CONFIGURATION MANAGEMENT ====================
 
 void updateTimeout(int newTimeoutSeconds) {
-    timeoutDuration = newTimeoutSeconds * 1000;
+    if (newTimeoutSeconds < kMinTimeoutSeconds || newTimeoutSeconds > kMaxTimeoutSeconds) {
+        Serial.printf("❌ Timeout %d s out of range, keeping %lu ms\n", newTimeoutSeconds, timeoutDuration);
+        return;
+    }
+    timeoutDuration = newTimeoutSeconds * 1000UL;
+    bumpStatusVersion(STATUS_POLLING);
     Serial.printf("⏱️  Timeout updated to: %d seconds (%lu ms)\n", newTimeoutSeconds, timeoutDuration);
 }
 
 void updatePollInterval(int newIntervalSeconds) {
-    pollInterval = newIntervalSeconds * 1000;
+    if (newIntervalSeconds < kMinPollIntervalSeconds || newIntervalSeconds > kMaxPollIntervalSeconds) {
+        Serial.printf("❌ Poll interval %d s out of range, keeping %lu ms\n", newIntervalSeconds, pollInterval);
+        return;
+    }
+    unsigned long newInterval = newIntervalSeconds * 1000UL;
+    bool changed = (newInterval != pollInterval);
+    pollInterval = newInterval;
+    bumpStatusVersion(STATUS_POLLING);
     
+    unsigned long now = millis();
     if (currentState == STATE_WAITING) {
-        lastActionTime = millis();
+        lastActionTime = now;
+    }
+    if (changed) {
+        scheduleFirstTick(now);
     }
     
     Serial.printf("🔄 Poll interval updated to: %d seconds (%lu ms)\n", newIntervalSeconds, pollInterval);
 }
 
+void updatePollSchedule(PollMode mode, bool alignToClock) {
+    if (mode == pollSchedule.mode && alignToClock == pollSchedule.alignToClock) return;
+    
+    pollSchedule.mode = mode;
+    pollSchedule.alignToClock = alignToClock;
+    bumpStatusVersion(STATUS_POLLING);
+    scheduleFirstTick(millis());
+    
+    Serial.printf("🔄 Poll schedule: %s%s\n", getPollModeName(mode), alignToClock ? " (clock aligned)" : "");
+}
+
+const char* getPollModeName(PollMode mode) {
+    return (mode == POLL_FIXED_RATE) ? "fixed_rate" : "fixed_delay";
+}
+
+PollMode parsePollMode(const char* name) {
+    return (name != nullptr && strcmp(name, "fixed_rate") == 0) ? POLL_FIXED_RATE : POLL_FIXED_DELAY;
+}
+
 // ==================== STATISTICS MANAGEMENT ====================
 
+void fillStatisticJson(JsonObject statObj, const SlaveStatistics& stat) {
+    statObj["slaveId"] = stat.slaveId;
+    statObj["slaveName"] = stat.slaveName;
+    statObj["totalQueries"] = stat.totalQueries;
+    statObj["success"] = stat.successCount;
+    statObj["timeout"] = stat.timeoutCount;
+    statObj["failed"] = stat.failedCount;
+    statObj["statusHistory"] = stat.statusHistory;
+}
+
+void fillStatisticsArray(JsonArray statsArray) {
+    for (int i = 0; i < slaveStatsCount; i++) {
+        fillStatisticJson(statsArray.add<JsonObject>(), slaveStats[i]);
+    }
+}
+
+void emitStatisticEvent(const SlaveStatistics& stat) {
+    if (!hasEventClients()) return;
+    
+    JsonDocument doc;
+    fillStatisticJson(doc.to<JsonObject>(), stat);
+    
+    char event[192];
+    serializeJson(doc, event, sizeof(event));
+    emitEvent("stats", event);
+}
+
 void updateSlaveStatistic(uint8_t slaveId, const char* slaveName, bool success, bool timeout) {
     if (slaveId == 0 || slaveName == nullptr) return;
+    bumpStatusVersion(STATUS_STATS);
     
     for (int i = 0; i < slaveStatsCount; i++) {
         if (slaveStats[i].slaveId == slaveId && strcmp(slaveStats[i].slaveName, slaveName) == 0) {
@@ -592,6 +982,7 @@ void updateSlaveStatistic(uint8_t slaveId, const char* slaveName, bool success,
             else if (timeout) slaveStats[i].statusHistory[0] = 'T';
             else slaveStats[i].statusHistory[0] = 'F';
             
+            emitStatisticEvent(slaveStats[i]);
             return;
         }
     }
@@ -608,27 +999,22 @@ void updateSlaveStatistic(uint8_t slaveId, const char* slaveName, bool success,
         
         strcpy(newStat->statusHistory, "   ");
         slaveStatsCount++;
+        
+        emitStatisticEvent(*newStat);
     }
 }
 
-String getStatisticsJson() {
-    JsonDocument doc;
-    JsonArray statsArray = doc.to<JsonArray>();
+// One slave's statistics appended to out - used to stream /getstatistics record by record
+bool appendStatisticRecord(size_t index, String& out) {
+    if (index >= slaveStatsCount) return false;
     
-    for (int i = 0; i < slaveStatsCount; i++) {
-        JsonObject statObj = statsArray.add<JsonObject>();
-        statObj["slaveId"] = slaveStats[i].slaveId;
-        statObj["slaveName"] = slaveStats[i].slaveName;
-        statObj["totalQueries"] = slaveStats[i].totalQueries;
-        statObj["success"] = slaveStats[i].successCount;
-        statObj["timeout"] = slaveStats[i].timeoutCount;
-        statObj["failed"] = slaveStats[i].failedCount;
-        statObj["statusHistory"] = slaveStats[i].statusHistory;
-    }
+    JsonDocument doc;
+    fillStatisticJson(doc.to<JsonObject>(), slaveStats[index]);
     
-    String output;
-    serializeJson(doc, output);
-    return output;
+    char record[192];
+    serializeJson(doc, record, sizeof(record));
+    out += record;
+    return true;
 }
 
 void removeSlaveStatistic(uint8_t slaveId, const char* slaveName) {
@@ -640,6 +1026,7 @@ void removeSlaveStatistic(uint8_t slaveId, const char* slaveName) {
                 slaveStats[j] = slaveStats[j + 1];
             }
             slaveStatsCount--;
+            bumpStatusVersion(STATUS_STATS);
             Serial.printf("📊 Removed statistics for slave %d: %s\n", slaveId, slaveName);
             return;
         }
@@ -648,18 +1035,6 @@ void removeSlaveStatistic(uint8_t slaveId, const char* slaveName) {
 
 // ==================== UTILITY FUNCTIONS ====================
 
-uint32_t readUint32FromRegisters(uint16_t highWord, uint16_t lowWord) {
-    return ((uint32_t)highWord << 16) | lowWord;
-}
-
-float readEnergyValue(uint16_t registerIndex, float divider) {
-    uint16_t highWord = node.getResponseBuffer(registerIndex);
-    uint16_t lowWord = node.getResponseBuffer(registerIndex + 1);
-    
-    uint32_t value = readUint32FromRegisters(highWord, lowWord);
-    return (value / 100.0f) / divider;
-}
-
 void addBatchSeparatorMessage() {
     if (!debugEnabled) return;
     
@@ -680,44 +1055,3 @@ void readAllRegistersIntoArray(uint16_t* registerArray, uint16_t numRegisters) {
         registerArray[i] = node.getResponseBuffer(i);
     }
 }
-
-uint64_t combineRegisters(uint16_t* registers, RegisterSize size, uint16_t startIndex) {
-    uint64_t result = 0;
-    
-    for (int i = 0; i < size; i++) {
-        result = (result << 16) | registers[startIndex + i];
-    }
-    
-    return result;
-}
-
-uint64_t* combineRegistersBySize(uint16_t* rawRegisters, uint16_t numRawRegisters, RegisterSize regSize, uint16_t& combinedCount) {
-    combinedCount = numRawRegisters / regSize;
-    uint64_t* combinedArray = new uint64_t[combinedCount];
-    
-    for (int i = 0; i < combinedCount; i++) {
-        uint16_t startIndex = i * regSize;
-        combinedArray[i] = combineRegisters(rawRegisters, regSize, startIndex);
-    }
-    
-    return combinedArray;
-}
-
-int64_t convertToSigned(uint64_t value, RegisterSize regSize) {
-    switch(regSize) {
-        case SIZE_16BIT:
-            return (int16_t)(value & 0xFFFF);
-        case SIZE_32BIT:
-            return (int32_t)(value & 0xFFFFFFFF);
-        case SIZE_48BIT:
-            if (value & 0x800000000000) {
-                return (int64_t)(value | 0xFFFF000000000000);
-            } else {
-                return value;
-            }
-        case SIZE_64BIT:
-            return (int64_t)value;
-        default:
-            return (int64_t)value;
-    }
-}
\ No newline at end of file
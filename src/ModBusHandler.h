@@ -4,26 +4,36 @@
 #include <ArduinoJson.h>
 #include <ModbusMaster.h>
 
+#include "RegisterMap.h"
 #include "FSHandler.h"
 #include "MQTTHandler.h"
 #include "WebServer.h"
 #include "TemplateManager.h"
-
-/********************************TO ADD NEW DEVICE**********************************************/
-struct DeviceTypes {
-    static constexpr const char* G01S = "G01S";
-    static constexpr const char* HeylaParam = "HeylaParam";
-    static constexpr const char* HeylaVoltage = "HeylaVoltage";
-    static constexpr const char* HeylaEnergy = "HeylaEnergy";
-};
+#include "SparkplugHandler.h"
 
 // ==================== CONSTANTS ====================
 constexpr uint8_t kMaxStatisticsSlaves = 12;
 constexpr uint8_t kRs485DePin = 5;
 constexpr unsigned long kDefaultQueryInterval = 200; // ms
 constexpr unsigned long kDefaultPollInterval = 10000;    // 10 seconds
+constexpr int kMinPollIntervalSeconds = 1;              // Fixed-rate scheduling divides by the interval
+constexpr int kMaxPollIntervalSeconds = 86400;
 constexpr unsigned long kDefaultTimeout = 1000;          // 1 second
+constexpr int kMinTimeoutSeconds = 1;
+constexpr int kMaxTimeoutSeconds = 60;
 constexpr unsigned long kQueryInterval = 200;            // 0.2 seconds between slaves
+constexpr uint8_t kMetadataPerLoop = 2;                 // Retained /meta records queued per MQTT pass
+
+// ==================== POLL SCHEDULE ====================
+enum PollMode : uint8_t {
+    POLL_FIXED_DELAY,       // Next cycle pollInterval after the previous one finished
+    POLL_FIXED_RATE         // Cycles start on absolute ticks pollInterval apart
+};
+
+struct PollSchedule {
+    PollMode mode;
+    bool alignToClock;      // Fixed rate: ticks fall on wall-clock multiples of pollInterval
+};
 
 // ==================== REGISTER SIZE ENUM ====================
 enum RegisterSize {
@@ -33,53 +43,6 @@ enum RegisterSize {
     SIZE_64BIT = 4   // Four 16-bit registers = 64-bit value
 };
 
-// ==================== DEVICE TYPE ENUM ====================
-enum DeviceType {
-    DEVICE_G01S = 0,
-    DEVICE_HEYLA_PARAM = 1,
-    DEVICE_HEYLA_VOLTAGE = 2,
-    DEVICE_HEYLA_ENERGY9 = 3,
-    DEVICE_HEYLA_ENERGY27 = 4
-};
-
-// ==================== PARAMETER STRUCTURES ====================
-
-struct MeterParameter {
-    float divider;  
-};
-
-struct VoltageParameter {
-    float divider;  
-};
-
-struct EnergyParameter {
-    float divider;
-};
-
-// ==================== DEVICE-SPECIFIC CONFIGS ====================
-
-struct SensorConfig {
-    float tempDivider;
-    float humidDivider;
-};
-
-struct MeterConfig {
-    MeterParameter Current, zeroPhaseCurrent;
-    MeterParameter ActivePower, totalActivePower;
-    MeterParameter ReactivePower, totalReactivePower;
-    MeterParameter ApparentPower, totalApparentPower;
-    MeterParameter PowerFactor, totalPowerFactor;
-};
-
-struct VoltageConfig {
-    VoltageParameter Voltage, phaseVoltageMean, zeroSequenceVoltage;
-};
-
-struct EnergyConfig {
-    EnergyParameter totalActiveEnergy, importActiveEnergy, exportActiveEnergy, totalReactiveEnergy, 
-                    importReactiveEnergy, exportReactiveEnergy;
-};
-
 // ==================== MAIN SLAVE STRUCTURE ====================
 // Add these fields to the SensorSlave struct:
 struct SensorSlave {
@@ -93,17 +56,37 @@ struct SensorSlave {
     float ct;       
     float pt; 
     
-    DeviceType deviceType;
-    
     RegisterSize registerSize;
     
-    // Union - only ONE of these is active at a time
-    union {
-        SensorConfig sensor;
-        MeterConfig meter;
-        VoltageConfig voltage;
-        EnergyConfig energy;
-    } config;
+    // Shared and immutable: slaves resolving to the same map or parameters point at one copy
+    const DecodeProgram* program = &kEmptyDecodeProgram;
+    const DeviceParams* config = &kDefaultDeviceParams;
+    
+    JsonObjectConst source;     // Resident slaves.json entry built from; null = compare by building
+};
+
+// ==================== REMOTE BUS COMMANDS ====================
+constexpr uint8_t kMaxWriteRegisters = 16;
+
+enum BusCommandType {
+    BUS_CMD_NONE = 0,
+    BUS_CMD_READ,
+    BUS_CMD_WRITE,
+    BUS_CMD_PATCH
+};
+
+/**
+ * @brief Remote command that needs the bus or the slave table. Held until the
+ *        state machine is between transactions; slaves are resolved by id+name then.
+ */
+struct BusCommand {
+    BusCommandType type;
+    uint8_t slaveId;
+    char slaveName[32];
+    uint16_t startRegister;
+    uint16_t values[kMaxWriteRegisters];
+    uint8_t valueCount;
+    char correlationId[40];
 };
 
 struct SlaveStatistics {
@@ -119,54 +102,48 @@ struct SlaveStatistics {
 // ==================== MODBUS INITIALIZATION ====================
 bool initModbus();
 bool modbusReloadSlaves();
+void installBootSlaves(SensorSlave* table, int count);
+uint16_t countDecodedChannels();
+bool sameSlaveDefinition(const SensorSlave& a, const SensorSlave& b);
+void remapSchedule(const int* sourceIndex, const int* newIndexOfOld, int newSlaveCount);
+
+bool buildSlaveFromConfig(SensorSlave& slave, JsonObject slaveObj);
+int findSlaveIndex(uint8_t slaveId, const char* slaveName);
+bool applySlavePatch(int slaveIndex, JsonObject patch, String& error);
+bool commitSlaveConfig(int slaveIndex, JsonObject slaveObj, String& error);
+bool isSlaveInTransaction(int slaveIndex);
+
+// ==================== REMOTE COMMAND EXECUTION ====================
+bool queueBusCommand(const BusCommand& command, JsonObject patch = JsonObject());
+bool hasPendingBusCommand();
+void serviceBusCommand();
 
 // ==================== QUERY MANAGEMENT ====================
 void updateNonBlockingQuery();
+unsigned long getModbusDueIn(unsigned long now);
 void updatePollInterval(int intervalSeconds);
+void updatePollSchedule(PollMode mode, bool alignToClock);
+const char* getPollModeName(PollMode mode);
+PollMode parsePollMode(const char* name);
+uint64_t getSampleTimestamp();
 void updateTimeout(int timeoutSeconds);
 
-// ==================== DATA PROCESSING ====================
-float convertRegisterToTemperature(uint16_t registerValue, float divider = 1.0f);
-float convertRegisterToHumidity(uint16_t registerValue, float divider = 1.0f);
-float readEnergyValue(uint64_t rawValue, float divider);
-
 // ==================== STATISTICS MANAGEMENT ====================
 void updateSlaveStatistic(uint8_t slaveId, const char* slaveName, bool success, bool timeout);
-String getStatisticsJson();
+bool appendStatisticRecord(size_t index, String& out);
+void fillStatisticsArray(JsonArray statsArray);
 void removeSlaveStatistic(uint8_t slaveId, const char* slaveName);
 
-// ==================== UTILITY FUNCTIONS ====================
-uint32_t readUint32FromRegisters(uint16_t highWord, uint16_t lowWord);
-
-// ==================== CONFIGURATION HELPERS ====================
-DeviceType determineDeviceTypeFromString(const String& deviceTypeStr);
-void loadDeviceParameters(SensorSlave& slave, JsonObject slaveObj);
-void loadG01SParameters(SensorConfig& sensorConfig, JsonObject paramsObj);
-void loadMeterParameters(MeterConfig& meterConfig, JsonObject paramsObj);
-void loadVoltageParameters(VoltageConfig& voltageConfig, JsonObject paramsObj);
-void loadEnergyParameters9(EnergyConfig& energyConfig, JsonObject paramsObj);
-void loadEnergyParameters27(EnergyConfig& energyConfig, JsonObject paramsObj);
-
 // ==================== REGISTER PROCESSING FUNCTIONS ====================
 void readAllRegistersIntoArray(uint16_t* registerArray, uint16_t numRegisters);
-uint64_t combineRegisters(uint16_t* registers, RegisterSize size, uint16_t startIndex);
-uint64_t* combineRegistersBySize(uint16_t* rawRegisters, uint16_t numRawRegisters, RegisterSize regSize, uint16_t& combinedCount);
-int64_t convertToSigned(uint64_t value, RegisterSize regSize);
 
 // ==================== DATA PROCESSING HELPERS ====================
-void processSensorData(JsonObject& root, const SensorConfig& sensorConfig, uint64_t* combinedValues, RegisterSize regSize);
-void processMeterData(JsonObject& root, const MeterConfig& meterConfig, uint64_t* combinedValues, RegisterSize regSize, float ct, float pt);
-void processVoltageData(JsonObject& root, const VoltageConfig& voltageConfig, uint64_t* combinedValues, RegisterSize regSize, float pt);
-void processEnergyData9(JsonObject& root, const EnergyConfig& energyConfig, uint64_t* combinedValues, RegisterSize regSize);
-void processEnergyData27(JsonObject& root, const EnergyConfig& energyConfig, uint64_t* combinedValues, RegisterSize regSize);
-void publishData(const SensorSlave& slave, const JsonDocument& doc);
-
-// ==================== CALCULATION FUNCTIONS ====================
-float calculateCurrent(uint64_t registerValue, float divider);
-float calculateSinglePhasePower(int64_t registerValue, float divider, float ct, float pt);
-float calculateThreePhasePower(int64_t registerValue, float divider, float ct, float pt);
-float calculatePowerFactor(int64_t registerValue, float divider);
-float calculateVoltage(uint64_t registerValue, float divider, float pt);
+void decodeSlaveData(const SensorSlave& slave, JsonObject& root);
+void publishData(const SensorSlave& slave, const JsonDocument& doc, uint32_t sampledAt = 0,
+                 uint64_t sampleTimestamp = 0);
+void requestSlaveMetadata();
+void publishSlaveMetadata();
+void clearRemovedSlaveMetadata(JsonArray newSlaves);
 
 // ==================== ERROR HANDLING ====================
 void handleQueryStartFailure();
@@ -178,5 +155,9 @@ void publishSlaveError(uint8_t slaveId, const char* slaveName, const char* error
 void addBatchSeparatorMessage();
 
 // ==================== EXTERNAL VARIABLES ====================
+extern SensorSlave* slaves;
 extern int slaveCount;
+extern bool slaveMetadataPending;
+extern unsigned long pollInterval;
+extern PollSchedule pollSchedule;
 extern unsigned long timeoutDuration;
\ No newline at end of file
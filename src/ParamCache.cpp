@@ -0,0 +1,239 @@
+#include "ParamCache.h"
+
+// ==================== GLOBAL VARIABLES ====================
+
+ParamSet* paramSets = nullptr;
+int paramSetCount = 0;
+DecodeProgram* decodePrograms = nullptr;
+int decodeProgramCount = 0;
+
+// ==================== LOOKUP ====================
+
+ParamSet* findParamSetByContent(const DeviceParams& params) {
+    for (ParamSet* set = paramSets; set != nullptr; set = set->next) {
+        if (memcmp(&set->params, &params, sizeof(DeviceParams)) == 0) return set;
+    }
+    return nullptr;
+}
+
+ParamSet* addParamSet(const DeviceParams& params) {
+    ParamSet* set = new ParamSet();
+    set->params = params;
+    set->next = paramSets;
+    paramSets = set;
+    paramSetCount++;
+    return set;
+}
+
+// ==================== KEYS ====================
+
+uint32_t hashParamPatches(const ParamPatch* patches, uint8_t patchCount) {
+    uint32_t hash = 2166136261u;
+    for (uint8_t i = 0; i < patchCount; i++) {
+        uint32_t bits;
+        memcpy(&bits, &patches[i].value, sizeof(bits));
+        hash = (hash ^ patches[i].slot) * 16777619u;
+        for (uint8_t shift = 0; shift < 32; shift += 8) {
+            hash = (hash ^ ((bits >> shift) & 0xFF)) * 16777619u;
+        }
+    }
+    return hash;
+}
+
+bool keyMatches(const ParamKey& key, const CompiledTemplate& tmpl, uint32_t patchHash, const ParamPatch* patches,
+                uint8_t patchCount) {
+    if (key.tmpl != &tmpl || key.patchHash != patchHash || key.patchCount != patchCount) return false;
+    for (uint8_t i = 0; i < patchCount; i++) {
+        // Field by field: the struct has padding
+        if (key.patches[i].slot != patches[i].slot || key.patches[i].value != patches[i].value) return false;
+    }
+    return true;
+}
+
+void addParamKey(ParamSet& set, const CompiledTemplate& tmpl, uint32_t patchHash, const ParamPatch* patches,
+                 uint8_t patchCount) {
+    ParamKey* key = new ParamKey();
+    key->tmpl = &tmpl;
+    key->patchHash = patchHash;
+    key->patchCount = patchCount;
+    key->patches = patchCount ? new ParamPatch[patchCount] : nullptr;
+    for (uint8_t i = 0; i < patchCount; i++) {
+        key->patches[i] = patches[i];
+    }
+    key->next = set.keys;
+    set.keys = key;
+}
+
+void freeParamKeys(ParamSet& set) {
+    while (set.keys != nullptr) {
+        ParamKey* key = set.keys;
+        set.keys = key->next;
+        delete[] key->patches;
+        delete key;
+    }
+}
+
+/**
+ * @brief Parameters for one slave. A key hit skips applying the patches; otherwise
+ *        the result is deduplicated by content so the memory is still shared, and
+ *        the pair is recorded as another key of that set.
+ */
+const DeviceParams* resolveDeviceParams(const CompiledTemplate& tmpl, JsonObjectConst overrideObj) {
+    ParamPatch patches[kMaxParamSlots];
+    uint8_t patchCount = compileOverridePatches(tmpl, overrideObj, patches);
+    uint32_t patchHash = hashParamPatches(patches, patchCount);
+    
+    for (ParamSet* set = paramSets; set != nullptr; set = set->next) {
+        for (const ParamKey* key = set->keys; key != nullptr; key = key->next) {
+            if (keyMatches(*key, tmpl, patchHash, patches, patchCount)) return &set->params;
+        }
+    }
+    
+    DeviceParams resolved;
+    applyParamPatches(tmpl, patches, patchCount, &resolved, sizeof(resolved));
+    
+    ParamSet* set = findParamSetByContent(resolved);
+    if (set == nullptr) {
+        set = addParamSet(resolved);
+    }
+    addParamKey(*set, tmpl, patchHash, patches, patchCount);
+    return &set->params;
+}
+
+const DeviceParams* internDeviceParams(const DeviceParams& params) {
+    ParamSet* set = findParamSetByContent(params);
+    return &(set != nullptr ? set : addParamSet(params))->params;
+}
+
+// ==================== DECODE PROGRAMS ====================
+
+/**
+ * @brief Takes ownership of ops and names (new[]); they are freed again when an
+ *        identical program is already resident
+ */
+DecodeProgram* adoptDecodeProgram(DecodeOp* ops, uint8_t opCount, char* names, uint16_t namesLength) {
+    for (DecodeProgram* program = decodePrograms; program != nullptr; program = program->next) {
+        if (program->opCount == opCount && program->namesLength == namesLength &&
+            memcmp(program->ops, ops, opCount * sizeof(DecodeOp)) == 0 &&
+            memcmp(program->names, names, namesLength) == 0) {
+            delete[] ops;
+            delete[] names;
+            return program;
+        }
+    }
+    
+    DecodeProgram* program = new DecodeProgram();
+    program->ops = ops;
+    program->opCount = opCount;
+    program->names = names;
+    program->namesLength = namesLength;
+    program->next = decodePrograms;
+    decodePrograms = program;
+    decodeProgramCount++;
+    return program;
+}
+
+/**
+ * @brief Decode program for a slave: the template's register map with offsets and
+ *        widths fixed for the slave's register size. Built once per pair.
+ */
+const DecodeProgram* resolveDecodeProgram(const CompiledTemplate& tmpl, uint8_t registerSize) {
+    if (tmpl.fieldCount == 0) return &kEmptyDecodeProgram;
+    
+    for (DecodeProgram* program = decodePrograms; program != nullptr; program = program->next) {
+        if (program->tmpl == &tmpl && program->registerSize == registerSize) return program;
+    }
+    
+    const RegisterField* fields = getRegisterFields(tmpl);
+    uint16_t namesLength = measureDecodeNames(fields, tmpl.fieldCount);
+    DecodeOp* ops = new DecodeOp[tmpl.fieldCount];
+    char* names = new char[namesLength];
+    buildDecodeOps(fields, tmpl.fieldCount, registerSize, ops, names);
+    for (uint8_t i = 0; i < tmpl.fieldCount; i++) {
+        if (ops[i].registerOffset + ops[i].words > kMaxResponseRegisters) {
+            Serial.printf("⚠️ %s: %s is past register %u at register size %u\n",
+                          tmpl.deviceType, names + ops[i].nameOffset, kMaxResponseRegisters, registerSize);
+        }
+    }
+    
+    DecodeProgram* program = adoptDecodeProgram(ops, tmpl.fieldCount, names, namesLength);
+    if (program->tmpl == nullptr) {
+        program->tmpl = &tmpl;
+        program->registerSize = registerSize;
+    }
+    return program;
+}
+
+const DecodeProgram* internDecodeProgram(DecodeOp* ops, uint8_t opCount, char* names, uint16_t namesLength) {
+    if (opCount == 0) {
+        delete[] ops;
+        delete[] names;
+        return &kEmptyDecodeProgram;
+    }
+    return adoptDecodeProgram(ops, opCount, names, namesLength);
+}
+
+// ==================== RELEASE ====================
+
+/**
+ * @brief Free sets and programs no slave points at any more. Run after the slave
+ *        table changes; nothing is freed while a table under construction uses it.
+ */
+void releaseUnusedParams() {
+    ParamSet** link = &paramSets;
+    while (*link != nullptr) {
+        ParamSet* set = *link;
+        bool used = false;
+        for (int i = 0; i < slaveCount && !used; i++) {
+            used = (slaves[i].config == &set->params);
+        }
+        
+        if (used) {
+            link = &set->next;
+        } else {
+            *link = set->next;
+            freeParamKeys(*set);
+            delete set;
+            paramSetCount--;
+        }
+    }
+    
+    DecodeProgram** programLink = &decodePrograms;
+    while (*programLink != nullptr) {
+        DecodeProgram* program = *programLink;
+        bool used = false;
+        for (int i = 0; i < slaveCount && !used; i++) {
+            used = (slaves[i].program == program);
+        }
+        
+        if (used) {
+            programLink = &program->next;
+        } else {
+            *programLink = program->next;
+            delete[] program->ops;
+            delete[] program->names;
+            delete program;
+            decodeProgramCount--;
+        }
+    }
+}
+
+/**
+ * @brief Compiled templates are about to be freed; their addresses may be reused
+ */
+void forgetParamKeys() {
+    for (ParamSet* set = paramSets; set != nullptr; set = set->next) {
+        freeParamKeys(*set);
+    }
+    for (DecodeProgram* program = decodePrograms; program != nullptr; program = program->next) {
+        program->tmpl = nullptr;
+    }
+}
+
+int getParamSetCount() {
+    return paramSetCount;
+}
+
+int getDecodeProgramCount() {
+    return decodeProgramCount;
+}
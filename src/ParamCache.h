@@ -0,0 +1,42 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "ModBusHandler.h"
+
+// ==================== INTERNED PARAMETER SETS ====================
+// Decode programs are interned the same way, keyed by (template, register size).
+
+/**
+ * @brief A (template, override patches) pair known to resolve to its set. The
+ *        patches are kept so a hash match is confirmed before the set is reused.
+ */
+struct ParamKey {
+    ParamKey* next;
+    const CompiledTemplate* tmpl;
+    uint32_t patchHash;
+    uint8_t patchCount;
+    ParamPatch* patches;
+};
+
+/**
+ * @brief One resolved parameter block shared by every slave that resolves to it.
+ *        Keyed by every (template, patches) pair seen resolving to it, so a repeat
+ *        skips applying the patches. Sets loaded from the config blob have no key
+ *        until a reload resolves to the same bytes.
+ */
+struct ParamSet {
+    ParamSet* next;
+    ParamKey* keys;                   // nullptr = not keyed
+    DeviceParams params;
+};
+
+// ==================== PARAM CACHE API ====================
+const DeviceParams* resolveDeviceParams(const CompiledTemplate& tmpl, JsonObjectConst overrideObj);
+const DeviceParams* internDeviceParams(const DeviceParams& params);
+const DecodeProgram* resolveDecodeProgram(const CompiledTemplate& tmpl, uint8_t registerSize);
+const DecodeProgram* internDecodeProgram(DecodeOp* ops, uint8_t opCount, char* names, uint16_t namesLength);
+void releaseUnusedParams();
+void forgetParamKeys();
+int getParamSetCount();
+int getDecodeProgramCount();
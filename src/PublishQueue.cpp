@@ -0,0 +1,222 @@
+#include "PublishQueue.h"
+
+// ==================== RECORD LAYOUT ====================
+// Messages are stored pre-encoded as [header][topic\0][payload] in a byte ring.
+// Records never straddle the end of the arena: when the tail runs out of room
+// the ring wraps early and wrapEnd marks where the first lap stops.
+
+struct QueuedRecord {
+    uint16_t size;              // Whole record incl. header, 4-byte aligned
+    uint16_t topicLength;       // Including terminator
+    uint16_t payloadLength;
+    uint8_t flags;
+    uint8_t reserved;
+    uint32_t enqueuedAt;
+    uint32_t sampledAt;         // millis() when the reading was acquired, 0 = not a reading
+};
+
+constexpr uint8_t kRecordRetained = 0x01;
+constexpr uint8_t kRecordCoalescable = 0x02;
+constexpr uint8_t kRecordSuperseded = 0x04;
+constexpr size_t kMqttHeaderOverhead = 7;   // Fixed header (max 5) + topic length field
+
+// ==================== GLOBAL VARIABLES ====================
+
+alignas(4) uint8_t publishArena[kPublishQueueBytes];
+size_t queueHead = 0;
+size_t queueTail = 0;
+size_t queueWrapEnd = 0;        // 0 = not wrapped
+uint16_t queueCount = 0;        // Records in the arena, including superseded ones
+PublishQueueStats queueStats = {};
+
+// ==================== RING HELPERS ====================
+
+QueuedRecord* recordAt(size_t offset) {
+    return reinterpret_cast<QueuedRecord*>(publishArena + offset);
+}
+
+size_t advanceOffset(size_t offset) {
+    offset += recordAt(offset)->size;
+    if (queueWrapEnd != 0 && offset >= queueWrapEnd) {
+        offset = 0;
+    }
+    return offset;
+}
+
+bool queueHasRoom(size_t size) {
+    if (queueCount == 0) {
+        queueHead = queueTail = queueWrapEnd = 0;
+        return size <= kPublishQueueBytes;
+    }
+    if (queueWrapEnd == 0) {
+        return (kPublishQueueBytes - queueTail >= size) || (queueHead >= size);
+    }
+    return (queueHead - queueTail) >= size;
+}
+
+void popQueueHead() {
+    QueuedRecord* record = recordAt(queueHead);
+    queueStats.bytesUsed -= record->size;
+    if (!(record->flags & kRecordSuperseded)) {
+        queueStats.depth--;
+    }
+
+    queueHead = advanceOffset(queueHead);
+    if (queueHead == 0) {
+        queueWrapEnd = 0;
+    }
+
+    if (--queueCount == 0) {
+        queueHead = queueTail = queueWrapEnd = 0;
+    }
+}
+
+void supersedeTopic(const char* topic) {
+    size_t offset = queueHead;
+    for (uint16_t i = 0; i < queueCount; i++) {
+        QueuedRecord* record = recordAt(offset);
+        const char* queuedTopic = reinterpret_cast<const char*>(record + 1);
+
+        if ((record->flags & kRecordCoalescable) && !(record->flags & kRecordSuperseded) &&
+            strcmp(queuedTopic, topic) == 0) {
+            record->flags |= kRecordSuperseded;
+            queueStats.depth--;
+            queueStats.coalesced++;
+        }
+        offset = advanceOffset(offset);
+    }
+}
+
+// ==================== QUEUE OPERATIONS ====================
+
+bool enqueuePublish(const char* topic, const uint8_t* payload, size_t length, bool retained, bool coalescable,
+                    uint32_t sampledAt) {
+    size_t topicLength = strlen(topic) + 1;
+    size_t recordSize = (sizeof(QueuedRecord) + topicLength + length + 3) & ~(size_t)3;
+
+    if (recordSize > kPublishQueueBytes || kMqttHeaderOverhead + topicLength + length > kMqttBufferSize) {
+        Serial.printf("❌ Message for %s too large to queue (%d bytes)\n", topic, length);
+        queueStats.dropped++;
+        return false;
+    }
+
+    if (coalescable && mqttConfig.queuePolicy == QUEUE_COALESCE_TOPIC) {
+        supersedeTopic(topic);
+    }
+
+    while (!queueHasRoom(recordSize)) {
+        if (!(recordAt(queueHead)->flags & kRecordSuperseded)) {
+            queueStats.dropped++;
+        }
+        popQueueHead();
+    }
+
+    if (queueWrapEnd == 0 && kPublishQueueBytes - queueTail < recordSize) {
+        queueWrapEnd = queueTail;
+        queueTail = 0;
+    }
+
+    QueuedRecord* record = recordAt(queueTail);
+    record->size = recordSize;
+    record->topicLength = topicLength;
+    record->payloadLength = length;
+    record->flags = (retained ? kRecordRetained : 0) | (coalescable ? kRecordCoalescable : 0);
+    record->enqueuedAt = millis();
+    record->sampledAt = sampledAt;
+
+    uint8_t* data = reinterpret_cast<uint8_t*>(record + 1);
+    memcpy(data, topic, topicLength);
+    memcpy(data + topicLength, payload, length);
+
+    queueTail += recordSize;
+    queueCount++;
+
+    queueStats.enqueued++;
+    queueStats.depth++;
+    queueStats.bytesUsed += recordSize;
+    if (queueStats.bytesUsed > queueStats.highWaterBytes) {
+        queueStats.highWaterBytes = queueStats.bytesUsed;
+    }
+    return true;
+}
+
+void drainPublishQueue() {
+    uint8_t sent = 0;
+
+    while (queueCount > 0 && sent < kMaxDrainPerLoop) {
+        QueuedRecord* record = recordAt(queueHead);
+
+        if (record->flags & kRecordSuperseded) {
+            popQueueHead();
+            continue;
+        }
+
+        if (!mqttClient.connected()) return;
+
+        // Only hand over what the TCP send buffer can take without blocking
+        size_t packetSize = kMqttHeaderOverhead + record->topicLength - 1 + record->payloadLength;
+        if (espClient.availableForWrite() < packetSize) return;
+
+        const char* topic = reinterpret_cast<const char*>(record + 1);
+        const uint8_t* payload = reinterpret_cast<const uint8_t*>(topic + record->topicLength);
+
+        if (!mqttClient.publish(topic, payload, record->payloadLength, record->flags & kRecordRetained)) {
+            return;   // Leave it at the head and retry on the next loop
+        }
+
+        uint32_t latency = millis() - record->enqueuedAt;
+        queueStats.published++;
+        queueStats.lastLatencyMs = latency;
+        queueStats.totalLatencyMs += latency;
+        if (latency > queueStats.maxLatencyMs) {
+            queueStats.maxLatencyMs = latency;
+        }
+        
+        if (record->sampledAt != 0) {
+            // Bus read, decode and queueing together - what the timestamp in the payload hides
+            uint32_t sampleAge = millis() - record->sampledAt;
+            queueStats.samplesPublished++;
+            queueStats.lastSampleAgeMs = sampleAge;
+            queueStats.totalSampleAgeMs += sampleAge;
+            if (sampleAge > queueStats.maxSampleAgeMs) {
+                queueStats.maxSampleAgeMs = sampleAge;
+            }
+        }
+
+        Serial.printf("📤 MQTT Published → %s (%d bytes, queued %lums)\n", topic, record->payloadLength, latency);
+        popQueueHead();
+        sent++;
+    }
+}
+
+void clearPublishQueue() {
+    queueStats.dropped += queueStats.depth;
+    queueStats.depth = 0;
+    queueStats.bytesUsed = 0;
+    queueHead = queueTail = queueWrapEnd = 0;
+    queueCount = 0;
+}
+
+const PublishQueueStats& getPublishQueueStats() {
+    return queueStats;
+}
+
+void resetPublishQueueStats() {
+    uint16_t depth = queueStats.depth;
+    uint16_t bytesUsed = queueStats.bytesUsed;
+    queueStats = {};
+    queueStats.depth = depth;
+    queueStats.bytesUsed = bytesUsed;
+    queueStats.highWaterBytes = bytesUsed;
+}
+
+// ==================== POLICY HELPERS ====================
+
+const char* getQueuePolicyName(uint8_t policy) {
+    return (policy == QUEUE_COALESCE_TOPIC) ? "coalesce" : "drop_oldest";
+}
+
+uint8_t parseQueuePolicy(const char* name) {
+    if (name != nullptr && strcmp(name, "coalesce") == 0) return QUEUE_COALESCE_TOPIC;
+    return QUEUE_DROP_OLDEST;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <Arduino.h>
+#include "MQTTHandler.h"
+
+// ==================== PUBLISH QUEUE CONSTANTS ====================
+constexpr size_t kPublishQueueBytes = 6144;     // Fixed arena for queued messages
+constexpr uint8_t kMaxDrainPerLoop = 4;         // Messages handed to the socket per loop()
+
+// ==================== OVERFLOW POLICY ====================
+enum QueueOverflowPolicy {
+    QUEUE_DROP_OLDEST = 0,      // Evict oldest messages until the new one fits
+    QUEUE_COALESCE_TOPIC = 1    // Newer message replaces a queued one on the same topic
+};
+
+// ==================== QUEUE STATISTICS ====================
+
+struct PublishQueueStats {
+    uint32_t enqueued;
+    uint32_t published;
+    uint32_t dropped;           // Evicted on overflow or rejected as oversized
+    uint32_t coalesced;         // Superseded by a newer message on the same topic
+    uint16_t depth;             // Messages waiting
+    uint16_t bytesUsed;
+    uint16_t highWaterBytes;
+    uint32_t lastLatencyMs;     // Enqueue -> handed to socket
+    uint32_t maxLatencyMs;
+    uint32_t totalLatencyMs;
+    uint32_t samplesPublished;  // Messages carrying a reading
+    uint32_t lastSampleAgeMs;   // Reading acquired -> handed to socket
+    uint32_t maxSampleAgeMs;
+    uint32_t totalSampleAgeMs;
+};
+
+// ==================== QUEUE OPERATIONS ====================
+bool enqueuePublish(const char* topic, const uint8_t* payload, size_t length, bool retained, bool coalescable = true,
+                    uint32_t sampledAt = 0);
+void drainPublishQueue();
+void clearPublishQueue();
+const PublishQueueStats& getPublishQueueStats();
+void resetPublishQueueStats();
+const char* getQueuePolicyName(uint8_t policy);
+uint8_t parseQueuePolicy(const char* name);
@@ -0,0 +1,244 @@
+#include "RegisterMap.h"
+
+// ==================== GLOBAL VARIABLES ====================
+
+const DeviceParams kDefaultDeviceParams = {};
+const DecodeProgram kEmptyDecodeProgram = {};
+
+// ==================== BUILT-IN REGISTER MAPS ====================
+// Maps for the factory templates. They seed templates.json and decode templates
+// saved before templates carried their own "registers".
+
+#define FIELD(name, group, param, index, flags, scale) \
+    { name, { group, param, "divider" }, index, 0, flags, scale, 0.0f, 0 }
+#define POWER_FLAGS (DECODE_SIGNED | DECODE_CT | DECODE_PT)
+
+const RegisterField kG01SMap[] = {
+    { "temperature_(C)", { "sensor", "tempdivider", nullptr }, 0, 0, DECODE_SIGNED, 0.1f, 0.0f, 0 },
+    { "temperature_(F)", { "sensor", "tempdivider", nullptr }, 0, 0, DECODE_SIGNED, 0.18f, 32.0f, 0 },
+    { "humidity", { "sensor", "humiddivider", nullptr }, 1, 0, 0, 0.1f, 0.0f, 0 }
+};
+
+const RegisterField kHeylaParamMap[] = {
+    FIELD("A_Current_(A)", "meter", "Current", 0, DECODE_CT, 0.0001f),
+    FIELD("B_Current_(A)", "meter", "Current", 1, DECODE_CT, 0.0001f),
+    FIELD("C_Current_(A)", "meter", "Current", 2, DECODE_CT, 0.0001f),
+    FIELD("Zero_Phase_Current_(A)", "meter", "zeroPhaseCurrent", 3, DECODE_CT, 0.0001f),
+
+    FIELD("A_Active_Power_(kW)", "meter", "ActivePower", 4, POWER_FLAGS, 0.01f),
+    FIELD("B_Active_Power_(kW)", "meter", "ActivePower", 5, POWER_FLAGS, 0.01f),
+    FIELD("C_Active_Power_(kW)", "meter", "ActivePower", 6, POWER_FLAGS, 0.01f),
+    FIELD("Total_Active_Power_(kW)", "meter", "totalActivePower", 7, POWER_FLAGS, 0.1f),
+
+    FIELD("A_Reactive_Power_(kVAr)", "meter", "ReactivePower", 8, POWER_FLAGS, 0.01f),
+    FIELD("B_Reactive_Power_(kVAr)", "meter", "ReactivePower", 9, POWER_FLAGS, 0.01f),
+    FIELD("C_Reactive_Power_(kVAr)", "meter", "ReactivePower", 10, POWER_FLAGS, 0.01f),
+    FIELD("Total_Reactive_Power_(kVAr)", "meter", "totalReactivePower", 11, POWER_FLAGS, 0.1f),
+
+    FIELD("A_Apparent_Power_(kVA)", "meter", "ApparentPower", 12, POWER_FLAGS, 0.01f),
+    FIELD("B_Apparent_Power_(kVA)", "meter", "ApparentPower", 13, POWER_FLAGS, 0.01f),
+    FIELD("C_Apparent_Power_(kVA)", "meter", "ApparentPower", 14, POWER_FLAGS, 0.01f),
+    FIELD("Total_Apparent_Power_(kVA)", "meter", "totalApparentPower", 15, POWER_FLAGS, 0.1f),
+
+    FIELD("A_Power_Factor", "meter", "PowerFactor", 16, DECODE_SIGNED, 0.001f),
+    FIELD("B_Power_Factor", "meter", "PowerFactor", 17, DECODE_SIGNED, 0.001f),
+    FIELD("C_Power_Factor", "meter", "PowerFactor", 18, DECODE_SIGNED, 0.001f),
+    FIELD("Total_Power_Factor", "meter", "totalPowerFactor", 19, DECODE_SIGNED, 0.001f)
+};
+
+const RegisterField kHeylaVoltageMap[] = {
+    FIELD("A_Voltage_(V)", "voltage", "Voltage", 0, DECODE_PT, 0.01f),
+    FIELD("B_Voltage_(V)", "voltage", "Voltage", 1, DECODE_PT, 0.01f),
+    FIELD("C_Voltage_(V)", "voltage", "Voltage", 2, DECODE_PT, 0.01f),
+    FIELD("Phase_Voltage_Mean", "voltage", "phaseVoltageMean", 3, DECODE_PT, 0.01f),
+    FIELD("Zero_Sequence_Voltage", "voltage", "zeroSequenceVoltage", 4, DECODE_PT, 0.01f)
+};
+
+const RegisterField kHeylaEnergy9Map[] = {
+    FIELD("Total_Active_Energy_(kwH)", "energy", "totalActiveEnergy", 0, 0, 0.01f),
+    FIELD("Import_Active_Energy_(kwH)", "energy", "importActiveEnergy", 1, 0, 0.01f),
+    FIELD("Export_Active_Energy_(kwH)", "energy", "exportActiveEnergy", 2, 0, 0.01f),
+    FIELD("Total_Reactive_Energy_(KVArh)", "energy", "totalReactiveEnergy", 3, 0, 0.01f),
+    FIELD("Import_Reactive_Energy_(KVArh)", "energy", "importReactiveEnergy", 4, 0, 0.01f),
+    FIELD("Export_Reactive_Energy_(KVArh)", "energy", "exportReactiveEnergy", 5, 0, 0.01f)
+};
+
+const RegisterField kHeylaEnergy27Map[] = {
+    FIELD("Total_Active_Energy_(kwH)", "energy", "totalActiveEnergy", 0, 0, 0.01f),
+    FIELD("Import_Active_Energy_(kwH)", "energy", "importActiveEnergy", 1, 0, 0.01f),
+    FIELD("Export_Active_Energy_(kwH)", "energy", "exportActiveEnergy", 2, 0, 0.01f)
+};
+
+#undef FIELD
+#undef POWER_FLAGS
+
+struct BuiltinDevice {
+    const char* deviceType;
+    const RegisterField* fields;
+    uint8_t count;
+};
+
+#define BUILTIN(name, map) { name, map, sizeof(map) / sizeof(map[0]) }
+
+const BuiltinDevice kBuiltinDevices[] = {
+    BUILTIN("G01S", kG01SMap),
+    BUILTIN("HeylaParam", kHeylaParamMap),
+    BUILTIN("HeylaVoltage", kHeylaVoltageMap),
+    BUILTIN("HeylaEnergy9", kHeylaEnergy9Map),
+    BUILTIN("HeylaEnergy27", kHeylaEnergy27Map)
+};
+
+#undef BUILTIN
+
+const RegisterField* findBuiltinRegisterMap(const char* deviceType, uint8_t& count) {
+    for (const BuiltinDevice& device : kBuiltinDevices) {
+        if (strcmp(device.deviceType, deviceType) == 0) {
+            count = device.count;
+            return device.fields;
+        }
+    }
+    count = 0;
+    return nullptr;
+}
+
+// ==================== TEMPLATE FORMAT ====================
+
+/**
+ * @brief Read one "registers" entry of a template. Strings are not copied, so the
+ *        entry must outlive the field (the template cache stays resident).
+ */
+bool parseRegisterField(JsonObjectConst entry, RegisterField& field) {
+    field = RegisterField();
+    field.name = entry["name"];
+    if (field.name == nullptr || field.name[0] == '\0') return false;
+
+    bool isFloat = strcmp(entry["type"] | "int", "float") == 0;
+    if (entry["offset"].is<int>()) {
+        int offset = entry["offset"];
+        int words = isFloat ? 2 : (entry["words"] | 1);     // Range-checked before narrowing
+        if (words < 1 || words > 4 || offset < 0 || offset + words > kMaxResponseRegisters) return false;
+        field.position = offset;
+        field.words = words;
+    } else if (entry["index"].is<int>() && !isFloat) {
+        int index = entry["index"];
+        if (index < 0 || index >= kMaxResponseRegisters) return false;
+        field.position = index;
+    } else {
+        return false;       // Floats always take an explicit offset
+    }
+    if (isFloat) field.flags |= DECODE_FLOAT;
+
+    if (entry["signed"] | false) field.flags |= DECODE_SIGNED;
+    if (strcmp(entry["wordOrder"] | "big", "little") == 0) field.flags |= DECODE_WORDS_LITTLE;
+    if (entry["ct"] | false) field.flags |= DECODE_CT;
+    if (entry["pt"] | false) field.flags |= DECODE_PT;
+    field.scale = entry["scale"] | 1.0f;
+    field.add = entry["add"] | 0.0f;
+
+    JsonArrayConst divider = entry["divider"];
+    if (!entry["divider"].isNull() && (divider.isNull() || divider.size() > kMaxParamDepth)) return false;
+    uint8_t level = 0;
+    for (JsonVariantConst key : divider) {
+        if (!key.is<const char*>()) return false;
+        field.divider[level++] = key.as<const char*>();
+    }
+    return true;
+}
+
+/**
+ * @brief Inverse of parseRegisterField; defaults are left out
+ */
+void writeRegisterField(const RegisterField& field, JsonObject output) {
+    output["name"] = field.name;
+    if (field.words == 0) {
+        output["index"] = field.position;
+    } else {
+        output["offset"] = field.position;
+        output["words"] = field.words;
+    }
+    if (field.flags & DECODE_FLOAT) output["type"] = "float";
+    if (field.flags & DECODE_SIGNED) output["signed"] = true;
+    if (field.flags & DECODE_WORDS_LITTLE) output["wordOrder"] = "little";
+    if (field.flags & DECODE_CT) output["ct"] = true;
+    if (field.flags & DECODE_PT) output["pt"] = true;
+    if (field.scale != 1.0f) output["scale"] = field.scale;
+    if (field.add != 0.0f) output["add"] = field.add;
+
+    if (field.divider[0] != nullptr) {
+        JsonArray divider = output["divider"].to<JsonArray>();
+        for (uint8_t level = 0; level < kMaxParamDepth && field.divider[level] != nullptr; level++) {
+            divider.add(field.divider[level]);
+        }
+    }
+}
+
+// ==================== DECODE PROGRAM ====================
+
+uint16_t measureDecodeNames(const RegisterField* fields, uint8_t count) {
+    uint16_t length = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        length += strlen(fields[i].name) + 1;
+    }
+    return length;
+}
+
+/**
+ * @brief Fix every field's offset and width for one register size. names must hold
+ *        measureDecodeNames() bytes.
+ */
+void buildDecodeOps(const RegisterField* fields, uint8_t count, uint8_t registerSize, DecodeOp* ops, char* names) {
+    uint16_t cursor = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        const RegisterField& field = fields[i];
+        DecodeOp& op = ops[i];
+
+        op.nameOffset = cursor;
+        op.words = field.words ? field.words : registerSize;
+        op.registerOffset = field.words ? field.position : field.position * registerSize;
+        op.flags = field.flags;
+        op.param = field.param;
+        op.reserved = 0;
+        op.scale = field.scale;
+        op.add = field.add;
+
+        size_t length = strlen(field.name) + 1;
+        memcpy(names + cursor, field.name, length);
+        cursor += length;
+    }
+}
+
+/**
+ * @brief Hot path: one pass over the ops, reading the response in place. Fields
+ *        that reach past the registers actually read are skipped.
+ */
+void runDecodeProgram(const DecodeProgram& program, const DeviceParams& params, float ct, float pt,
+                      const uint16_t* registers, uint16_t registerCount, JsonObject root) {
+    for (uint8_t i = 0; i < program.opCount; i++) {
+        const DecodeOp& op = program.ops[i];
+        if (op.registerOffset + op.words > registerCount) continue;
+
+        const uint16_t* words = registers + op.registerOffset;
+        uint64_t raw = 0;
+        for (uint8_t w = 0; w < op.words; w++) {
+            raw = (raw << 16) | words[(op.flags & DECODE_WORDS_LITTLE) ? op.words - 1 - w : w];
+        }
+
+        float value;
+        if (op.flags & DECODE_FLOAT) {
+            uint32_t bits = (uint32_t)raw;
+            memcpy(&value, &bits, sizeof(value));
+        } else if (op.flags & DECODE_SIGNED) {
+            uint8_t unusedBits = 64 - op.words * 16;
+            value = (float)((int64_t)(raw << unusedBits) >> unusedBits);
+        } else {
+            value = (float)raw;
+        }
+
+        float factor = op.scale;
+        if (op.flags & DECODE_CT) factor *= ct;
+        if (op.flags & DECODE_PT) factor *= pt;
+        if (op.param != kNoDecodeParam) factor /= params.values[op.param];
+
+        root[program.names + op.nameOffset] = value * factor + op.add;
+    }
+}
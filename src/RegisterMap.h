@@ -0,0 +1,87 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// ==================== REGISTER MAP CONSTANTS ====================
+constexpr uint8_t kMaxParamDepth = 3;           // group / parameter / field
+constexpr uint8_t kMaxDecodeParams = 16;        // Distinct divider parameters per device
+constexpr uint8_t kMaxRegisterFields = 48;      // Outputs per device
+constexpr uint8_t kNoDecodeParam = 0xFF;
+constexpr uint16_t kMaxResponseRegisters = 64;  // ModbusMaster response buffer
+
+enum DecodeFlags : uint8_t {
+    DECODE_SIGNED = 0x01,       // Two's complement over the field's width
+    DECODE_WORDS_LITTLE = 0x02, // First register holds the least significant word
+    DECODE_FLOAT = 0x04,        // IEEE 754 single over two registers
+    DECODE_CT = 0x08,           // Multiply by the slave's CT ratio
+    DECODE_PT = 0x10            // Multiply by the slave's PT ratio
+};
+
+// ==================== REGISTER MAP ====================
+
+/**
+ * @brief One output of a device: value = raw * scale [* ct] [* pt] / divider + add.
+ *        words == 0 means position is a value index at the slave's register size;
+ *        otherwise position is a register offset into the read block.
+ */
+struct RegisterField {
+    const char* name;
+    const char* divider[kMaxParamDepth];    // Template parameter path, nullptr-padded; none = 1
+    uint16_t position;
+    uint8_t words;
+    uint8_t flags;
+    float scale;
+    float add;
+    uint8_t param;                          // Filled when compiled: index into DeviceParams
+};
+
+/**
+ * @brief Divider values a slave's register map reads, indexed by RegisterField::param
+ */
+struct DeviceParams {
+    float values[kMaxDecodeParams];
+};
+
+extern const DeviceParams kDefaultDeviceParams;     // All zero; slaves whose template failed to resolve
+
+// ==================== DECODE PROGRAM ====================
+struct CompiledTemplate;
+
+/**
+ * @brief A register field resolved for one register size: fixed offset and width,
+ *        ready to run against a response. Plain data so it can be compared and stored.
+ */
+struct DecodeOp {
+    uint16_t nameOffset;        // Into DecodeProgram::names
+    uint16_t registerOffset;
+    uint8_t words;
+    uint8_t flags;
+    uint8_t param;
+    uint8_t reserved;
+    float scale;
+    float add;
+};
+
+struct DecodeProgram {
+    DecodeProgram* next;
+    const CompiledTemplate* tmpl;   // Built from, with registerSize; nullptr = not keyed
+    uint8_t registerSize;
+    uint8_t opCount;
+    uint16_t namesLength;
+    DecodeOp* ops;
+    char* names;                // Terminated output names, back to back
+};
+
+extern const DecodeProgram kEmptyDecodeProgram;     // Decodes nothing; slaves without a template
+
+// ==================== REGISTER MAP API ====================
+const RegisterField* findBuiltinRegisterMap(const char* deviceType, uint8_t& count);
+
+bool parseRegisterField(JsonObjectConst entry, RegisterField& field);
+void writeRegisterField(const RegisterField& field, JsonObject output);
+
+uint16_t measureDecodeNames(const RegisterField* fields, uint8_t count);
+void buildDecodeOps(const RegisterField* fields, uint8_t count, uint8_t registerSize, DecodeOp* ops, char* names);
+void runDecodeProgram(const DecodeProgram& program, const DeviceParams& params, float ct, float pt,
+                      const uint16_t* registers, uint16_t registerCount, JsonObject root);
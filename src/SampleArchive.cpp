@@ -0,0 +1,540 @@
+#include "SampleArchive.h"
+#include "FSHandler.h"
+#include "HistoryStore.h"
+
+// ==================== SEGMENT LAYOUT ====================
+// /archive/rNNNNNNNN  raw records, appended a page at a time; the highest is active
+// /archive/aNNNNNNNN  kArchiveBucketSeconds means compacted from the oldest raw segments
+// Segment numbers only grow, so [first, last] of each kind describes the whole store.
+// The active segments stay open; LittleFS commits metadata only when they are synced,
+// so a page append costs a data program, not a metadata pair rewrite. Raw segments
+// rotate on a bucket boundary, so each holds whole buckets for compaction.
+
+constexpr uint8_t kMaxCompactionBuckets = kMaxHistorySeries;
+
+enum ArchivePhase : uint8_t {
+    ARCHIVE_PHASE_AGGREGATE,
+    ARCHIVE_PHASE_RAW,
+    ARCHIVE_PHASE_PENDING,
+    ARCHIVE_PHASE_DONE
+};
+
+struct ArchiveBucket {
+    uint32_t start;
+    uint32_t channelHash;
+    uint16_t nameHash;
+    uint8_t slaveId;
+    uint8_t count;
+    float sum;
+};
+
+/**
+ * @brief Incremental compaction of one raw segment, one page per loop pass.
+ *        Allocated only while a compaction runs.
+ */
+struct CompactionState {
+    uint32_t segment;
+    uint32_t offset;
+    uint8_t bucketCount;
+    uint16_t outLength;
+    ArchiveBucket buckets[kMaxCompactionBuckets];
+    uint8_t out[kArchivePageBytes];
+};
+
+// ==================== GLOBAL VARIABLES ====================
+
+uint32_t rawFirstSegment = 1;
+uint32_t rawLastSegment = 1;         // Active segment, may not exist yet
+size_t rawActiveBytes = 0;
+uint32_t aggregateFirstSegment = 1;
+uint32_t aggregateLastSegment = 0;   // last < first = no aggregates yet
+size_t aggregateActiveBytes = 0;
+
+File rawSegmentFile;
+size_t rawUnsyncedBytes = 0;
+uint32_t lastArchivedBucket = 0;
+File aggregateSegmentFile;
+
+uint8_t pendingPage[kArchivePageBytes];
+uint16_t pendingLength = 0;
+unsigned long pendingSince = 0;
+
+std::shared_ptr<ArchiveCursor> archiveQueries[kMaxArchiveQueries];
+
+CompactionState* compaction = nullptr;
+bool archiveReady = false;
+
+// ==================== HELPERS ====================
+
+void formatSegmentPath(char* path, size_t size, bool aggregate, uint32_t segment) {
+    snprintf(path, size, "%s/%c%08lu", kArchiveDir, aggregate ? 'a' : 'r', (unsigned long)segment);
+}
+
+uint16_t foldNameHash(uint32_t nameHash) {
+    return (uint16_t)(nameHash ^ (nameHash >> 16));
+}
+
+uint32_t bucketStart(uint32_t time) {
+    return time - time % kArchiveBucketSeconds;
+}
+
+// ==================== INITIALIZATION ====================
+
+bool initSampleArchive() {
+    LittleFS.mkdir(kArchiveDir);
+
+    bool anyRaw = false;
+    bool anyAggregate = false;
+    Dir dir = LittleFS.openDir(kArchiveDir);
+    while (dir.next()) {
+        String name = dir.fileName();
+        if (name.length() < 2 || (name[0] != 'r' && name[0] != 'a')) continue;
+
+        uint32_t segment = strtoul(name.c_str() + 1, nullptr, 10);
+        if (segment == 0) continue;
+
+        if (name[0] == 'r') {
+            if (!anyRaw || segment < rawFirstSegment) rawFirstSegment = segment;
+            if (!anyRaw || segment >= rawLastSegment) {
+                rawLastSegment = segment;
+                rawActiveBytes = dir.fileSize();
+            }
+            anyRaw = true;
+        } else {
+            if (!anyAggregate || segment < aggregateFirstSegment) aggregateFirstSegment = segment;
+            if (!anyAggregate || segment >= aggregateLastSegment) {
+                aggregateLastSegment = segment;
+                aggregateActiveBytes = dir.fileSize();
+            }
+            anyAggregate = true;
+        }
+    }
+
+    // A torn final append leaves a partial record; start the next write on a fresh segment
+    if (rawActiveBytes % sizeof(ArchiveRecord) != 0 || rawActiveBytes >= kArchiveSegmentBytes) {
+        rawLastSegment++;
+        rawActiveBytes = 0;
+    }
+    if (anyAggregate && (aggregateActiveBytes % sizeof(ArchiveRecord) != 0 ||
+                         aggregateActiveBytes >= kArchiveSegmentBytes)) {
+        aggregateLastSegment++;
+        aggregateActiveBytes = 0;
+    }
+
+    archiveReady = true;
+    Serial.printf("🗄️ Sample archive: raw segments %lu-%lu, aggregate segments %lu-%lu\n",
+                  (unsigned long)rawFirstSegment, (unsigned long)rawLastSegment,
+                  (unsigned long)aggregateFirstSegment, (unsigned long)aggregateLastSegment);
+    return true;
+}
+
+// ==================== APPENDING ====================
+
+/**
+ * @brief Append to an archive segment kept open across calls
+ */
+bool appendOpenSegment(File& file, bool aggregate, uint32_t segment, const uint8_t* data, size_t length) {
+    if (!file) {
+        char path[24];
+        formatSegmentPath(path, sizeof(path), aggregate, segment);
+        file = LittleFS.open(path, "a");
+        if (!file) {
+            Serial.printf("❌ Failed to open %s for append\n", path);
+            return false;
+        }
+    }
+    return file.write(data, length) == length;
+}
+
+void syncRawSegment() {
+    if (rawSegmentFile && rawUnsyncedBytes > 0) {
+        rawSegmentFile.flush();
+        rawUnsyncedBytes = 0;
+    }
+}
+
+void rotateRawSegment() {
+    if (rawSegmentFile) {
+        rawSegmentFile.close();
+    }
+    rawUnsyncedBytes = 0;
+    rawLastSegment++;
+    rawActiveBytes = 0;
+}
+
+void appendRawPage(const uint8_t* data, size_t length) {
+    if (!appendOpenSegment(rawSegmentFile, false, rawLastSegment, data, length)) {
+        Serial.println("❌ Sample archive write failed, page dropped");
+        rawSegmentFile.close();
+        return;
+    }
+
+    rawActiveBytes += length;
+    rawUnsyncedBytes += length;
+    if (rawUnsyncedBytes >= kArchiveSyncBytes) {
+        syncRawSegment();
+    }
+}
+
+void appendAggregatePage(const uint8_t* data, size_t length) {
+    if (aggregateLastSegment < aggregateFirstSegment) {
+        aggregateLastSegment = aggregateFirstSegment;
+    }
+
+    if (!appendOpenSegment(aggregateSegmentFile, true, aggregateLastSegment, data, length)) {
+        Serial.println("❌ Sample archive compaction write failed, page dropped");
+        aggregateSegmentFile.close();
+        return;
+    }
+
+    aggregateActiveBytes += length;
+    if (aggregateActiveBytes < kArchiveSegmentBytes) return;
+
+    aggregateSegmentFile.close();
+    aggregateLastSegment++;
+    aggregateActiveBytes = 0;
+
+    // Retention: the oldest compacted data goes first
+    char path[24];
+    while (aggregateLastSegment - aggregateFirstSegment >= kMaxAggregateSegments) {
+        formatSegmentPath(path, sizeof(path), true, aggregateFirstSegment);
+        LittleFS.remove(path);
+        aggregateFirstSegment++;
+    }
+}
+
+void writePendingPage() {
+    if (pendingLength == 0) return;
+    appendRawPage(pendingPage, pendingLength);
+    pendingLength = 0;
+}
+
+/**
+ * @brief Write the partial page and commit the open segment (before a reboot)
+ */
+void flushSampleArchive() {
+    writePendingPage();
+    syncRawSegment();
+}
+
+void archiveSample(uint8_t slaveId, uint32_t nameHash, uint32_t channelHash, uint32_t time, float value) {
+    if (!archiveReady || time < kMinArchiveTime) return;
+
+    // A full segment closes when the first sample of the next bucket arrives
+    uint32_t bucket = bucketStart(time);
+    if (bucket != lastArchivedBucket && rawActiveBytes + pendingLength >= kArchiveSegmentBytes) {
+        writePendingPage();
+        rotateRawSegment();
+    }
+    lastArchivedBucket = bucket;
+
+    ArchiveRecord record;
+    record.time = time;
+    record.value = value;
+    record.channelHash = channelHash;
+    record.nameHash = foldNameHash(nameHash);
+    record.slaveId = slaveId;
+    record.count = 1;
+
+    if (pendingLength == 0) {
+        pendingSince = millis();
+    }
+    memcpy(pendingPage + pendingLength, &record, sizeof(record));
+    pendingLength += sizeof(record);
+
+    if (pendingLength >= kArchivePageBytes) {
+        writePendingPage();
+    }
+}
+
+// ==================== COMPACTION ====================
+
+void emitBucket(const ArchiveBucket& bucket) {
+    ArchiveRecord record;
+    record.time = bucket.start;
+    record.value = bucket.sum / bucket.count;
+    record.channelHash = bucket.channelHash;
+    record.nameHash = bucket.nameHash;
+    record.slaveId = bucket.slaveId;
+    record.count = bucket.count;
+
+    memcpy(compaction->out + compaction->outLength, &record, sizeof(record));
+    compaction->outLength += sizeof(record);
+    if (compaction->outLength >= kArchivePageBytes) {
+        appendAggregatePage(compaction->out, compaction->outLength);
+        compaction->outLength = 0;
+    }
+}
+
+void foldIntoBucket(const ArchiveRecord& record) {
+    uint32_t start = bucketStart(record.time);
+    ArchiveBucket* bucket = nullptr;
+    uint8_t oldest = 0;
+
+    for (uint8_t i = 0; i < compaction->bucketCount; i++) {
+        ArchiveBucket& candidate = compaction->buckets[i];
+        if (candidate.channelHash == record.channelHash && candidate.nameHash == record.nameHash &&
+            candidate.slaveId == record.slaveId) {
+            bucket = &candidate;
+            break;
+        }
+        if (candidate.start < compaction->buckets[oldest].start) {
+            oldest = i;
+        }
+    }
+
+    if (bucket == nullptr) {
+        if (compaction->bucketCount < kMaxCompactionBuckets) {
+            bucket = &compaction->buckets[compaction->bucketCount++];
+        } else {
+            bucket = &compaction->buckets[oldest];
+            emitBucket(*bucket);
+        }
+        bucket->channelHash = record.channelHash;
+        bucket->nameHash = record.nameHash;
+        bucket->slaveId = record.slaveId;
+        bucket->start = start;
+        bucket->count = 0;
+        bucket->sum = 0;
+    } else if (bucket->start != start || bucket->count == 255) {
+        emitBucket(*bucket);
+        bucket->start = start;
+        bucket->count = 0;
+        bucket->sum = 0;
+    }
+
+    bucket->sum += record.value;
+    bucket->count++;
+}
+
+void finishCompaction() {
+    for (uint8_t i = 0; i < compaction->bucketCount; i++) {
+        emitBucket(compaction->buckets[i]);
+    }
+    if (compaction->outLength > 0) {
+        appendAggregatePage(compaction->out, compaction->outLength);
+    }
+    aggregateSegmentFile.close();
+
+    char path[24];
+    formatSegmentPath(path, sizeof(path), false, compaction->segment);
+    LittleFS.remove(path);
+    rawFirstSegment = compaction->segment + 1;
+
+    Serial.printf("🗜️ Compacted archive segment %lu\n", (unsigned long)compaction->segment);
+    delete compaction;
+    compaction = nullptr;
+}
+
+void stepCompaction() {
+    char path[24];
+    formatSegmentPath(path, sizeof(path), false, compaction->segment);
+
+    uint8_t page[kArchivePageBytes];
+    size_t bytesRead = readFileAt(path, compaction->offset, page, sizeof(page));
+    bytesRead -= bytesRead % sizeof(ArchiveRecord);
+    if (bytesRead == 0) {
+        finishCompaction();
+        return;
+    }
+
+    for (size_t position = 0; position < bytesRead; position += sizeof(ArchiveRecord)) {
+        ArchiveRecord record;
+        memcpy(&record, page + position, sizeof(record));
+        foldIntoBucket(record);
+    }
+    compaction->offset += bytesRead;
+}
+
+// ==================== RANGE QUERY ====================
+
+uint32_t firstRecordTime(bool aggregate, uint32_t segment) {
+    char path[24];
+    formatSegmentPath(path, sizeof(path), aggregate, segment);
+
+    ArchiveRecord record;
+    if (readFileAt(path, 0, (uint8_t*)&record, sizeof(record)) != sizeof(record)) return UINT32_MAX;
+    return record.time;
+}
+
+/**
+ * @brief Refill the cursor page from wherever it points next
+ * @return false once every source is exhausted
+ */
+bool loadArchivePage(ArchiveCursor& cursor) {
+    while (cursor.phase != ARCHIVE_PHASE_DONE) {
+        if (cursor.phase == ARCHIVE_PHASE_PENDING) {
+            memcpy(cursor.page, pendingPage, pendingLength);
+            cursor.pageLength = pendingLength;
+            cursor.pagePosition = 0;
+            cursor.phase = ARCHIVE_PHASE_DONE;
+            return cursor.pageLength > 0;
+        }
+
+        bool aggregate = (cursor.phase == ARCHIVE_PHASE_AGGREGATE);
+        uint32_t first = aggregate ? aggregateFirstSegment : rawFirstSegment;
+        uint32_t last = aggregate ? aggregateLastSegment : rawLastSegment;
+
+        // Segments compacted or dropped while the response was draining are skipped
+        if (cursor.segment < first) {
+            cursor.segment = first;
+            cursor.offset = 0;
+        }
+        if (cursor.segment > last) {
+            cursor.phase++;
+            cursor.segment = rawFirstSegment;
+            cursor.offset = 0;
+            continue;
+        }
+
+        // Raw segments are in time order, so whole ones ending before the range are not read
+        if (!aggregate && cursor.offset == 0 && cursor.segment < last &&
+            firstRecordTime(aggregate, cursor.segment + 1) <= cursor.fromTime) {
+            cursor.segment++;
+            continue;
+        }
+
+        char path[24];
+        formatSegmentPath(path, sizeof(path), aggregate, cursor.segment);
+        size_t bytesRead = readFileAt(path, cursor.offset, cursor.page, sizeof(cursor.page));
+        bytesRead -= bytesRead % sizeof(ArchiveRecord);
+        if (bytesRead == 0) {
+            cursor.segment++;
+            cursor.offset = 0;
+            continue;
+        }
+
+        cursor.offset += bytesRead;
+        cursor.pageLength = bytesRead;
+        cursor.pagePosition = 0;
+        return true;
+    }
+    return false;
+}
+
+bool matchesArchiveQuery(const ArchiveCursor& cursor, const ArchiveRecord& record) {
+    if (record.channelHash != cursor.channelHash || record.slaveId != cursor.slaveId) return false;
+    if (!cursor.anyName && record.nameHash != cursor.nameHash) return false;
+    return record.time >= cursor.fromTime && record.time <= cursor.toTime;
+}
+
+/**
+ * @brief Move matching records into the ready ring until it is full, the sources
+ *        run out or the pass has used its flash budget
+ */
+void fillArchiveQuery(ArchiveCursor& cursor, unsigned long passStart) {
+    while (!cursor.exhausted && cursor.readyCount < kArchiveReadyRecords) {
+        if (cursor.pagePosition >= cursor.pageLength) {
+            if (micros() - passStart >= kArchiveFillBudgetMicros) return;
+            if (!loadArchivePage(cursor)) {
+                cursor.exhausted = true;
+                return;
+            }
+        }
+
+        ArchiveRecord record;
+        memcpy(&record, cursor.page + cursor.pagePosition, sizeof(record));
+        cursor.pagePosition += sizeof(record);
+        if (!matchesArchiveQuery(cursor, record)) continue;
+
+        cursor.ready[(cursor.readyHead + cursor.readyCount) % kArchiveReadyRecords] = record;
+        cursor.readyCount++;
+    }
+}
+
+void fillArchiveQueries() {
+    unsigned long passStart = micros();
+    for (uint8_t i = 0; i < kMaxArchiveQueries; i++) {
+        std::shared_ptr<ArchiveCursor>& query = archiveQueries[i];
+        if (!query) continue;
+
+        // Response finished or client gone; an exhausted cursor is left to drain
+        if (query.use_count() == 1 || query->exhausted) {
+            query.reset();
+            continue;
+        }
+        fillArchiveQuery(*query, passStart);
+    }
+}
+
+/**
+ * @brief Start a range query. Runs in loop(); the cursor is filled from flash by
+ *        serviceSampleArchive() until it is exhausted or the response drops it.
+ * @return false when kMaxArchiveQueries are already running
+ */
+bool openArchiveQuery(const std::shared_ptr<ArchiveCursor>& query, uint8_t slaveId, const char* slaveName,
+                      const char* channel, uint32_t fromTime, uint32_t toTime) {
+    int slot = -1;
+    for (uint8_t i = 0; i < kMaxArchiveQueries; i++) {
+        // Only the table still holding a query means its response is gone
+        if (archiveQueries[i] && archiveQueries[i].use_count() == 1) {
+            archiveQueries[i].reset();
+        }
+        if (!archiveQueries[i] && slot < 0) {
+            slot = i;
+        }
+    }
+    if (slot < 0) return false;
+
+    // Readers only see what the open segment has committed
+    syncRawSegment();
+
+    ArchiveCursor& cursor = *query;
+    cursor.slaveId = slaveId;
+    cursor.anyName = (slaveName == nullptr);
+    cursor.nameHash = cursor.anyName ? 0 : foldNameHash(hashHistoryKey(slaveName));
+    cursor.channelHash = hashHistoryKey(channel);
+    cursor.fromTime = fromTime;
+    cursor.toTime = toTime;
+    cursor.phase = (aggregateLastSegment >= aggregateFirstSegment) ? ARCHIVE_PHASE_AGGREGATE : ARCHIVE_PHASE_RAW;
+    cursor.segment = (cursor.phase == ARCHIVE_PHASE_AGGREGATE) ? aggregateFirstSegment : rawFirstSegment;
+    cursor.offset = 0;
+    cursor.pageLength = 0;
+    cursor.pagePosition = 0;
+    cursor.exhausted = false;
+    cursor.readyHead = 0;
+    cursor.readyCount = 0;
+
+    archiveQueries[slot] = query;
+    fillArchiveQuery(cursor, micros());
+    return true;
+}
+
+/**
+ * @brief Next prefetched record; never touches flash, so it is safe in the TCP callback
+ * @return false when nothing is ready (check isArchiveQueryDone)
+ */
+bool takeArchiveRecord(ArchiveCursor& cursor, ArchiveRecord& record) {
+    if (cursor.readyCount == 0) return false;
+    record = cursor.ready[cursor.readyHead];
+    cursor.readyHead = (cursor.readyHead + 1) % kArchiveReadyRecords;
+    cursor.readyCount--;
+    return true;
+}
+
+bool isArchiveQueryDone(const ArchiveCursor& cursor) {
+    return cursor.exhausted && cursor.readyCount == 0;
+}
+
+// ==================== SERVICE ====================
+
+void serviceSampleArchive() {
+    if (!archiveReady) return;
+
+    if (pendingLength > 0 && millis() - pendingSince >= kArchiveMaxPendingAge) {
+        flushSampleArchive();
+    }
+
+    fillArchiveQueries();
+
+    if (compaction != nullptr) {
+        stepCompaction();
+        return;
+    }
+
+    // The active segment is not counted; compact once too many closed ones pile up
+    if (rawLastSegment - rawFirstSegment > kMaxRawSegments) {
+        compaction = new CompactionState();
+        compaction->segment = rawFirstSegment;
+    }
+}
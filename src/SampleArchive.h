@@ -0,0 +1,69 @@
+#pragma once
+
+#include <Arduino.h>
+#include <memory>
+
+// ==================== ARCHIVE CONSTANTS ====================
+// At 50 channels sampled once a minute (16 B records): raw 8 x 16 KB ~ 2.7 h,
+// aggregate 24 x 16 KB of 15 min means ~ 5 days. 512 KB of flash in total.
+constexpr size_t kArchivePageBytes = 256;               // Flash program unit; appends are batched to it
+constexpr size_t kArchiveSyncBytes = 4096;              // Open segment is committed once per erase block
+constexpr size_t kArchiveSegmentBytes = 16384;          // Active segment rotates at the next bucket past this
+constexpr uint8_t kMaxRawSegments = 8;                  // Beyond this the oldest is compacted
+constexpr uint8_t kMaxAggregateSegments = 24;           // Beyond this the oldest is dropped
+constexpr uint32_t kArchiveBucketSeconds = 900;         // Resolution of compacted data
+constexpr unsigned long kArchiveMaxPendingAge = 600000; // A partial page is written after 10 min anyway
+constexpr uint32_t kMinArchiveTime = 1600000000;        // Uptime-based timestamps are not archived
+constexpr uint8_t kMaxArchiveQueries = 2;               // Range queries being prefetched at once
+constexpr uint8_t kArchiveReadyRecords = 48;            // Matches prefetched per query
+constexpr unsigned long kArchiveFillBudgetMicros = 4000; // Flash reading per service pass
+
+// ==================== RECORD FORMAT ====================
+
+struct ArchiveRecord {
+    uint32_t time;              // Epoch seconds (bucket start once compacted)
+    float value;                // Sample, or mean of the bucket
+    uint32_t channelHash;
+    uint16_t nameHash;
+    uint8_t slaveId;
+    uint8_t count;              // Samples folded into the record, 1 = raw
+};
+
+static_assert(kArchivePageBytes % sizeof(ArchiveRecord) == 0, "records must tile a page");
+
+// ==================== RANGE QUERY CURSOR ====================
+
+/**
+ * @brief Walks aggregate segments, then raw segments, then the unwritten page,
+ *        which is oldest to newest. Flash is read from loop() one page at a time
+ *        into the ready ring; the response only drains the ring.
+ */
+struct ArchiveCursor {
+    uint8_t slaveId;
+    bool anyName;
+    uint16_t nameHash;
+    uint32_t channelHash;
+    uint32_t fromTime;
+    uint32_t toTime;
+    uint8_t phase;
+    uint32_t segment;
+    uint32_t offset;
+    uint16_t pageLength;
+    uint16_t pagePosition;
+    uint8_t page[kArchivePageBytes];
+    bool exhausted;
+    uint8_t readyHead;
+    uint8_t readyCount;
+    ArchiveRecord ready[kArchiveReadyRecords];
+};
+
+// ==================== ARCHIVE API ====================
+bool initSampleArchive();
+void archiveSample(uint8_t slaveId, uint32_t nameHash, uint32_t channelHash, uint32_t time, float value);
+void flushSampleArchive();
+void serviceSampleArchive();
+
+bool openArchiveQuery(const std::shared_ptr<ArchiveCursor>& cursor, uint8_t slaveId, const char* slaveName,
+                      const char* channel, uint32_t fromTime, uint32_t toTime);
+bool takeArchiveRecord(ArchiveCursor& cursor, ArchiveRecord& record);
+bool isArchiveQueryDone(const ArchiveCursor& cursor);
@@ -0,0 +1,167 @@
+#include "SparkplugCodec.h"
+
+// ==================== PROTOBUF ENCODING ====================
+
+void pbWriteByte(PbWriter& w, uint8_t value) {
+    if (w.length < w.capacity) {
+        w.buf[w.length++] = value;
+    } else {
+        w.overflow = true;
+    }
+}
+
+void pbWriteVarint(PbWriter& w, uint64_t value) {
+    while (value >= 0x80) {
+        pbWriteByte(w, (uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    pbWriteByte(w, (uint8_t)value);
+}
+
+void pbWriteVarintField(PbWriter& w, uint8_t field, uint64_t value) {
+    pbWriteVarint(w, (field << 3) | 0);
+    pbWriteVarint(w, value);
+}
+
+void pbWriteBytesField(PbWriter& w, uint8_t field, const uint8_t* data, size_t length) {
+    pbWriteVarint(w, (field << 3) | 2);
+    pbWriteVarint(w, length);
+    for (size_t i = 0; i < length; i++) {
+        pbWriteByte(w, data[i]);
+    }
+}
+
+void pbWriteFloatField(PbWriter& w, uint8_t field, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    pbWriteVarint(w, (field << 3) | 5);
+    for (int i = 0; i < 4; i++) {
+        pbWriteByte(w, (uint8_t)(bits >> (8 * i)));
+    }
+}
+
+// ==================== METRICS ====================
+// Metric fields: name=1 alias=2 datatype=4 long_value=11 float_value=12 boolean_value=14
+
+void writeFloatMetric(PbWriter& payload, const char* name, uint64_t alias, float value) {
+    uint8_t metricBuf[kSparkplugMetricSize];
+    PbWriter metric = { metricBuf, sizeof(metricBuf), 0, false };
+
+    if (name != nullptr) {
+        pbWriteBytesField(metric, 1, (const uint8_t*)name, strlen(name));
+        pbWriteVarintField(metric, 4, SP_TYPE_FLOAT);
+    }
+    pbWriteVarintField(metric, 2, alias);
+    pbWriteFloatField(metric, 12, value);
+
+    if (!metric.overflow) {
+        pbWriteBytesField(payload, 2, metric.buf, metric.length);
+    }
+}
+
+void writeBdSeqMetric(PbWriter& payload, uint8_t bdSeq) {
+    uint8_t metricBuf[kSparkplugMetricSize];
+    PbWriter metric = { metricBuf, sizeof(metricBuf), 0, false };
+
+    pbWriteBytesField(metric, 1, (const uint8_t*)"bdSeq", 5);
+    pbWriteVarintField(metric, 4, SP_TYPE_UINT64);
+    pbWriteVarintField(metric, 11, bdSeq);
+    pbWriteBytesField(payload, 2, metric.buf, metric.length);
+}
+
+void writeRebirthMetric(PbWriter& payload) {
+    uint8_t metricBuf[kSparkplugMetricSize];
+    PbWriter metric = { metricBuf, sizeof(metricBuf), 0, false };
+
+    pbWriteBytesField(metric, 1, (const uint8_t*)kRebirthMetric, strlen(kRebirthMetric));
+    pbWriteVarintField(metric, 2, kRebirthAlias);
+    pbWriteVarintField(metric, 4, SP_TYPE_BOOLEAN);
+    pbWriteVarintField(metric, 14, 0);
+    pbWriteBytesField(payload, 2, metric.buf, metric.length);
+}
+
+// ==================== PROTOBUF DECODING ====================
+
+bool pbReadVarint(const uint8_t*& p, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        uint8_t b = *p++;
+        value |= (uint64_t)(b & 0x7F) << shift;
+        if ((b & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+bool pbSkipField(const uint8_t*& p, const uint8_t* end, uint8_t wireType) {
+    uint64_t length;
+    switch (wireType) {
+        case 0: return pbReadVarint(p, end, length);
+        case 1:
+            if (end - p < 8) return false;
+            p += 8;
+            return true;
+        case 2:
+            if (!pbReadVarint(p, end, length) || length > (uint64_t)(end - p)) return false;
+            p += length;
+            return true;
+        case 5:
+            if (end - p < 4) return false;
+            p += 4;
+            return true;
+        default: return false;
+    }
+}
+
+bool isRebirthMetric(const uint8_t* p, const uint8_t* end) {
+    bool nameMatches = false;
+    bool aliasMatches = false;
+    bool value = false;
+
+    while (p < end) {
+        uint64_t key;
+        if (!pbReadVarint(p, end, key)) return false;
+        uint8_t field = key >> 3;
+        uint8_t wireType = key & 0x07;
+
+        if (field == 1 && wireType == 2) {
+            uint64_t length;
+            if (!pbReadVarint(p, end, length) || length > (uint64_t)(end - p)) return false;
+            nameMatches = (length == strlen(kRebirthMetric)) && memcmp(p, kRebirthMetric, length) == 0;
+            p += length;
+        } else if ((field == 2 || field == 14) && wireType == 0) {
+            uint64_t v;
+            if (!pbReadVarint(p, end, v)) return false;
+            if (field == 2) aliasMatches = (v == kRebirthAlias);
+            else value = (v != 0);
+        } else if (!pbSkipField(p, end, wireType)) {
+            return false;
+        }
+    }
+
+    return (nameMatches || aliasMatches) && value;
+}
+
+/**
+ * @brief True if any metric of an NCMD payload sets Node Control/Rebirth
+ */
+bool payloadRequestsRebirth(const uint8_t* payload, size_t length) {
+    const uint8_t* p = payload;
+    const uint8_t* end = payload + length;
+
+    while (p < end) {
+        uint64_t key;
+        if (!pbReadVarint(p, end, key)) return false;
+        uint8_t field = key >> 3;
+        uint8_t wireType = key & 0x07;
+
+        if (field == 2 && wireType == 2) {
+            uint64_t metricLength;
+            if (!pbReadVarint(p, end, metricLength) || metricLength > (uint64_t)(end - p)) return false;
+            if (isRebirthMetric(p, p + metricLength)) return true;
+            p += metricLength;
+        } else if (!pbSkipField(p, end, wireType)) {
+            return false;
+        }
+    }
+    return false;
+}
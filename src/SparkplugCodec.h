@@ -0,0 +1,42 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ==================== SPARKPLUG B PROTOBUF CODEC ====================
+// Minimal proto2 writer/reader for the Sparkplug B Payload and Metric messages.
+// Free of MQTT and slave state so payloads can be checked against protoc off-device.
+
+constexpr const char* kRebirthMetric = "Node Control/Rebirth";
+constexpr uint64_t kRebirthAlias = 1;           // Device aliases start at 0x100
+constexpr size_t kSparkplugMetricSize = 96;
+
+// Sparkplug B datatypes (subset used by the gateway)
+enum SparkplugDataType {
+    SP_TYPE_UINT64 = 8,
+    SP_TYPE_FLOAT = 9,
+    SP_TYPE_BOOLEAN = 11
+};
+
+struct PbWriter {
+    uint8_t* buf;
+    size_t capacity;
+    size_t length;
+    bool overflow;
+};
+
+// ==================== ENCODING ====================
+void pbWriteByte(PbWriter& w, uint8_t value);
+void pbWriteVarint(PbWriter& w, uint64_t value);
+void pbWriteVarintField(PbWriter& w, uint8_t field, uint64_t value);
+void pbWriteBytesField(PbWriter& w, uint8_t field, const uint8_t* data, size_t length);
+void pbWriteFloatField(PbWriter& w, uint8_t field, float value);
+
+void writeFloatMetric(PbWriter& payload, const char* name, uint64_t alias, float value);
+void writeBdSeqMetric(PbWriter& payload, uint8_t bdSeq);
+void writeRebirthMetric(PbWriter& payload);
+
+// ==================== DECODING ====================
+bool pbReadVarint(const uint8_t*& p, const uint8_t* end, uint64_t& value);
+bool pbSkipField(const uint8_t*& p, const uint8_t* end, uint8_t wireType);
+bool isRebirthMetric(const uint8_t* p, const uint8_t* end);
+bool payloadRequestsRebirth(const uint8_t* payload, size_t length);
@@ -0,0 +1,231 @@
+#include "SparkplugHandler.h"
+#include "ModBusHandler.h"
+#include "PublishQueue.h"
+
+// ==================== GLOBAL VARIABLES ====================
+
+SparkplugDevice* sparkplugDevices = nullptr;
+int sparkplugDeviceCount = 0;
+uint8_t sparkplugSeq = 0;
+uint8_t sparkplugBdSeq = 0;
+
+// Shared encode buffer - payloads are built and published one at a time
+uint8_t sparkplugBuffer[kSparkplugBufferSize];
+
+// ==================== HELPERS ====================
+
+void writeNodeMetrics(PbWriter& payload, bool includeRebirth) {
+    writeBdSeqMetric(payload, sparkplugBdSeq);
+    if (includeRebirth) {
+        writeRebirthMetric(payload);
+    }
+}
+
+bool isSparkplugEnabled() {
+    return mqttConfig.sparkplugEnabled;
+}
+
+void appendSparkplugId(String& topic, const char* id) {
+    // Sparkplug ids must not contain topic separators or wildcards
+    for (const char* c = id; *c; c++) {
+        topic += (*c == '/' || *c == '+' || *c == '#') ? '_' : *c;
+    }
+}
+
+String buildSparkplugTopic(const char* messageType, const char* deviceName) {
+    String topic = kSparkplugNamespace;
+    topic += '/';
+    appendSparkplugId(topic, mqttConfig.groupId);
+    topic += '/';
+    topic += messageType;
+    topic += '/';
+
+    appendSparkplugId(topic, getGatewayId().c_str());
+
+    if (deviceName != nullptr) {
+        topic += '/';
+        appendSparkplugId(topic, deviceName);
+    }
+    return topic;
+}
+
+void beginPayload(PbWriter& payload, uint64_t timestamp = 0) {
+    payload = { sparkplugBuffer, sizeof(sparkplugBuffer), 0, false };
+    pbWriteVarintField(payload, 1, timestamp ? timestamp : getTimestampMillis());
+}
+
+bool finishAndPublish(PbWriter& payload, const String& topic, uint8_t seq, uint32_t sampledAt = 0) {
+    pbWriteVarintField(payload, 3, seq);
+
+    if (payload.overflow) {
+        Serial.printf("❌ Sparkplug payload too large for %s\n", topic.c_str());
+        return false;
+    }
+
+    // Sequence numbers must arrive in order - never coalesced
+    return enqueuePublish(topic.c_str(), payload.buf, payload.length, false, false, sampledAt);
+}
+
+// ==================== EDGE NODE LIFECYCLE ====================
+
+bool connectSparkplugSession(const char* clientId) {
+    // bdSeq kept in 1..255: PubSubClient sends the will as a C string, so the
+    // NDEATH payload must not contain NUL bytes (it also carries no timestamp)
+    sparkplugBdSeq = (sparkplugBdSeq % 255) + 1;
+
+    PbWriter death = { sparkplugBuffer, sizeof(sparkplugBuffer) - 1, 0, false };
+    writeNodeMetrics(death, false);
+    sparkplugBuffer[death.length] = '\0';
+
+    String deathTopic = buildSparkplugTopic("NDEATH");
+    if (!mqttClient.connect(clientId, deathTopic.c_str(), 1, false, (const char*)sparkplugBuffer)) {
+        return false;
+    }
+
+    mqttClient.subscribe(buildSparkplugTopic("NCMD").c_str());
+    publishNodeBirth();
+    return true;
+}
+
+void publishNodeBirth() {
+    // Anything still queued belongs to the previous birth sequence
+    clearPublishQueue();
+
+    PbWriter payload;
+    beginPayload(payload);
+    writeNodeMetrics(payload, true);
+
+    sparkplugSeq = 0;
+    finishAndPublish(payload, buildSparkplugTopic("NBIRTH"), sparkplugSeq);
+
+    // A new NBIRTH invalidates all device births - they follow with the next readings
+    for (int i = 0; i < sparkplugDeviceCount; i++) {
+        sparkplugDevices[i].born = false;
+    }
+}
+
+void handleSparkplugCommand(const char* topic, const uint8_t* payload, unsigned int length) {
+    if (buildSparkplugTopic("NCMD") != topic) return;
+
+    if (payloadRequestsRebirth(payload, length)) {
+        Serial.println("🔁 Sparkplug rebirth requested");
+        publishNodeBirth();
+    }
+}
+
+// ==================== DEVICE LIFECYCLE ====================
+
+/**
+ * @brief Carry device state across a diffed slave table. sourceIndex[j] is the old
+ *        index of new slave j, or -1 if it is new or changed. Aliases encode the
+ *        index, so only devices that keep their index stay born.
+ *        Must run before the slave table itself is swapped (DDEATH uses old names).
+ */
+void remapSparkplugDevices(const int* sourceIndex, int newDeviceCount) {
+    bool* carried = (sparkplugDeviceCount > 0) ? new bool[sparkplugDeviceCount]() : nullptr;
+    for (int j = 0; j < newDeviceCount; j++) {
+        if (sourceIndex[j] >= 0 && sourceIndex[j] < sparkplugDeviceCount) {
+            carried[sourceIndex[j]] = true;
+            if (sourceIndex[j] != j) {
+                publishSparkplugDeviceDeath(sourceIndex[j]);
+            }
+        }
+    }
+
+    SparkplugDevice* remapped = (newDeviceCount > 0) ? new SparkplugDevice[newDeviceCount]() : nullptr;
+    for (int j = 0; j < newDeviceCount; j++) {
+        if (sourceIndex[j] >= 0 && sourceIndex[j] < sparkplugDeviceCount) {
+            remapped[j] = sparkplugDevices[sourceIndex[j]];
+        }
+    }
+
+    for (int i = 0; i < sparkplugDeviceCount; i++) {
+        if (!carried[i]) {
+            publishSparkplugDeviceDeath(i);
+            delete[] sparkplugDevices[i].lastValues;
+        }
+    }
+
+    delete[] carried;
+    delete[] sparkplugDevices;
+    sparkplugDevices = remapped;
+    sparkplugDeviceCount = newDeviceCount;
+}
+
+void publishDeviceBirth(int slaveIndex, JsonObjectConst metrics) {
+    SparkplugDevice& device = sparkplugDevices[slaveIndex];
+    uint8_t metricCount = min((size_t)kSparkplugMaxMetrics, metrics.size());
+
+    if (device.lastValues == nullptr || device.metricCount != metricCount) {
+        delete[] device.lastValues;
+        device.lastValues = new float[metricCount];
+        device.metricCount = metricCount;
+    }
+
+    PbWriter payload;
+    beginPayload(payload);
+
+    uint8_t metricIndex = 0;
+    for (JsonPairConst kv : metrics) {
+        if (metricIndex >= metricCount) break;
+        float value = kv.value().as<float>();
+        uint64_t alias = ((uint64_t)(slaveIndex + 1) << 8) | metricIndex;
+        writeFloatMetric(payload, kv.key().c_str(), alias, value);
+        device.lastValues[metricIndex++] = value;
+    }
+
+    device.born = finishAndPublish(payload, buildSparkplugTopic("DBIRTH", slaves[slaveIndex].name.c_str()), ++sparkplugSeq);
+}
+
+void publishSparkplugDeviceData(int slaveIndex, JsonObjectConst metrics, uint64_t timestamp, uint32_t sampledAt) {
+    if (!mqttClient.connected() || slaveIndex < 0 || slaveIndex >= sparkplugDeviceCount) return;
+
+    SparkplugDevice& device = sparkplugDevices[slaveIndex];
+
+    // Metric set changed (e.g. different register count) - aliases are stale
+    if (device.born && min((size_t)kSparkplugMaxMetrics, metrics.size()) != device.metricCount) {
+        device.born = false;
+    }
+
+    if (!device.born) {
+        publishDeviceBirth(slaveIndex, metrics);
+        return;
+    }
+
+    PbWriter payload;
+    beginPayload(payload, timestamp);
+
+    // Report by exception - only aliases whose value changed since the last report
+    uint8_t metricIndex = 0;
+    uint8_t changedCount = 0;
+    for (JsonPairConst kv : metrics) {
+        if (metricIndex >= device.metricCount) break;
+        float value = kv.value().as<float>();
+
+        if (memcmp(&value, &device.lastValues[metricIndex], sizeof(float)) != 0) {
+            uint64_t alias = ((uint64_t)(slaveIndex + 1) << 8) | metricIndex;
+            writeFloatMetric(payload, nullptr, alias, value);
+            device.lastValues[metricIndex] = value;
+            changedCount++;
+        }
+        metricIndex++;
+    }
+
+    if (changedCount == 0) return;
+
+    finishAndPublish(payload, buildSparkplugTopic("DDATA", slaves[slaveIndex].name.c_str()), ++sparkplugSeq, sampledAt);
+}
+
+void publishSparkplugDeviceDeath(int slaveIndex) {
+    if (slaveIndex < 0 || slaveIndex >= sparkplugDeviceCount) return;
+
+    SparkplugDevice& device = sparkplugDevices[slaveIndex];
+    if (!device.born) return;
+    device.born = false;
+
+    if (!mqttClient.connected()) return;
+
+    PbWriter payload;
+    beginPayload(payload);
+    finishAndPublish(payload, buildSparkplugTopic("DDEATH", slaves[slaveIndex].name.c_str()), ++sparkplugSeq);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "MQTTHandler.h"
+#include "SparkplugCodec.h"
+
+// ==================== SPARKPLUG B CONSTANTS ====================
+constexpr const char* kSparkplugNamespace = "spBv1.0";
+constexpr size_t kSparkplugBufferSize = 1200;   // Largest encoded payload (DBIRTH of a 20-channel meter)
+constexpr size_t kSparkplugTopicSize = 128;
+constexpr uint8_t kSparkplugMaxMetrics = 64;    // Metrics per device, alias low byte
+
+// ==================== DEVICE STATE ====================
+
+/**
+ * @brief Per-slave Sparkplug state. Aliases are assigned in decode order on DBIRTH,
+ *        lastValues holds the values reported so far for report-by-exception.
+ */
+struct SparkplugDevice {
+    bool born;
+    uint8_t metricCount;
+    float* lastValues;
+};
+
+// ==================== EDGE NODE LIFECYCLE ====================
+bool isSparkplugEnabled();
+bool connectSparkplugSession(const char* clientId);
+void publishNodeBirth();
+void handleSparkplugCommand(const char* topic, const uint8_t* payload, unsigned int length);
+
+// ==================== DEVICE LIFECYCLE ====================
+void remapSparkplugDevices(const int* sourceIndex, int newDeviceCount);
+void publishSparkplugDeviceData(int slaveIndex, JsonObjectConst metrics, uint64_t timestamp = 0, uint32_t sampledAt = 0);
+void publishSparkplugDeviceDeath(int slaveIndex);
+
+// ==================== HELPERS ====================
+String buildSparkplugTopic(const char* messageType, const char* deviceName = nullptr);
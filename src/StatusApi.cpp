@@ -0,0 +1,155 @@
+#include "StatusApi.h"
+#include "WebServer.h"
+#include "ModBusHandler.h"
+#include <ESP8266WiFi.h>
+
+// ==================== GLOBAL VARIABLES ====================
+
+uint32_t statsVersion = 0;
+uint32_t debugVersion = 0;
+uint32_t pollingVersion = 0;
+uint32_t statusBootNonce = 0;   // Versions restart at 0 after a reboot; the nonce keeps old ETags from matching
+
+// ==================== STATE VERSIONS ====================
+
+void bumpStatusVersion(uint8_t sections) {
+    if (sections & STATUS_STATS) statsVersion++;
+    if (sections & STATUS_DEBUG) debugVersion++;
+    if (sections & STATUS_POLLING) pollingVersion++;
+}
+
+uint32_t mixHash(uint32_t hash, uint32_t value) {
+    // FNV-1a, one byte at a time
+    for (uint8_t i = 0; i < 4; i++) {
+        hash = (hash ^ (value & 0xFF)) * 16777619u;
+        value >>= 8;
+    }
+    return hash;
+}
+
+/**
+ * @brief WiFi state has no single writer to bump a counter, so the section's
+ *        version is a fingerprint of the values /getipinfo reports
+ */
+uint32_t ipFingerprint() {
+    uint32_t hash = 2166136261u;
+    hash = mixHash(hash, WiFi.status());
+    hash = mixHash(hash, isSTAConnecting());
+    hash = mixHash(hash, (uint32_t)WiFi.localIP());
+    hash = mixHash(hash, (uint32_t)WiFi.subnetMask());
+    hash = mixHash(hash, (uint32_t)WiFi.gatewayIP());
+    hash = mixHash(hash, (uint32_t)WiFi.softAPIP());
+    hash = mixHash(hash, WiFi.softAPgetStationNum());
+    return hash;
+}
+
+void formatStatusEtag(uint8_t sections, char* etag, size_t size) {
+    if (statusBootNonce == 0) {
+        statusBootNonce = ESP.random() | 1;
+    }
+
+    uint32_t hash = mixHash(2166136261u, statusBootNonce);
+    hash = mixHash(hash, sections);
+    if (sections & STATUS_IP) hash = mixHash(hash, ipFingerprint());
+    if (sections & STATUS_STATS) hash = mixHash(hash, statsVersion);
+    if (sections & STATUS_DEBUG) hash = mixHash(hash, debugVersion);
+    if (sections & STATUS_POLLING) hash = mixHash(hash, pollingVersion);
+
+    snprintf(etag, size, "\"%08x\"", hash);
+}
+
+// ==================== FIELD MASK ====================
+
+/**
+ * @brief Comma-separated section names to a mask; no list means everything
+ * @return false on an unknown section name
+ */
+bool parseStatusFields(const String& fields, uint8_t& sections) {
+    static const struct { const char* name; uint8_t bit; } kSectionNames[] = {
+        { "ip", STATUS_IP }, { "stats", STATUS_STATS }, { "debug", STATUS_DEBUG }, { "polling", STATUS_POLLING }
+    };
+
+    sections = 0;
+    if (fields.length() == 0) {
+        sections = STATUS_ALL;
+        return true;
+    }
+
+    int start = 0;
+    while (start <= (int)fields.length()) {
+        int end = fields.indexOf(',', start);
+        if (end < 0) end = fields.length();
+        String name = fields.substring(start, end);
+        name.trim();
+
+        if (name.length() > 0) {
+            bool known = false;
+            for (const auto& section : kSectionNames) {
+                if (name == section.name) {
+                    sections |= section.bit;
+                    known = true;
+                    break;
+                }
+            }
+            if (!known) return false;
+        }
+        start = end + 1;
+    }
+
+    if (sections == 0) sections = STATUS_ALL;
+    return true;
+}
+
+// ==================== STATUS ENDPOINT ====================
+
+/**
+ * @brief GET /api/status?fields=ip,stats,debug,polling - the dashboard's
+ *        sections in one round trip, with If-None-Match answered by a 304
+ */
+void handleGetStatus(AsyncWebServerRequest* request) {
+    uint8_t sections;
+    String fields = request->hasParam("fields") ? request->getParam("fields")->value() : String();
+    if (!parseStatusFields(fields, sections)) {
+        sendErrorResponse(request, "Unknown status field (use ip, stats, debug, polling)");
+        return;
+    }
+
+    char etag[12];
+    formatStatusEtag(sections, etag, sizeof(etag));
+
+    AsyncWebHeader* ifNoneMatch = request->getHeader("If-None-Match");
+    if (ifNoneMatch != nullptr && ifNoneMatch->value() == etag) {
+        AsyncWebServerResponse* response = request->beginResponse(304);
+        response->addHeader("Cache-Control", "no-cache");
+        response->addHeader("ETag", etag);
+        request->send(response);
+        return;
+    }
+
+    JsonDocument doc;
+
+    if (sections & STATUS_IP) {
+        JsonDocument ipDoc;
+        buildIpInfo(ipDoc);
+        doc["ip"] = ipDoc;
+    }
+    if (sections & STATUS_STATS) {
+        fillStatisticsArray(doc["stats"].to<JsonArray>());
+    }
+    if (sections & STATUS_DEBUG) {
+        doc["debug"]["enabled"] = debugEnabled;
+    }
+    if (sections & STATUS_POLLING) {
+        doc["polling"]["pollInterval"] = pollInterval / 1000;
+        doc["polling"]["timeout"] = timeoutDuration / 1000;
+        doc["polling"]["mode"] = getPollModeName(pollSchedule.mode);
+        doc["polling"]["align"] = pollSchedule.alignToClock;
+        doc["polling"]["enabled"] = modbusQueriesEnabled;
+    }
+
+    AsyncResponseStream* response = request->beginResponseStream("application/json");
+    response->addHeader("Cache-Control", "no-cache");
+    response->addHeader("ETag", etag);
+    serializeJson(doc, *response);
+    request->send(response);
+}
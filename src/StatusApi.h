@@ -0,0 +1,22 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+
+// ==================== STATUS SECTIONS ====================
+// Bit per section of /api/status?fields=ip,stats,debug,polling
+enum StatusSection : uint8_t {
+    STATUS_IP = 0x01,
+    STATUS_STATS = 0x02,
+    STATUS_DEBUG = 0x04,
+    STATUS_POLLING = 0x08,
+    STATUS_ALL = 0x0F
+};
+
+// ==================== STATE VERSIONS ====================
+// Producers bump their section when its content changes; the ETag is derived
+// from the versions alone, so an unchanged poll is answered without any JSON.
+void bumpStatusVersion(uint8_t sections);
+
+// ==================== STATUS ENDPOINT ====================
+void handleGetStatus(AsyncWebServerRequest* request);
@@ -0,0 +1,147 @@
+#include "TaskScheduler.h"
+#include "HealthMonitor.h"
+#include <coredecls.h>
+
+// ==================== GLOBAL VARIABLES ====================
+
+SchedulerTask tasks[kMaxTasks];     // Kept in priority order
+uint8_t taskCount = 0;
+volatile bool schedulerWoken = false;
+
+// ==================== REGISTRATION ====================
+
+bool registerTask(const SchedulerTask& task) {
+    if (taskCount >= kMaxTasks) {
+        Serial.printf("❌ Scheduler full, task %s not added\n", task.name);
+        return false;
+    }
+
+    // Insertion keeps registration order within one priority
+    uint8_t position = taskCount;
+    while (position > 0 && tasks[position - 1].priority > task.priority) {
+        tasks[position] = tasks[position - 1];
+        position--;
+    }
+    tasks[position] = task;
+    taskCount++;
+    return true;
+}
+
+bool addPeriodicTask(const char* name, TaskFunction run, TaskPriority priority, unsigned long periodMs,
+                     unsigned long budgetMicros) {
+    unsigned long now = millis();
+    return registerTask({ name, run, nullptr, priority, periodMs, budgetMicros, now, now, 0 });
+}
+
+bool addDeadlineTask(const char* name, TaskFunction run, TaskPriority priority, TaskDueFunction dueIn,
+                     unsigned long budgetMicros) {
+    unsigned long now = millis();
+    return registerTask({ name, run, dueIn, priority, 0, budgetMicros, now, now, 0 });
+}
+
+// ==================== DEADLINES ====================
+
+/**
+ * @brief Milliseconds until the task is due. Also tracks dueAt, the moment the
+ *        task became runnable, which the latency histogram is measured from.
+ */
+unsigned long msUntilDue(SchedulerTask& task, unsigned long now) {
+    if (task.dueIn == nullptr) {
+        long remaining = (long)(task.dueAt - now);
+        return remaining > 0 ? remaining : 0;
+    }
+
+    unsigned long due = task.dueIn(now);
+    if (due == kTaskNeverDue) {
+        task.dueAt = now;   // Work showing up later waited at most since this check
+    } else if (due > 0) {
+        task.dueAt = now + due;
+    } else if ((long)(task.dueAt - now) > 0) {
+        task.dueAt = now;   // Due earlier than it predicted (new work arrived)
+    }
+    return due;
+}
+
+bool highPriorityDue(unsigned long now) {
+    for (uint8_t i = 0; i < taskCount && tasks[i].priority == TASK_PRIORITY_HIGH; i++) {
+        if (msUntilDue(tasks[i], now) == 0) return true;
+    }
+    return false;
+}
+
+// ==================== EXECUTION ====================
+
+void runTask(SchedulerTask& task, unsigned long now) {
+    recordTaskLatency(now - task.dueAt);
+
+    unsigned long start = micros();
+    task.run();
+    unsigned long elapsed = micros() - start;
+
+    if (elapsed > task.budgetMicros) {
+        task.overruns++;
+        recordTaskOverrun();
+    }
+
+    task.lastRun = now;
+    if (task.dueIn == nullptr) {
+        // Fixed period; slots missed while busy are skipped rather than run back to back
+        task.dueAt += task.periodMs;
+        if ((long)(now - task.dueAt) >= 0) {
+            task.dueAt = now + task.periodMs;
+        }
+    } else {
+        task.dueAt = now;
+    }
+}
+
+void sleepUntilNextDeadline() {
+    unsigned long now = millis();
+    unsigned long sleepMs = kMaxSleepMs;
+
+    for (uint8_t i = 0; i < taskCount && sleepMs > 0; i++) {
+        unsigned long due = msUntilDue(tasks[i], now);
+        if (due < sleepMs) {
+            sleepMs = due;
+        }
+    }
+
+    if (sleepMs == 0 || schedulerWoken) {
+        yield();    // Work is pending - only let the WiFi stack run
+        return;
+    }
+
+    // Sleeps like delay() but returns within 1 ms of wakeScheduler()
+    esp_delay(sleepMs, []() { return !schedulerWoken; }, 1);
+}
+
+/**
+ * @brief One loop() pass: due tasks in priority order, then sleep until the next
+ *        deadline. Lower-priority tasks yield the rest of the pass once a
+ *        high-priority task is due again or the pass budget is spent.
+ */
+void runSchedulerPass() {
+    healthLoopBegin();
+    schedulerWoken = false;
+    unsigned long passStart = micros();
+
+    for (uint8_t i = 0; i < taskCount; i++) {
+        SchedulerTask& task = tasks[i];
+        unsigned long now = millis();
+
+        if (task.priority != TASK_PRIORITY_HIGH) {
+            if (micros() - passStart >= kPassBudgetMicros || highPriorityDue(now)) break;
+        }
+
+        if (msUntilDue(task, now) == 0) {
+            runTask(task, now);
+        }
+    }
+
+    healthLoopEnd();
+    sleepUntilNextDeadline();
+}
+
+void wakeScheduler() {
+    schedulerWoken = true;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ==================== SCHEDULER CONSTANTS ====================
+constexpr uint8_t kMaxTasks = 12;
+constexpr unsigned long kPassBudgetMicros = 20000;      // Lower-priority work waits once a pass used this
+constexpr unsigned long kMaxSleepMs = 50;               // Upper bound on one idle sleep
+constexpr unsigned long kTaskNeverDue = ~0UL;
+
+// ==================== TASK DEFINITIONS ====================
+
+enum TaskPriority : uint8_t {
+    TASK_PRIORITY_HIGH,         // Runs first; its becoming due ends the pass for the others
+    TASK_PRIORITY_NORMAL,
+    TASK_PRIORITY_LOW
+};
+
+typedef void (*TaskFunction)();
+typedef unsigned long (*TaskDueFunction)(unsigned long now);   // ms until due, 0 = now, kTaskNeverDue = idle
+
+/**
+ * @brief A task is either periodic (periodMs) or reports its own next deadline
+ *        (dueIn). Budgets are not enforced - a task cannot be interrupted - but
+ *        overruns are counted in the health report.
+ */
+struct SchedulerTask {
+    const char* name;
+    TaskFunction run;
+    TaskDueFunction dueIn;
+    TaskPriority priority;
+    unsigned long periodMs;
+    unsigned long budgetMicros;
+    unsigned long lastRun;
+    unsigned long dueAt;
+    uint32_t overruns;
+};
+
+// ==================== SCHEDULER API ====================
+bool addPeriodicTask(const char* name, TaskFunction run, TaskPriority priority, unsigned long periodMs,
+                     unsigned long budgetMicros);
+bool addDeadlineTask(const char* name, TaskFunction run, TaskPriority priority, TaskDueFunction dueIn,
+                     unsigned long budgetMicros);
+void runSchedulerPass();
+void wakeScheduler();
@@ -4,6 +4,20 @@
 
 // ==================== DEVICE TEMPLATE BUILDERS ====================
 
+/**
+ * @brief Write the built-in register map into the template, so templates.json
+ *        describes the whole device and can be copied to add a new one
+ */
+void addRegisterMap(JsonObject& templateObj, const char* deviceType) {
+    uint8_t count;
+    const RegisterField* fields = findBuiltinRegisterMap(deviceType, count);
+    
+    JsonArray registers = templateObj["registers"].to<JsonArray>();
+    for (uint8_t i = 0; i < count; i++) {
+        writeRegisterField(fields[i], registers.add<JsonObject>());
+    }
+}
+
 void addG01SConfig(JsonObject& templateObj) {
     JsonObject sensorParams = templateObj["sensor"].to<JsonObject>();
     sensorParams["tempdivider"] = 1.0;
@@ -104,6 +118,7 @@ bool createDefaultTemplates() {
     for (const auto& templateDef : templates) {
         JsonObject templateObj = templatesDoc[templateDef.name].to<JsonObject>();
         templateDef.builder(templateObj);
+        addRegisterMap(templateObj, templateDef.name);
         Serial.printf("✅ Created template: %s\n", templateDef.name);
     }
 
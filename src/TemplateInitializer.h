@@ -3,6 +3,7 @@
 #include <ArduinoJson.h>
 
 bool createDefaultTemplates();
+void addRegisterMap(JsonObject& templateObj, const char* deviceType);
 void addG01SConfig(JsonObject& templateObj); 
 void addMeterConfig(JsonObject& templateObj);
 void addVoltageConfig(JsonObject& templateObj); 
@@ -1,21 +1,37 @@
 #include "TemplateManager.h"
+#include "ConfigBlob.h"
+#include "ParamCache.h"
 
 // ==================== TEMPLATE CACHE ====================
 JsonDocument templatesCache;
 bool cacheLoaded = false;
+uint32_t templateGeneration = 0;
+
+// Flattened templates, rebuilt on first use after the cache is cleared
+CompiledTemplate* compiledTemplates = nullptr;
+uint8_t compiledTemplateCount = 0;
+ParamSlot* slotPool = nullptr;
+uint16_t slotPoolSize = 0;
+RegisterField* fieldPool = nullptr;
+uint16_t fieldPoolSize = 0;
 
 // ==================== SAFETY CONSTANTS ====================
 constexpr int MAX_RECURSION_DEPTH = 10;
 
-bool loadDeviceTemplate(const String& deviceType, JsonObject& templateConfig) {
-
-    // Load cache if not already loaded
+bool ensureTemplateCache() {
     if (!cacheLoaded) {
         if (!loadTemplates(templatesCache)) {
             return false;
         }
         cacheLoaded = true;
     }
+    return true;
+}
+
+bool loadDeviceTemplate(const String& deviceType, JsonObject& templateConfig) {
+    if (!ensureTemplateCache()) {
+        return false;
+    }
     
     if (templatesCache[deviceType].is<JsonObject>()) {
         templateConfig.set(templatesCache[deviceType]);
@@ -25,93 +41,360 @@ bool loadDeviceTemplate(const String& deviceType, JsonObject& templateConfig) {
     return false;
 }
 
-bool mergeWithOverride(JsonObject& slaveConfig, const JsonObject& templateConfig, JsonObject& output) {
-    output.set(templateConfig);
-    
-    if (slaveConfig["override"].is<JsonObject>()) {
-        JsonObject overrideObj = slaveConfig["override"];
-        deepMerge(overrideObj, output);
+// ==================== PARAMETER PATHS ====================
+
+bool samePath(const char* const* a, const char* const* b) {
+    for (uint8_t level = 0; level < kMaxParamDepth; level++) {
+        if (a[level] == nullptr || b[level] == nullptr) return a[level] == b[level];
+        if (strcmp(a[level], b[level]) != 0) return false;
     }
-    
     return true;
 }
 
-// ✅ CLEAN: Single function, no useless wrapper
-void detectOverrides(const JsonObject& currentConfig, const JsonObject& templateConfig, JsonObject& overrideOutput, int depth) {
-    // ✅ Safety check built in
-    if (depth > MAX_RECURSION_DEPTH) {
-        Serial.println("⚠️  Max recursion depth reached in detectOverrides!");
-        return;
+int findParamSlot(const CompiledTemplate& tmpl, const char* const* path) {
+    for (uint8_t i = 0; i < tmpl.slotCount; i++) {
+        if (samePath(slotPool[tmpl.firstSlot + i].path, path)) return i;
     }
+    return -1;
+}
+
+/**
+ * @brief Object at path[0..depth) under root, created as needed
+ */
+JsonObject pathObject(JsonObject root, const char* const* path, uint8_t depth) {
+    JsonObject node = root;
+    for (uint8_t level = 0; level < depth; level++) {
+        node = node[path[level]].is<JsonObject>() ? node[path[level]].as<JsonObject>()
+                                                  : node[path[level]].to<JsonObject>();
+    }
+    return node;
+}
+
+/**
+ * @brief Call visit(path, depth, leaf) for every non-object value up to kMaxParamDepth
+ *        deep. Deeper objects are handed over whole.
+ */
+template <typename Visitor>
+void walkParamLeaves(JsonObjectConst node, const char** path, uint8_t depth, Visitor& visit) {
+    for (JsonPairConst kv : node) {
+        path[depth] = kv.key().c_str();
+        if (kv.value().is<JsonObjectConst>() && depth + 1 < kMaxParamDepth) {
+            walkParamLeaves(kv.value().as<JsonObjectConst>(), path, depth + 1, visit);
+        } else {
+            visit(path, depth + 1, kv.value());
+        }
+        path[depth] = nullptr;
+    }
+}
+
+// ==================== TEMPLATE COMPILATION ====================
+
+size_t countParamLeaves(JsonObjectConst node, uint8_t depth) {
+    size_t count = 0;
+    for (JsonPairConst kv : node) {
+        if (kv.value().is<JsonObjectConst>() && depth + 1 < kMaxParamDepth) {
+            count += countParamLeaves(kv.value().as<JsonObjectConst>(), depth + 1);
+        } else {
+            count++;
+        }
+    }
+    return count;
+}
+
+void freeCompiledTemplates() {
+    forgetParamKeys();
+    delete[] compiledTemplates;
+    delete[] slotPool;
+    delete[] fieldPool;
+    compiledTemplates = nullptr;
+    slotPool = nullptr;
+    fieldPool = nullptr;
+    compiledTemplateCount = 0;
+    slotPoolSize = 0;
+    fieldPoolSize = 0;
+}
+
+// ==================== REGISTER MAPS ====================
+
+/**
+ * @brief A template's own "registers" array, or the built-in map for its name when
+ *        it has none (templates saved before maps lived in templates.json)
+ */
+size_t countRegisterFields(const char* deviceType, JsonObjectConst templateObj) {
+    if (templateObj["registers"].is<JsonArrayConst>()) {
+        return min(templateObj["registers"].size(), (size_t)kMaxRegisterFields);
+    }
+    uint8_t count;
+    findBuiltinRegisterMap(deviceType, count);
+    return count;
+}
+
+uint8_t loadRegisterFields(const char* deviceType, JsonObjectConst templateObj, RegisterField* fields) {
+    uint8_t count = 0;
     
-    for (JsonPair kv : currentConfig) {
-        const char* key = kv.key().c_str();
-        JsonVariant currentValue = kv.value();
-        
-        if (templateConfig[key].isNull() == false) {
-            JsonVariant templateValue = templateConfig[key];
-            
-            if (currentValue.is<JsonObject>() && templateValue.is<JsonObject>()) {
-                JsonObject currentObj = currentValue.as<JsonObject>();
-                JsonObject templateObj = templateValue.as<JsonObject>();
-                JsonObject overrideObj = overrideOutput[key].to<JsonObject>();
-                
-                // ✅ Direct recursive call with depth+1
-                detectOverrides(currentObj, templateObj, overrideObj, depth + 1);
-                
-                if (overrideObj.size() == 0) {
-                    overrideOutput.remove(key);
-                }
-                
+    if (templateObj["registers"].is<JsonArrayConst>()) {
+        for (JsonObjectConst entry : templateObj["registers"].as<JsonArrayConst>()) {
+            if (count >= kMaxRegisterFields) break;
+            if (parseRegisterField(entry, fields[count])) {
+                count++;
             } else {
-                if (!deepCompare(currentValue, templateValue)) {
-                    overrideOutput[key].set(currentValue);
-                }
+                Serial.printf("⚠️  %s: skipping invalid register entry\n", deviceType);
             }
-        } else {
-            overrideOutput[key].set(currentValue);
         }
+        return count;
     }
+    
+    const RegisterField* builtin = findBuiltinRegisterMap(deviceType, count);
+    memcpy(fields, builtin, count * sizeof(RegisterField));
+    return count;
 }
 
-// ✅ CLEAN: Single function, no useless wrapper
-bool deepCompare(const JsonVariant& a, const JsonVariant& b, int depth) {
-    // ✅ Safety check built in
-    if (depth > MAX_RECURSION_DEPTH) {
-        Serial.println("⚠️  Max recursion depth reached in deepCompare!");
+/**
+ * @brief Give every divider the map reads a bound slot. Fields naming the same path
+ *        share one DeviceParams value; a divider the template does not set is 1.
+ */
+void bindRegisterDividers(CompiledTemplate& tmpl) {
+    uint8_t paramCount = 0;
+    
+    for (uint8_t i = 0; i < tmpl.fieldCount; i++) {
+        RegisterField& field = fieldPool[tmpl.firstField + i];
+        field.param = kNoDecodeParam;
+        if (field.divider[0] == nullptr) continue;
+        
+        int index = findParamSlot(tmpl, field.divider);
+        if (index < 0) {
+            if (tmpl.slotCount >= kMaxParamSlots || paramCount >= kMaxDecodeParams) {
+                Serial.printf("⚠️  %s: too many dividers, %s is not divided\n", tmpl.deviceType, field.name);
+                continue;
+            }
+            index = tmpl.slotCount++;
+            ParamSlot& slot = slotPool[tmpl.firstSlot + index];
+            memcpy(slot.path, field.divider, sizeof(slot.path));
+            slot.configOffset = paramCount++ * sizeof(float);
+            slot.inTemplate = false;
+            slot.value = 1.0f;
+        }
+        field.param = slotPool[tmpl.firstSlot + index].configOffset / sizeof(float);
+    }
+}
+
+/**
+ * @brief Check a template before it is saved, so a typo is reported instead of
+ *        silently dropping outputs at load
+ */
+bool validateTemplate(JsonObjectConst templateObj, String& error) {
+    if (templateObj.isNull()) {
+        error = "Template must be an object";
+        return false;
+    }
+    if (templateObj["registers"].isNull()) return true;
+    
+    JsonArrayConst registers = templateObj["registers"];
+    if (registers.isNull() || registers.size() == 0 || registers.size() > kMaxRegisterFields) {
+        error = String("registers must be an array of 1-") + kMaxRegisterFields + " entries";
         return false;
     }
     
-    if (a.is<JsonObject>() && b.is<JsonObject>()) {
-        JsonObject objA = a.as<JsonObject>();
-        JsonObject objB = b.as<JsonObject>();
+    const char* dividers[kMaxDecodeParams][kMaxParamDepth];
+    uint8_t dividerCount = 0;
+    size_t index = 0;
+    for (JsonVariantConst entry : registers) {
+        RegisterField field;
+        if (!parseRegisterField(entry.as<JsonObjectConst>(), field)) {
+            error = String("Invalid register entry ") + index;
+            return false;
+        }
+        index++;
+        if (field.divider[0] == nullptr) continue;
+        
+        bool known = false;
+        for (uint8_t i = 0; i < dividerCount && !known; i++) known = samePath(dividers[i], field.divider);
+        if (known) continue;
+        if (dividerCount == kMaxDecodeParams) {
+            error = String("At most ") + kMaxDecodeParams + " distinct dividers per template";
+            return false;
+        }
+        memcpy(dividers[dividerCount++], field.divider, sizeof(field.divider));
+    }
+    return true;
+}
+
+// ==================== TEMPLATE COMPILATION ====================
+
+/**
+ * @brief Flatten every template once: its register map, a bound slot for each
+ *        divider the map reads (so unset ones still get their default), then the
+ *        template's own numeric leaves, matched onto those slots or appended as
+ *        unbound slots. Keys and names point into the template cache, which stays
+ *        resident.
+ */
+bool compileTemplates() {
+    if (compiledTemplates != nullptr) return true;
+    if (!ensureTemplateCache()) return false;
+    
+    JsonObjectConst root = templatesCache.as<JsonObjectConst>();
+    size_t templateCount = 0;
+    size_t capacity = 0;
+    size_t fieldCapacity = 0;
+    for (JsonPairConst kv : root) {
+        if (!kv.value().is<JsonObjectConst>()) continue;
+        size_t fieldCount = countRegisterFields(kv.key().c_str(), kv.value().as<JsonObjectConst>());
+        capacity += min(countParamLeaves(kv.value().as<JsonObjectConst>(), 0) + fieldCount, (size_t)kMaxParamSlots);
+        fieldCapacity += fieldCount;
+        templateCount++;
+    }
+    
+    compiledTemplates = new CompiledTemplate[templateCount];
+    slotPool = new ParamSlot[capacity];
+    fieldPool = new RegisterField[fieldCapacity];
+    
+    for (JsonPairConst kv : root) {
+        if (!kv.value().is<JsonObjectConst>()) continue;
         
-        if (objA.size() != objB.size()) return false;
+        CompiledTemplate& tmpl = compiledTemplates[compiledTemplateCount++];
+        tmpl.deviceType = kv.key().c_str();
+        tmpl.firstSlot = slotPoolSize;
+        tmpl.slotCount = 0;
+        tmpl.firstField = fieldPoolSize;
+        tmpl.fieldCount = loadRegisterFields(tmpl.deviceType, kv.value().as<JsonObjectConst>(),
+                                             fieldPool + tmpl.firstField);
+        fieldPoolSize += tmpl.fieldCount;
+        bindRegisterDividers(tmpl);
         
-        for (JsonPair kv : objA) {
-            const char* key = kv.key().c_str();
-            if (objB[key].isNull() || !deepCompare(kv.value(), objB[key], depth + 1)) {
-                return false;
+        const char* path[kMaxParamDepth] = {};
+        auto addLeaf = [&tmpl](const char* const* leafPath, uint8_t depth, JsonVariantConst leaf) {
+            if (!leaf.is<float>()) return;
+            int index = findParamSlot(tmpl, leafPath);
+            if (index < 0) {
+                if (tmpl.slotCount >= kMaxParamSlots) return;
+                index = tmpl.slotCount++;
+                ParamSlot& added = slotPool[tmpl.firstSlot + index];
+                for (uint8_t level = 0; level < kMaxParamDepth; level++) {
+                    added.path[level] = (level < depth) ? leafPath[level] : nullptr;
+                }
+                added.configOffset = -1;
             }
+            slotPool[tmpl.firstSlot + index].inTemplate = true;
+            slotPool[tmpl.firstSlot + index].value = leaf.as<float>();
+        };
+        walkParamLeaves(kv.value().as<JsonObjectConst>(), path, 0, addLeaf);
+        
+        slotPoolSize += tmpl.slotCount;
+    }
+    
+    Serial.printf("✅ Compiled %d templates into %d parameter slots, %d register fields\n",
+                  compiledTemplateCount, slotPoolSize, fieldPoolSize);
+    return true;
+}
+
+const CompiledTemplate* findCompiledTemplate(const char* deviceType) {
+    if (deviceType == nullptr || !compileTemplates()) return nullptr;
+    
+    for (uint8_t i = 0; i < compiledTemplateCount; i++) {
+        if (strcmp(compiledTemplates[i].deviceType, deviceType) == 0) {
+            return &compiledTemplates[i];
         }
-        return true;
     }
+    return nullptr;
+}
+
+const RegisterField* getRegisterFields(const CompiledTemplate& tmpl) {
+    return fieldPool + tmpl.firstField;
+}
+
+// ==================== OVERRIDE PATCHES ====================
+
+/**
+ * @brief Turn a stored override object into (slot, value) pairs. Values for paths
+ *        the template has no slot for are ignored, as the decoder never read them.
+ */
+uint8_t compileOverridePatches(const CompiledTemplate& tmpl, JsonObjectConst overrideObj, ParamPatch* patches) {
+    uint8_t patchCount = 0;
+    if (overrideObj.isNull()) return 0;
+    
+    const char* path[kMaxParamDepth] = {};
+    auto addPatch = [&](const char* const* leafPath, uint8_t depth, JsonVariantConst leaf) {
+        if (!leaf.is<float>() || patchCount >= kMaxParamSlots) return;
+        int index = findParamSlot(tmpl, leafPath);
+        if (index >= 0) {
+            patches[patchCount++] = { (uint8_t)index, leaf.as<float>() };
+        }
+    };
+    walkParamLeaves(overrideObj, path, 0, addPatch);
+    return patchCount;
+}
+
+float resolvedSlotValue(const CompiledTemplate& tmpl, uint8_t index, const ParamPatch* patches, uint8_t patchCount,
+                        bool& patched) {
+    for (uint8_t p = 0; p < patchCount; p++) {
+        if (patches[p].slot == index) {
+            patched = true;
+            return patches[p].value;
+        }
+    }
+    patched = false;
+    return slotPool[tmpl.firstSlot + index].value;
+}
+
+/**
+ * @brief Write the template values, with patches applied, into a slave's parameter block
+ */
+void applyParamPatches(const CompiledTemplate& tmpl, const ParamPatch* patches, uint8_t patchCount,
+                       void* config, size_t configSize) {
+    uint8_t* bytes = static_cast<uint8_t*>(config);
+    memset(bytes, 0, configSize);
     
-    if (a.is<JsonArray>() && b.is<JsonArray>()) {
-        JsonArray arrA = a.as<JsonArray>();
-        JsonArray arrB = b.as<JsonArray>();
+    for (uint8_t i = 0; i < tmpl.slotCount; i++) {
+        const ParamSlot& slot = slotPool[tmpl.firstSlot + i];
+        if (slot.configOffset < 0 || slot.configOffset + sizeof(float) > configSize) continue;
         
-        if (arrA.size() != arrB.size()) return false;
+        bool patched;
+        float value = resolvedSlotValue(tmpl, i, patches, patchCount, patched);
+        memcpy(bytes + slot.configOffset, &value, sizeof(float));
+    }
+}
+
+/**
+ * @brief Merged view for the UI: every template parameter plus the patched ones
+ */
+void writeResolvedParams(const CompiledTemplate& tmpl, const ParamPatch* patches, uint8_t patchCount,
+                         JsonObject output) {
+    for (uint8_t i = 0; i < tmpl.slotCount; i++) {
+        const ParamSlot& slot = slotPool[tmpl.firstSlot + i];
+        bool patched;
+        float value = resolvedSlotValue(tmpl, i, patches, patchCount, patched);
+        if (!slot.inTemplate && !patched) continue;
         
-        for (size_t i = 0; i < arrA.size(); i++) {
-            if (!deepCompare(arrA[i], arrB[i], depth + 1)) {
-                return false;
-            }
+        uint8_t depth = 1;
+        while (depth < kMaxParamDepth && slot.path[depth] != nullptr) {
+            depth++;
         }
-        return true;
+        pathObject(output, slot.path, depth - 1)[slot.path[depth - 1]] = value;
     }
+}
+
+/**
+ * @brief Keep only what differs from the template. Parameter groups are the object
+ *        members of params; scalar members (id, name, ...) are not parameters.
+ */
+void detectOverridePatches(const CompiledTemplate& tmpl, JsonObjectConst params, JsonObject overrideOutput) {
+    const char* path[kMaxParamDepth] = {};
+    auto compareLeaf = [&](const char* const* leafPath, uint8_t depth, JsonVariantConst leaf) {
+        if (leaf.is<float>()) {
+            int index = findParamSlot(tmpl, leafPath);
+            if (index >= 0) {
+                const ParamSlot& slot = slotPool[tmpl.firstSlot + index];
+                if (slot.inTemplate && slot.value == leaf.as<float>()) return;
+            }
+        }
+        pathObject(overrideOutput, leafPath, depth - 1)[leafPath[depth - 1]].set(leaf);
+    };
     
-    return a == b;
+    for (JsonPairConst kv : params) {
+        if (!kv.value().is<JsonObjectConst>()) continue;
+        path[0] = kv.key().c_str();
+        walkParamLeaves(kv.value().as<JsonObjectConst>(), path, 1, compareLeaf);
+    }
 }
 
 // ✅ CLEAN: Single function, no useless wrapper
@@ -140,6 +423,7 @@ bool saveTemplates(const JsonDocument& templates) {
     serializeJson(templates, jsonString);
     
     clearTemplateCache();
+    invalidateConfigBlob();
     
     return writeFile("/templates.json", jsonString);
 }
@@ -160,7 +444,13 @@ bool loadTemplates(JsonDocument& templates) {
     return !error;
 }
 
+uint32_t getTemplateGeneration() {
+    return templateGeneration;
+}
+
 void clearTemplateCache() {
+    templateGeneration++;
+    freeCompiledTemplates();
     cacheLoaded = false;
     templatesCache.clear();
     Serial.println("✅ Template cache cleared");
@@ -3,16 +3,59 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include "FSHandler.h"
+#include "RegisterMap.h"
+
+// ==================== COMPILED TEMPLATE CONSTANTS ====================
+constexpr uint8_t kMaxParamSlots = 24;      // Per template, and so per slave override
+
+// ==================== COMPILED TEMPLATES ====================
+
+/**
+ * @brief One template parameter, addressed by its key path. Bound slots are the
+ *        dividers the register map reads (a float in DeviceParams); unbound ones
+ *        only round-trip to the UI.
+ */
+struct ParamSlot {
+    const char* path[kMaxParamDepth];   // nullptr-padded
+    int16_t configOffset;               // -1 = not decoded by the firmware
+    bool inTemplate;                    // false = bound parameter the template leaves at its default
+    float value;
+};
+
+struct CompiledTemplate {
+    const char* deviceType;
+    uint16_t firstSlot;
+    uint8_t slotCount;
+    uint16_t firstField;        // Register map, from "registers" or the built-in map
+    uint8_t fieldCount;
+};
+
+/**
+ * @brief A slave's override, reduced to the slots it changes
+ */
+struct ParamPatch {
+    uint8_t slot;
+    float value;
+};
 
 // Template management functions
 bool loadDeviceTemplate(const String& deviceType, JsonObject& templateConfig);
-bool mergeWithOverride(JsonObject& slaveConfig, const JsonObject& templateConfig, JsonObject& output);
-void detectOverrides(const JsonObject& currentConfig, const JsonObject& templateConfig, JsonObject& overrideOutput, int depth = 0);
 bool saveTemplates(const JsonDocument& templates);
 bool loadTemplates(JsonDocument& templates);
 
+// Override patches - linear passes over the compiled slots, no JSON merging
+const CompiledTemplate* findCompiledTemplate(const char* deviceType);
+const RegisterField* getRegisterFields(const CompiledTemplate& tmpl);
+bool validateTemplate(JsonObjectConst templateObj, String& error);
+uint8_t compileOverridePatches(const CompiledTemplate& tmpl, JsonObjectConst overrideObj, ParamPatch* patches);
+void applyParamPatches(const CompiledTemplate& tmpl, const ParamPatch* patches, uint8_t patchCount,
+                       void* config, size_t configSize);
+void writeResolvedParams(const CompiledTemplate& tmpl, const ParamPatch* patches, uint8_t patchCount,
+                         JsonObject output);
+void detectOverridePatches(const CompiledTemplate& tmpl, JsonObjectConst params, JsonObject overrideOutput);
+
 // Internal helper functions  
-bool deepCompare(const JsonVariant& a, const JsonVariant& b, int depth = 0);
 void deepMerge(const JsonObject& source, JsonObject& dest, int depth = 0); 
 
-void clearTemplateCache();
\ No newline at end of file
+void clearTemplateCache();
+uint32_t getTemplateGeneration();       // Changes whenever compiled templates are dropped
\ No newline at end of file
@@ -0,0 +1,66 @@
+#include "TimeSync.h"
+#include <coredecls.h>
+#include <time.h>
+
+// ==================== GLOBAL VARIABLES ====================
+
+TimeConfig timeConfig = { "pool.ntp.org" };
+char ntpServer[48] = "";        // SNTP keeps the pointer, so the name lives here
+bool timeSynced = false;
+unsigned long lastTimeSync = 0;
+
+// ==================== SNTP ====================
+
+void initTimeSync(const char* server) {
+    if (server == nullptr || server[0] == '\0') {
+        server = kDefaultNtpServer;
+    }
+    if (strcmp(server, ntpServer) == 0) return;
+
+    static bool callbackInstalled = false;
+    if (!callbackInstalled) {
+        settimeofday_cb([](bool fromSntp) {
+            if (!fromSntp) return;
+            if (!timeSynced) {
+                Serial.printf("🕒 Clock synced via SNTP: %lu\n", (unsigned long)time(nullptr));
+            }
+            timeSynced = true;
+            lastTimeSync = millis();
+        });
+        callbackInstalled = true;
+    }
+
+    strlcpy(ntpServer, server, sizeof(ntpServer));
+    configTime(0, 0, ntpServer);
+    Serial.printf("🕒 SNTP server: %s\n", ntpServer);
+}
+
+bool isTimeSynced() {
+    return timeSynced;
+}
+
+/**
+ * @brief Seconds since the last SNTP update, 0 before the first one
+ */
+unsigned long getTimeSyncAge() {
+    return timeSynced ? (millis() - lastTimeSync) / 1000 : 0;
+}
+
+/**
+ * @brief Decimal text for a 64-bit value. The core's newlib-nano printf does not
+ *        handle %llu, so the value is printed as two 32-bit halves split at 10^9.
+ */
+void formatUint64(uint64_t value, char* out, size_t size) {
+    constexpr uint32_t kSplit = 1000000000UL;
+    uint64_t high = value / kSplit;
+    uint32_t low = value % kSplit;
+    
+    if (high == 0) {
+        snprintf(out, size, "%lu", (unsigned long)low);
+    } else if (high < kSplit) {
+        snprintf(out, size, "%lu%09lu", (unsigned long)high, (unsigned long)low);
+    } else {
+        snprintf(out, size, "%lu%09lu%09lu", (unsigned long)(high / kSplit), (unsigned long)(high % kSplit),
+                 (unsigned long)low);
+    }
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ==================== TIME SYNC CONSTANTS ====================
+constexpr const char* kDefaultNtpServer = "pool.ntp.org";
+constexpr time_t kMinValidEpoch = 1600000000;   // Wall clock considered set after this
+
+/**
+ * @brief Clock options stored in /time.json
+ */
+struct TimeConfig {
+    char ntpServer[48];         // Source of sample timestamps
+};
+
+extern TimeConfig timeConfig;
+
+// ==================== SNTP ====================
+// The core's SNTP client keeps the system clock on UTC and resyncs on its own;
+// getTimestampMillis() reads that clock once it holds a plausible epoch.
+void initTimeSync(const char* server);
+bool isTimeSynced();
+unsigned long getTimeSyncAge();
+void formatUint64(uint64_t value, char* out, size_t size);
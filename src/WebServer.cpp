@@ -1,14 +1,29 @@
 #include "WebServer.h"
+#include "PublishQueue.h"
+#include "EventStream.h"
+#include "HealthMonitor.h"
+#include "DebugRing.h"
+#include "ConfigStore.h"
+#include "StatusApi.h"
+#include "HistoryStore.h"
+#include "SampleArchive.h"
+#include "TaskScheduler.h"
+#include "TimeSync.h"
+#include <sys/time.h>
+#include <memory>
 
 // ==================== CONSTANTS ====================
 
-constexpr int kMaxDebugMessages = 10;
 constexpr int kWebServerPort = 80;
 constexpr int kMaxDevices = 9;
+constexpr const char* kAssetDir = "/www";        // Gzipped, content-hashed assets (scripts/build_web_assets.py)
+constexpr uint8_t kMaxStaticAssets = 24;
+constexpr size_t kMaxRequestBody = 8192;         // JSON bodies are buffered whole
+constexpr size_t kMaxSlavesUpload = 65536;       // /saveslaves is streamed to flash instead
 
 // ==================== GLOBAL VARIABLES ====================
 
-ESP8266WebServer server(kWebServerPort);
+AsyncWebServer server(kWebServerPort);
 bool debugEnabled = false;
 bool modbusQueriesEnabled = false; 
 
@@ -18,9 +33,18 @@ unsigned long systemStartTime = 0;
 DeviceTiming deviceTiming[kMaxDevices];
 uint8_t deviceTimeCount = 0;
 
-String debugMessages[kMaxDebugMessages];
-int debugMessageCount = 0;
-int debugMessageIndex = 0;
+StaticAsset staticAssets[kMaxStaticAssets];
+uint8_t staticAssetCount = 0;
+
+// /saveslaves body being written to kSlavesUploadPath
+File slavesUpload;
+AsyncWebServerRequest* slavesUploadOwner = nullptr;
+bool slavesUploadComplete = false;
+
+// Requests handed from the network callbacks to loop()
+DeferredRequest deferredRequests[kMaxDeferredRequests];
+uint8_t deferredHead = 0;
+uint8_t deferredCount = 0;
 
 // ==================== HELPER FUNCTIONS ====================
 
@@ -29,14 +53,221 @@ void copyWifiParam(char* dest, const String& src, size_t maxLen) {
     dest[maxLen - 1] = '\0';
 }
 
-void sendJsonResponse(const JsonDocument& doc) {
+void sendJsonResponse(AsyncWebServerRequest* request, const JsonDocument& doc) {
     String response;
     serializeJson(doc, response);
-    server.send(200, "application/json", response);
+    request->send(200, "application/json", response);
+}
+
+void sendErrorResponse(AsyncWebServerRequest* request, const char* message) {
+    request->send(400, "application/json", "{\"status\":\"error\",\"message\":\"" + String(message) + "\"}");
+}
+
+// ==================== REQUEST BODY & DEFERRAL ====================
+
+/**
+ * @brief Body callback: collects the (JSON) body into request->_tempObject,
+ *        which the server frees with the request
+ */
+void collectRequestBody(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) {
+    if (total > kMaxRequestBody) return;   // Left empty - parseJsonBody reports it
+    
+    if (index == 0) {
+        request->_tempObject = malloc(total + 1);
+    }
+    if (request->_tempObject == nullptr) return;
+    
+    char* body = static_cast<char*>(request->_tempObject);
+    memcpy(body + index, data, len);
+    if (index + len == total) {
+        body[total] = '\0';
+    }
+}
+
+/**
+ * @brief Drop the /saveslaves upload if this request owns it. A request that was
+ *        superseded leaves the newer upload's file alone.
+ */
+void releaseSlavesUpload(AsyncWebServerRequest* request) {
+    if (request == nullptr || request != slavesUploadOwner) return;
+    if (slavesUpload) slavesUpload.close();
+    LittleFS.remove(kSlavesUploadPath);
+    slavesUploadOwner = nullptr;
+    slavesUploadComplete = false;
+}
+
+/**
+ * @brief Body callback for /saveslaves: chunks go straight to a temp file, so the
+ *        upload size is bounded by flash rather than heap. The only flash write in
+ *        the network callback. It is safe because the callback runs on the same
+ *        core when loop() yields, never inside a LittleFS call (those do not
+ *        yield). The file is also touched by nothing else until the deferred
+ *        handler reads it.
+ */
+void streamSlavesUpload(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) {
+    if (index == 0) {
+        // A newer upload supersedes one that never finished
+        releaseSlavesUpload(slavesUploadOwner);
+        slavesUploadOwner = request;
+        slavesUploadComplete = false;
+        
+        // Client gone mid-upload; redeferRequest() takes over once the body is in
+        request->onDisconnect([request]() { releaseSlavesUpload(request); });
+        
+        if (total > kMaxSlavesUpload) return;
+        slavesUpload = LittleFS.open(kSlavesUploadPath, "w");
+    }
+    if (request != slavesUploadOwner || !slavesUpload) return;
+    
+    if (slavesUpload.write(data, len) != len) {
+        slavesUpload.close();
+        return;
+    }
+    if (index + len == total) {
+        slavesUpload.close();
+        slavesUploadComplete = true;
+    }
+}
+
+bool parseJsonBody(AsyncWebServerRequest* request, JsonDocument& doc) {
+    const char* body = static_cast<const char*>(request->_tempObject);
+    if (body == nullptr) {
+        sendErrorResponse(request, "Empty or oversized request body");
+        return false;
+    }
+    
+    DeserializationError error = deserializeJson(doc, body);
+    if (error) {
+        Serial.printf("❌ JSON parsing failed: %s\n", error.c_str());
+        sendErrorResponse(request, "Invalid JSON");
+        return false;
+    }
+    return true;
+}
+
+void deferRequest(AsyncWebServerRequest* request, DeferredHandler handler) {
+    recordWebRequest(true);
+    redeferRequest(request, handler);
+}
+
+/**
+ * @brief Put a deferred request back at the end of the queue, e.g. until the
+ *        slave it touches has finished its bus transaction
+ */
+void redeferRequest(AsyncWebServerRequest* request, DeferredHandler handler) {
+    if (deferredCount >= kMaxDeferredRequests) {
+        request->send(503, "application/json", "{\"status\":\"error\",\"message\":\"Busy - try again\"}");
+        return;
+    }
+    
+    uint8_t slot = (deferredHead + deferredCount) % kMaxDeferredRequests;
+    deferredRequests[slot] = { request, handler };
+    deferredCount++;
+    wakeScheduler();
+    
+    // Client gone before loop() got to it - the request object is freed by the server
+    request->onDisconnect([slot, request]() {
+        if (deferredRequests[slot].request == request) {
+            deferredRequests[slot].request = nullptr;
+        }
+        releaseSlavesUpload(request);   // No-op unless it carried a /saveslaves body
+    });
+}
+
+bool hasDeferredRequests() {
+    return deferredCount > 0;
+}
+
+void serviceDeferredRequests() {
+    if (deferredCount == 0) return;
+    
+    DeferredRequest job = deferredRequests[deferredHead];
+    deferredRequests[deferredHead].request = nullptr;
+    deferredHead = (deferredHead + 1) % kMaxDeferredRequests;
+    deferredCount--;
+    
+    if (job.request != nullptr) {
+        job.handler(job.request);
+    }
+}
+
+// ==================== STREAMED RESPONSES ====================
+
+/**
+ * @brief Chunked JSON array built one record at a time; heap use is one
+ *        record plus the TCP chunk, whatever the number of records
+ */
+void sendJsonArrayStream(AsyncWebServerRequest* request, JsonRecordSource source, void (*onComplete)()) {
+    struct StreamState {
+        size_t index = 0;
+        size_t offset = 0;
+        bool started = false;
+        bool hasRecord = false;
+        bool finished = false;
+        String record;
+    };
+    auto state = std::make_shared<StreamState>();
+    
+    AsyncWebServerResponse* response = request->beginChunkedResponse("application/json",
+        [state, source, onComplete](uint8_t* buffer, size_t maxLen, size_t) -> size_t {
+            size_t written = 0;
+            
+            if (!state->started && maxLen > 0) {
+                buffer[written++] = '[';
+                state->started = true;
+            }
+            
+            // Returning 0 ends the response, so write at least one byte until done
+            while (written < maxLen && !state->finished) {
+                if (!state->hasRecord) {
+                    state->record = "";
+                    state->offset = 0;
+                    if (!source(state->index, state->record)) {
+                        buffer[written++] = ']';
+                        state->finished = true;
+                        if (onComplete != nullptr) onComplete();
+                        break;
+                    }
+                    if (state->record.length() == 0) {
+                        // Nothing ready yet; the server asks again on its next poll
+                        return written > 0 ? written : RESPONSE_TRY_AGAIN;
+                    }
+                    state->hasRecord = true;
+                    
+                    if (state->index > 0) {
+                        buffer[written++] = ',';
+                        continue;
+                    }
+                }
+                
+                size_t chunk = std::min<size_t>(maxLen - written, state->record.length() - state->offset);
+                memcpy(buffer + written, state->record.c_str() + state->offset, chunk);
+                written += chunk;
+                state->offset += chunk;
+                
+                if (state->offset >= state->record.length()) {
+                    state->hasRecord = false;
+                    state->record = "";
+                    state->index++;
+                }
+            }
+            return written;
+        });
+    request->send(response);
+}
+
+void onImmediate(const char* uri, WebRequestMethodComposite method, ArRequestHandlerFunction handler) {
+    server.on(uri, method, [handler](AsyncWebServerRequest* request) {
+        recordWebRequest(false);
+        handler(request);
+    }, nullptr, collectRequestBody);
 }
 
-void sendErrorResponse(const char* message) {
-    server.send(400, "application/json", "{\"status\":\"error\",\"message\":\"" + String(message) + "\"}");
+void onDeferred(const char* uri, WebRequestMethodComposite method, DeferredHandler handler,
+                ArBodyHandlerFunction bodyHandler = collectRequestBody) {
+    server.on(uri, method, [handler](AsyncWebServerRequest* request) {
+        deferRequest(request, handler);
+    }, nullptr, bodyHandler);
 }
 
 // ==================== WEB SERVER INITIALIZATION ====================
@@ -53,99 +284,84 @@ void setupWebServer() {
     }
     
     systemStartTime = millis();
-    
+    loadStaticAssets();
+    
+    // Immediate handlers run in the network callback and only touch RAM.
+    // Anything that writes flash, reads config files or drives the Modbus
+    // engine is deferred to loop() so it runs between bus transactions.
+    // One exception: streamSlavesUpload() writes the /saveslaves body to its
+    // own temp file as chunks arrive, since the body may not fit in heap. See
+    // there for why that is safe.
     server.onNotFound(handleStaticFiles);
-    server.on("/", []() { serveHtmlFile("/index.html"); });
+    server.on("/", HTTP_GET, [](AsyncWebServerRequest* request) { serveStaticPath(request, "/index.html"); });
     
     // WiFi endpoints
-    server.on("/savewifi", HTTP_POST, handleSaveWifi);
-    server.on("/getwifi", HTTP_GET, handleGetWifi);
-    server.on("/getipinfo", HTTP_GET, handleGetIpInfo);
-    server.on("/controlsta", HTTP_POST, handleControlSTA);
+    onDeferred("/savewifi", HTTP_POST, handleSaveWifi);
+    onImmediate("/getwifi", HTTP_GET, handleGetWifi);
+    onImmediate("/getipinfo", HTTP_GET, handleGetIpInfo);
+    onDeferred("/controlsta", HTTP_POST, handleControlSTA);
     
     // Slave endpoints
-    server.on("/saveslaves", HTTP_POST, handleSaveSlaves);
-    server.on("/getslaves", HTTP_GET, handleGetSlaves);
-    server.on("/getslaveconfig", HTTP_POST, handleGetSlaveConfig);
-    server.on("/updateslaveconfig", HTTP_POST, handleUpdateSlaveConfig);
+    onDeferred("/saveslaves", HTTP_POST, handleSaveSlaves, streamSlavesUpload);
+    onDeferred("/getslaves", HTTP_GET, handleGetSlaves);
+    onDeferred("/getslaveconfig", HTTP_POST, handleGetSlaveConfig);
+    onDeferred("/updateslaveconfig", HTTP_POST, handleUpdateSlaveConfig);
+    onDeferred("/patchslave", HTTP_PATCH | HTTP_POST, handlePatchSlave);
+    onDeferred("/gettemplates", HTTP_GET, handleGetTemplates);
+    onDeferred("/savetemplate", HTTP_POST, handleSaveTemplate);
     
     // Configuration endpoints
-    server.on("/savepollingconfig", HTTP_POST, handleSavePollingConfig);
-    server.on("/getpollingconfig", HTTP_GET, handleGetPollingConfig);
+    onDeferred("/savepollingconfig", HTTP_POST, handleSavePollingConfig);
+    onDeferred("/getpollingconfig", HTTP_GET, handleGetPollingConfig);
+    onDeferred("/savemqttconfig", HTTP_POST, handleSaveMqttConfig);
+    onImmediate("/getmqttconfig", HTTP_GET, handleGetMqttConfig);
+    onImmediate("/getqueuestats", HTTP_GET, handleGetQueueStats);
+    onDeferred("/savetimeconfig", HTTP_POST, handleSaveTimeConfig);
+    onImmediate("/gettimeconfig", HTTP_GET, handleGetTimeConfig);
     
     // Statistics endpoints
-    server.on("/getstatistics", HTTP_GET, handleGetStatistics);
-    server.on("/removeslavestats", HTTP_POST, handleRemoveSlaveStats);
-    server.on("/setquerystate", HTTP_POST, handleSetQueryState);
+    onImmediate("/getstatistics", HTTP_GET, handleGetStatistics);
+    onDeferred("/removeslavestats", HTTP_POST, handleRemoveSlaveStats);
+    onDeferred("/setquerystate", HTTP_POST, handleSetQueryState);
     
     // Debug endpoints
-    server.on("/toggledebug", HTTP_POST, handleToggleDebug);
-    server.on("/getdebugstate", HTTP_GET, handleGetDebugState);
-    server.on("/getdebugmessages", HTTP_GET, handleGetDebugMessages);
-    server.on("/cleartable", HTTP_POST, handleClearTable);
+    onDeferred("/toggledebug", HTTP_POST, handleToggleDebug);
+    onImmediate("/getdebugstate", HTTP_GET, handleGetDebugState);
+    onImmediate("/getdebugmessages", HTTP_GET, handleGetDebugMessages);
+    onDeferred("/cleartable", HTTP_POST, handleClearTable);
+    
+    // Dashboard sections in one request (ip, stats, debug, polling)
+    onImmediate("/api/status", HTTP_GET, handleGetStatus);
+    onImmediate("/api/history", HTTP_GET, handleGetHistory);
+    onDeferred("/api/archive", HTTP_GET, handleGetArchive);
+    setupEventStream(server);
     
     server.begin();
     Serial.println("✅ HTTP server started on port 80");
 }
 
-// ==================== HELPER FUNCTIONS ====================
-
-void serveHtmlFile(const String& filename) {
-    if (!fileExists(filename)) {
-        Serial.printf("❌ File not found: %s\n", filename.c_str());
-        server.send(500, "text/plain", "File not found: " + filename);
-        return;
-    }
-    
-    File file = LittleFS.open(filename, "r");
-    if (!file) {
-        Serial.printf("❌ Failed to open: %s\n", filename.c_str());
-        server.send(500, "text/plain", "Failed to open file");
-        return;
-    }
-    
-    server.streamFile(file, "text/html");
-    file.close();
-}
-
-bool parseJsonBody(JsonDocument& doc) {
-    String body = server.arg("plain");
-    DeserializationError error = deserializeJson(doc, body);
-    
-    if (error) {
-        Serial.printf("❌ JSON parsing failed: %s\n", error.c_str());
-        sendErrorResponse("Invalid JSON");
-        return false;
-    }
-    return true;
-}
-
 // ==================== WIFI CONFIGURATION HANDLERS ====================
 
-void handleControlSTA() {
+void handleControlSTA(AsyncWebServerRequest* request) {
     Serial.println("🔄 Handling STA control request");
     
     JsonDocument doc;
-    if (!parseJsonBody(doc)) return;
+    if (!parseJsonBody(request, doc)) return;
     
     String action = doc["action"] | "";
     
     if (action == "connect") {
         connectSTA();
-        server.send(200, "application/json", "{\"status\":\"success\",\"message\":\"STA connection started\"}");
+        request->send(200, "application/json", "{\"status\":\"success\",\"message\":\"STA connection started\"}");
     } else if (action == "disconnect") {
         disconnectSTA();
-        server.send(200, "application/json", "{\"status\":\"success\",\"message\":\"STA disconnected\"}");
+        request->send(200, "application/json", "{\"status\":\"success\",\"message\":\"STA disconnected\"}");
     } else {
-        sendErrorResponse("Invalid action");
+        sendErrorResponse(request, "Invalid action");
     }
 }
 
-void handleGetIpInfo() {
-    Serial.println("📡 Returning IP information");
-    
-    JsonDocument doc;
-    
+void buildIpInfo(JsonDocument& doc) {
     // STA information
     doc["sta_ip"] = getSTAIP();
     doc["sta_subnet"] = WiFi.subnetMask().toString();
@@ -157,19 +373,25 @@ void handleGetIpInfo() {
     // AP information  
     doc["ap_ip"] = WiFi.softAPIP().toString();
     doc["ap_connected_clients"] = WiFi.softAPgetStationNum();
+}
+
+void handleGetIpInfo(AsyncWebServerRequest* request) {
+    Serial.println("📡 Returning IP information");
     
-    sendJsonResponse(doc);
+    JsonDocument doc;
+    buildIpInfo(doc);
+    sendJsonResponse(request, doc);
 }
 
-void handleSaveWifi() {
+void handleSaveWifi(AsyncWebServerRequest* request) {
     Serial.println("💾 Saving WiFi settings");
     
-    String staSsid = server.arg("sta_ssid");
-    String staPassword = server.arg("sta_password");
-    String apSsid = server.arg("ap_ssid");
-    String apPassword = server.arg("ap_password");
-    String mqttServer = server.arg("mqtt_server");
-    String mqttPort = server.arg("mqtt_port");
+    String staSsid = request->arg("sta_ssid");
+    String staPassword = request->arg("sta_password");
+    String apSsid = request->arg("ap_ssid");
+    String apPassword = request->arg("ap_password");
+    String mqttServer = request->arg("mqtt_server");
+    String mqttPort = request->arg("mqtt_port");
     
     WifiParams newParams;
     memset(&newParams, 0, sizeof(newParams));
@@ -182,11 +404,11 @@ void handleSaveWifi() {
     copyWifiParam(newParams.mqttPort, mqttPort, sizeof(newParams.mqttPort));
     
     saveWifi(newParams);
-    server.send(200, "application/json", "{\"status\":\"success\"}");
+    request->send(200, "application/json", "{\"status\":\"success\"}");
     Serial.println("✅ WiFi settings saved");
 }
 
-void handleGetWifi() {
+void handleGetWifi(AsyncWebServerRequest* request) {
     Serial.println("📡 Returning WiFi settings");
     
     JsonDocument doc;
@@ -197,33 +419,101 @@ void handleGetWifi() {
     doc["mqtt_server"] = currentParams.mqttServer;
     doc["mqtt_port"] = currentParams.mqttPort;
     
-    sendJsonResponse(doc);
+    sendJsonResponse(request, doc);
 }
 
 // ==================== STATIC FILE HANDLING ====================
 
-void handleStaticFiles() {
-    String path = server.uri();
+/**
+ * @brief Index /www once at boot: "<name>.<hash>.<ext>.gz" is served as
+ *        "/<name>.<hash>.<ext>", or "/<name>.<ext>" for HTML entry pages
+ */
+void loadStaticAssets() {
+    staticAssetCount = 0;
+    Dir dir = LittleFS.openDir(kAssetDir);
+    
+    while (dir.next() && staticAssetCount < kMaxStaticAssets) {
+        String name = dir.fileName();
+        if (!name.endsWith(".gz")) continue;
+        
+        String logical = name.substring(0, name.length() - 3);
+        int extDot = logical.lastIndexOf('.');
+        int hashDot = (extDot > 0) ? logical.lastIndexOf('.', extDot - 1) : -1;
+        if (hashDot < 0) continue;
+        
+        StaticAsset& asset = staticAssets[staticAssetCount++];
+        asset.immutable = !logical.endsWith(".html");
+        String url = "/" + (asset.immutable ? logical : logical.substring(0, hashDot) + logical.substring(extDot));
+        
+        strlcpy(asset.url, url.c_str(), sizeof(asset.url));
+        snprintf(asset.path, sizeof(asset.path), "%s/%s", kAssetDir, name.c_str());
+        snprintf(asset.etag, sizeof(asset.etag), "\"%s\"", logical.substring(hashDot + 1, extDot).c_str());
+    }
     
-    if (path.endsWith("/")) {
-        path += "index.html";
+    Serial.printf("🗂️ Indexed %d compressed web assets\n", staticAssetCount);
+}
+
+const StaticAsset* findStaticAsset(const String& url) {
+    for (int i = 0; i < staticAssetCount; i++) {
+        if (url == staticAssets[i].url) {
+            return &staticAssets[i];
+        }
+    }
+    return nullptr;
+}
+
+void serveStaticAsset(AsyncWebServerRequest* request, const StaticAsset& asset) {
+    const char* cacheControl = asset.immutable ? "public, max-age=31536000, immutable" : "no-cache";
+    
+    AsyncWebHeader* ifNoneMatch = request->getHeader("If-None-Match");
+    if (ifNoneMatch != nullptr && ifNoneMatch->value() == asset.etag) {
+        AsyncWebServerResponse* response = request->beginResponse(304);
+        response->addHeader("Cache-Control", cacheControl);
+        response->addHeader("ETag", asset.etag);
+        request->send(response);
+        return;
+    }
+    
+    File file = LittleFS.open(asset.path, "r");
+    if (!file) {
+        request->send(500, "text/plain", "Failed to open file");
+        return;
     }
     
-    String contentType = getContentType(path);
+    // A .gz file served under its plain URL gets Content-Encoding: gzip
+    AsyncWebServerResponse* response = request->beginResponse(file, asset.url, getContentType(asset.url));
+    response->addHeader("Cache-Control", cacheControl);
+    response->addHeader("ETag", asset.etag);
+    request->send(response);
+}
+
+void serveStaticPath(AsyncWebServerRequest* request, const String& path) {
+    recordWebRequest(false);
     
-    if (!fileExists(path)) {
-        server.send(404, "text/plain", "File not found: " + path);
+    const StaticAsset* asset = findStaticAsset(path);
+    if (asset != nullptr) {
+        serveStaticAsset(request, *asset);
         return;
     }
     
+    // Plain file - filesystem image built without the asset step. One open, no exists() probe.
     File file = LittleFS.open(path, "r");
     if (!file) {
-        server.send(500, "text/plain", "Failed to open file");
+        request->send(404, "text/plain", "File not found: " + path);
         return;
     }
     
-    server.streamFile(file, contentType);
-    file.close();
+    request->send(file, path, getContentType(path));
+}
+
+void handleStaticFiles(AsyncWebServerRequest* request) {
+    String path = request->url();
+    
+    if (path.endsWith("/")) {
+        path += "index.html";
+    }
+    
+    serveStaticPath(request, path);
 }
 
 String getContentType(const String& filename) {
@@ -240,122 +530,122 @@ String getContentType(const String& filename) {
 
 // ==================== SLAVE CONFIGURATION HANDLERS ====================
 
-void handleSetQueryState() {
+void handleSetQueryState(AsyncWebServerRequest* request) {
     Serial.println("🔄 Setting ModBus query state");
     
     JsonDocument doc;
-    if (!parseJsonBody(doc)) return;
+    if (!parseJsonBody(request, doc)) return;
     
     bool enabled = doc["enabled"] | false;
+    if (enabled == modbusQueriesEnabled) {
+        request->send(200, "application/json", "{\"status\":\"success\"}");
+        return;
+    }
 
     modbusQueriesEnabled = enabled;
+    bumpStatusVersion(STATUS_POLLING);
+    
+    // Persisted with the polling config so polling resumes by itself after a reboot or OTA
+    if (!savePollingConfig(pollInterval / 1000, timeoutDuration / 1000, pollSchedule, false)) {
+        sendErrorResponse(request, "Query state applied but not saved");
+        return;
+    }
     
     Serial.printf("✅ ModBus queries %s\n", enabled ? "enabled" : "disabled");
-    server.send(200, "application/json", "{\"status\":\"success\"}");
+    request->send(200, "application/json", "{\"status\":\"success\"}");
 }
 
-void handleSaveSlaves() {
+void handleSaveSlaves(AsyncWebServerRequest* request) {
     Serial.println("💾 Saving slave configuration");
     
-    JsonDocument newDoc;
-    if (!parseJsonBody(newDoc)) return;
+    if (request != slavesUploadOwner || !slavesUploadComplete) {
+        releaseSlavesUpload(request);
+        sendErrorResponse(request, "Empty, oversized or interrupted upload");
+        return;
+    }
     
-    JsonDocument existingDoc;
-    if (loadSlaveConfig(existingDoc)) {
-        JsonArray existingSlaves = existingDoc["slaves"];
-        JsonArray newSlaves = newDoc["slaves"];
-        
-        for (size_t  i = 0; i < newSlaves.size(); i++) {
-            JsonObject newSlave = newSlaves[i];
-            uint8_t newId = newSlave["id"];
-            const char* newName = newSlave["name"];
-            
-            for (JsonObject existingSlave : existingSlaves) {
-                if (existingSlave["id"] == newId && 
-                    strcmp(existingSlave["name"], newName) == 0) {
-                    
-                    if (existingSlave["override"].is<JsonObject>()) {
-                        newSlave["override"] = existingSlave["override"];
-                    }
-                    break;
-                }
-            }
-        }
+    // Parsed from flash; the body never exists as a String
+    File file = LittleFS.open(kSlavesUploadPath, "r");
+    if (!file) {
+        releaseSlavesUpload(request);
+        sendErrorResponse(request, "Upload not stored");
+        return;
     }
     
-    if (saveSlaveConfig(newDoc)) {
-        clearTemplateCache();
-        modbusReloadSlaves();
-        server.send(200, "application/json", "{\"status\":\"success\"}");
-        Serial.println("✅ Slave configuration saved successfully with preserved overrides");
-    } else {
-        sendErrorResponse("Failed to save slave configuration");
+    JsonDocument newDoc;
+    DeserializationError error = deserializeJson(newDoc, file);
+    file.close();
+    releaseSlavesUpload(request);
+    
+    if (error) {
+        Serial.printf("❌ JSON parsing failed: %s\n", error.c_str());
+        sendErrorResponse(request, "Invalid JSON");
+        return;
     }
+    if (!newDoc["slaves"].is<JsonArray>()) {
+        sendErrorResponse(request, "Missing slaves array");
+        return;
+    }
+    
+    carryOverOverrides(newDoc["slaves"].as<JsonArray>());
+    
+    // The resident model takes over the parsed document; slaves.json is replaced by rename
+    replaceSlaveConfig(newDoc);
+    modbusReloadSlaves();
+    request->send(200, "application/json", "{\"status\":\"success\"}");
+    Serial.println("✅ Slave configuration saved successfully with preserved overrides");
 }
 
-void handleGetSlaves() {
+void handleGetSlaves(AsyncWebServerRequest* request) {
     Serial.println("📡 Returning slave configuration");
     
-    JsonDocument doc;
-    if (loadSlaveConfig(doc)) {
-        String response;
-        serializeJson(doc, response);
-        server.send(200, "application/json", response);
-    } else {
-        server.send(200, "application/json", "{\"slaves\":[]}");
+    // Raw passthrough while the file matches the resident model
+    if (!isSlaveConfigDirty()) {
+        File file = LittleFS.open(kSlavesPath, "r");
+        if (file) {
+            request->send(file, kSlavesPath, "application/json");
+            return;
+        }
     }
+    
+    AsyncResponseStream* response = request->beginResponseStream("application/json");
+    serializeJson(getSlaveConfigDoc(), *response);
+    request->send(response);
 }
 
-void handleGetSlaveConfig() {
+void handleGetSlaveConfig(AsyncWebServerRequest* request) {
     Serial.println("🔍 Getting specific slave with template merge");
     
-    String body = server.arg("plain");
-    if (body.length() == 0) {
-        sendErrorResponse("Empty request body");
-        return;
-    }
-    
     JsonDocument doc;
-    DeserializationError error = deserializeJson(doc, body);
-    if (error) {
-        sendErrorResponse("Invalid JSON");
-        return;
-    }
+    if (!parseJsonBody(request, doc)) return;
     
     uint8_t slaveId = doc["slaveId"];
     const char* slaveName = doc["slaveName"];
     
-    JsonDocument configDoc;
-    if (!loadSlaveConfig(configDoc)) {
-        sendErrorResponse("No slave configuration found");
+    // The editor reopens the same slave; reuse its view until slaves or templates change
+    static MergedSlaveView cachedView;
+    if (cachedView.valid && cachedView.slaveId == slaveId && slaveName != nullptr &&
+        cachedView.slaveName == slaveName && cachedView.configVersion == getSlaveConfigVersion() &&
+        cachedView.templateGeneration == getTemplateGeneration()) {
+        request->send(200, "application/json", cachedView.json);
         return;
     }
     
-    JsonArray slavesArray = configDoc["slaves"];
-    bool slaveFound = false;
-    JsonObject foundSlave;
-    
-    for (JsonObject slave : slavesArray) {
-        if (slave["id"] == slaveId && strcmp(slave["name"], slaveName) == 0) {
-            foundSlave = slave;
-            slaveFound = true;
-            break;
-        }
-    }
-    
-    if (!slaveFound) {
-        sendErrorResponse("Slave not found");
+    JsonObject foundSlave = findSlaveConfig(slaveId, slaveName);
+    if (foundSlave.isNull()) {
+        sendErrorResponse(request, "Slave not found");
         return;
     }
     
-    JsonDocument templateDoc;
-    JsonObject templateConfig = templateDoc.to<JsonObject>();
-    JsonDocument mergedDoc;
-    JsonObject mergedConfig = mergedDoc.to<JsonObject>();
-    
-    const char* deviceType = foundSlave["deviceType"];
-    if (loadDeviceTemplate(deviceType, templateConfig)) {
-        mergeWithOverride(foundSlave, templateConfig, mergedConfig);
+    const CompiledTemplate* tmpl = findCompiledTemplate(foundSlave["deviceType"]);
+    cachedView.valid = false;
+    if (tmpl != nullptr) {
+        ParamPatch patches[kMaxParamSlots];
+        uint8_t patchCount = compileOverridePatches(*tmpl, foundSlave["override"], patches);
+        
+        JsonDocument mergedDoc;
+        JsonObject mergedConfig = mergedDoc.to<JsonObject>();
+        writeResolvedParams(*tmpl, patches, patchCount, mergedConfig);
         
         mergedConfig["id"] = foundSlave["id"];
         mergedConfig["name"] = foundSlave["name"];
@@ -367,231 +657,472 @@ void handleGetSlaveConfig() {
         mergedConfig["ct"] = foundSlave["ct"] | 1.0f;
         mergedConfig["pt"] = foundSlave["pt"] | 1.0f;
         
-        sendJsonResponse(mergedDoc);
+        cachedView.json = "";
+        serializeJson(mergedDoc, cachedView.json);
+        cachedView.slaveId = slaveId;
+        cachedView.slaveName = slaveName;
+        cachedView.configVersion = getSlaveConfigVersion();
+        cachedView.templateGeneration = getTemplateGeneration();
+        cachedView.valid = true;
+        request->send(200, "application/json", cachedView.json);
     } else {
-        sendJsonResponse(foundSlave);
+        sendJsonResponse(request, foundSlave);
     }
 }
 
-void handleUpdateSlaveConfig() {
+void handleUpdateSlaveConfig(AsyncWebServerRequest* request) {
     Serial.println("💾 Updating specific slave with template system");
     
-    String body = server.arg("plain");
-    if (body.length() == 0) {
-        sendErrorResponse("Empty request body");
+    JsonDocument updateDoc;
+    if (!parseJsonBody(request, updateDoc)) return;
+    
+    if (!updateDoc["id"].is<int>() || !updateDoc["name"].is<const char*>()) {
+        sendErrorResponse(request, "Missing required fields: id or name");
         return;
     }
     
-    JsonDocument updateDoc;
-    DeserializationError error = deserializeJson(updateDoc, body);
+    uint8_t slaveId = updateDoc["id"];
+    const char* slaveName = updateDoc["name"];
     
-    if (error) {
-        sendErrorResponse("Invalid JSON");
+    JsonObject storedSlave = findSlaveConfig(slaveId, slaveName);
+    const char* deviceType = storedSlave["deviceType"];
+    
+    if (storedSlave.isNull() || deviceType == nullptr) {
+        sendErrorResponse(request, "Slave not found or no deviceType");
         return;
     }
     
-    if (!updateDoc["id"].is<int>() || !updateDoc["name"].is<const char*>()) {
-        sendErrorResponse("Missing required fields: id or name");
+    // The slave's own reply is still being decoded; swap it in on a later pass
+    int liveIndex = findSlaveIndex(slaveId, slaveName);
+    if (isSlaveInTransaction(liveIndex)) {
+        redeferRequest(request, handleUpdateSlaveConfig);
         return;
     }
     
-    uint8_t slaveId = updateDoc["id"];
-    const char* slaveName = updateDoc["name"];
-    
-    JsonDocument configDoc;
-    if (!loadSlaveConfig(configDoc)) {
-        sendErrorResponse("No slave configuration found");
+    const CompiledTemplate* tmpl = findCompiledTemplate(deviceType);
+    if (tmpl == nullptr) {
+        sendErrorResponse(request, "Template not found for device type");
         return;
     }
     
-    JsonArray slavesArray = configDoc["slaves"];
-    bool slaveFound = false;
-    int slaveIndex = -1;
-    const char* deviceType = nullptr;
+    JsonDocument slaveDoc;
+    JsonObject slaveObj = slaveDoc.to<JsonObject>();
+    
+    slaveObj["id"] = slaveId;
+    slaveObj["name"] = slaveName;
+    slaveObj["deviceType"] = deviceType;
+    slaveObj["startReg"] = updateDoc["startReg"];
+    slaveObj["numReg"] = updateDoc["numReg"];
+    slaveObj["mqttTopic"] = updateDoc["mqttTopic"];
+    slaveObj["registerSize"] = updateDoc["registerSize"];
+    slaveObj["ct"] = updateDoc["ct"];
+    slaveObj["pt"] = updateDoc["pt"];
+    
+    // Parameter groups are the object members; only values differing from the template are kept
+    JsonObject overrideOutput = slaveObj["override"].to<JsonObject>();
+    detectOverridePatches(*tmpl, updateDoc.as<JsonObjectConst>(), overrideOutput);
+    if (overrideOutput.size() == 0) {
+        slaveObj.remove("override");
+    }
     
-    for (size_t i = 0; i < slavesArray.size(); i++) {
-        JsonObject slave = slavesArray[i];
-        if (slave["id"] == slaveId && strcmp(slave["name"], slaveName) == 0) {
-            slaveIndex = i;
-            slaveFound = true;
-            deviceType = slave["deviceType"];
-            break;
+    if (liveIndex < 0) {
+        // Not in the live table (e.g. failed to build at load) - store it and rebuild everything
+        storedSlave.set(slaveObj);
+        markSlaveConfigDirty();
+        modbusReloadSlaves();
+    } else {
+        String error;
+        if (!commitSlaveConfig(liveIndex, slaveObj, error)) {
+            sendErrorResponse(request, error.c_str());
+            return;
         }
     }
     
-    if (!slaveFound || deviceType == nullptr) {
-        sendErrorResponse("Slave not found or no deviceType");
+    request->send(200, "application/json", "{\"status\":\"success\",\"message\":\"Slave configuration updated successfully\"}");
+}
+
+/**
+ * @brief PATCH /patchslave {"id", "name", "patch": {...}} - same fields as the
+ *        MQTT patchSlave command; only that slave is rebuilt
+ */
+void handlePatchSlave(AsyncWebServerRequest* request) {
+    JsonDocument doc;
+    if (!parseJsonBody(request, doc)) return;
+    
+    uint8_t slaveId = doc["id"] | 0;
+    const char* slaveName = doc["name"];
+    if (slaveId == 0 || slaveName == nullptr || !doc["patch"].is<JsonObject>()) {
+        sendErrorResponse(request, "id, name and patch object required");
         return;
     }
     
-    JsonDocument templateDoc;
-    JsonObject templateConfig = templateDoc.to<JsonObject>();
-    
-    if (!loadDeviceTemplate(deviceType, templateConfig)) {
-        sendErrorResponse("Template not found for device type");
+    int slaveIndex = findSlaveIndex(slaveId, slaveName);
+    if (isSlaveInTransaction(slaveIndex)) {
+        redeferRequest(request, handlePatchSlave);
         return;
     }
     
-    JsonDocument paramsOnlyDoc;
-    JsonObject paramsOnly = paramsOnlyDoc.to<JsonObject>();
-    
-    for (JsonPair kv : updateDoc.as<JsonObject>()) {
-        const char* key = kv.key().c_str();
-        if (strcmp(key, "id") != 0 && 
-            strcmp(key, "name") != 0 &&
-            strcmp(key, "deviceType") != 0 &&
-            strcmp(key, "startReg") != 0 &&
-            strcmp(key, "numReg") != 0 &&
-            strcmp(key, "mqttTopic") != 0 &&
-            strcmp(key, "registerSize") != 0 &&
-            strcmp(key, "ct") != 0 &&
-            strcmp(key, "pt") != 0) {
-            paramsOnly[key].set(kv.value());
-        }
+    String error;
+    if (!applySlavePatch(slaveIndex, doc["patch"].as<JsonObject>(), error)) {
+        sendErrorResponse(request, error.c_str());
+        return;
     }
     
-    JsonDocument overrideDoc;
-    JsonObject overrideOutput = overrideDoc.to<JsonObject>();
-    detectOverrides(paramsOnly, templateConfig, overrideOutput);
+    request->send(200, "application/json", "{\"status\":\"success\"}");
+}
+
+// ==================== TEMPLATE HANDLERS ====================
+
+void handleGetTemplates(AsyncWebServerRequest* request) {
+    File file = LittleFS.open("/templates.json", "r");
+    if (!file) {
+        request->send(200, "application/json", "{}");
+        return;
+    }
+    request->send(file, "/templates.json", "application/json");
+}
+
+/**
+ * @brief POST /savetemplate {"deviceType", "template": {...}} - adds or replaces one
+ *        device definition. Its "registers" map is checked before it is stored, then
+ *        every slave is rebuilt so the new map decodes from the next reading.
+ */
+void handleSaveTemplate(AsyncWebServerRequest* request) {
+    JsonDocument doc;
+    if (!parseJsonBody(request, doc)) return;
     
-    slavesArray[slaveIndex].clear();
+    const char* deviceType = doc["deviceType"];
+    if (deviceType == nullptr || deviceType[0] == '\0') {
+        sendErrorResponse(request, "deviceType required");
+        return;
+    }
     
-    slavesArray[slaveIndex]["id"] = slaveId;
-    slavesArray[slaveIndex]["name"] = slaveName;
-    slavesArray[slaveIndex]["deviceType"] = deviceType;
-    slavesArray[slaveIndex]["startReg"] = updateDoc["startReg"];
-    slavesArray[slaveIndex]["numReg"] = updateDoc["numReg"];
-    slavesArray[slaveIndex]["mqttTopic"] = updateDoc["mqttTopic"];
-    slavesArray[slaveIndex]["registerSize"] = updateDoc["registerSize"];
-    slavesArray[slaveIndex]["ct"] = updateDoc["ct"];
-    slavesArray[slaveIndex]["pt"] = updateDoc["pt"];
+    String error;
+    if (!validateTemplate(doc["template"], error)) {
+        sendErrorResponse(request, error.c_str());
+        return;
+    }
     
-    if (overrideOutput.size() > 0) {
-        slavesArray[slaveIndex]["override"] = overrideOutput;
+    JsonDocument templatesDoc;
+    if (fileExists("/templates.json") && !loadTemplates(templatesDoc)) {
+        sendErrorResponse(request, "Failed to read templates");     // Never overwrite what we could not parse
+        return;
     }
-
-    if (saveSlaveConfig(configDoc)) {
-        clearTemplateCache();
-        modbusReloadSlaves();
-        server.send(200, "application/json", "{\"status\":\"success\",\"message\":\"Slave configuration updated successfully\"}");
-    } else {
-        sendErrorResponse("Failed to save slave configuration");
+    templatesDoc[deviceType] = doc["template"];
+    
+    if (!saveTemplates(templatesDoc)) {
+        sendErrorResponse(request, "Failed to save templates");
+        return;
     }
+    
+    modbusReloadSlaves();
+    Serial.printf("📋 Saved template: %s\n", deviceType);
+    request->send(200, "application/json", "{\"status\":\"success\"}");
 }
 
 // ==================== POLLING CONFIGURATION HANDLERS ====================
 
-void handleSavePollingConfig() {
+void handleSavePollingConfig(AsyncWebServerRequest* request) {
     Serial.println("💾 Saving polling configuration");
     
     JsonDocument doc;
-    if (!parseJsonBody(doc)) return;
+    if (!parseJsonBody(request, doc)) return;
     
     int interval = doc["pollInterval"] | 10;
     int timeout = doc["timeout"] | 1;
+    if (interval < kMinPollIntervalSeconds || interval > kMaxPollIntervalSeconds) {
+        sendErrorResponse(request, "pollInterval must be 1-86400 seconds");
+        return;
+    }
+    if (timeout < kMinTimeoutSeconds || timeout > kMaxTimeoutSeconds) {
+        sendErrorResponse(request, "timeout must be 1-60 seconds");
+        return;
+    }
     
-    if (savePollingConfig(interval, timeout)) {
-        server.send(200, "application/json", "{\"status\":\"success\"}");
+    // Nothing changes in RAM until the file is written; the reload that follows applies all three
+    PollSchedule schedule = { parsePollMode(doc["mode"] | getPollModeName(pollSchedule.mode)),
+                              doc["align"] | pollSchedule.alignToClock };
+    if (savePollingConfig(interval, timeout, schedule)) {
+        request->send(200, "application/json", "{\"status\":\"success\"}");
     } else {
-        sendErrorResponse("Failed to save polling config");
+        sendErrorResponse(request, "Failed to save polling config");
     }
 }
 
-void handleGetPollingConfig() {
+void handleGetPollingConfig(AsyncWebServerRequest* request) {
     Serial.println("📡 Returning polling configuration");
     
     int interval, timeout;
-    loadPollingConfig(interval, timeout);
+    PollSchedule schedule;
+    bool queriesEnabled;
+    loadPollingConfig(interval, timeout, schedule, queriesEnabled);
     
     JsonDocument doc;
     doc["pollInterval"] = interval;
     doc["timeout"] = timeout;
+    doc["mode"] = getPollModeName(schedule.mode);
+    doc["align"] = schedule.alignToClock;
+    doc["enabled"] = queriesEnabled;
     
-    sendJsonResponse(doc);
+    sendJsonResponse(request, doc);
+}
+
+// ==================== MQTT CONFIGURATION HANDLERS ====================
+
+void handleSaveMqttConfig(AsyncWebServerRequest* request) {
+    Serial.println("💾 Saving MQTT publish configuration");
+    
+    JsonDocument doc;
+    if (!parseJsonBody(request, doc)) return;
+    
+    MqttConfig newConfig;
+    newConfig.sparkplugEnabled = doc["sparkplug"] | false;
+    strlcpy(newConfig.groupId, doc["groupId"] | "ModBus", sizeof(newConfig.groupId));
+    strlcpy(newConfig.edgeNodeId, doc["edgeNodeId"] | "", sizeof(newConfig.edgeNodeId));
+    newConfig.queuePolicy = parseQueuePolicy(doc["queuePolicy"] | "drop_oldest");
+    
+    if (newConfig.groupId[0] == '\0') {
+        sendErrorResponse(request, "Group ID must not be empty");
+        return;
+    }
+    
+    if (saveMqttConfig(newConfig)) {
+        applyMqttConfig(newConfig);
+        request->send(200, "application/json", "{\"status\":\"success\"}");
+    } else {
+        sendErrorResponse(request, "Failed to save MQTT config");
+    }
+}
+
+void handleGetMqttConfig(AsyncWebServerRequest* request) {
+    Serial.println("📡 Returning MQTT publish configuration");
+    
+    JsonDocument doc;
+    doc["sparkplug"] = mqttConfig.sparkplugEnabled;
+    doc["groupId"] = mqttConfig.groupId;
+    doc["edgeNodeId"] = mqttConfig.edgeNodeId;
+    doc["nodeTopic"] = buildSparkplugTopic("NBIRTH");
+    doc["queuePolicy"] = getQueuePolicyName(mqttConfig.queuePolicy);
+    
+    sendJsonResponse(request, doc);
+}
+
+// ==================== TIME CONFIGURATION HANDLERS ====================
+
+void handleSaveTimeConfig(AsyncWebServerRequest* request) {
+    Serial.println("💾 Saving time configuration");
+    
+    JsonDocument doc;
+    if (!parseJsonBody(request, doc)) return;
+    
+    TimeConfig newConfig;
+    strlcpy(newConfig.ntpServer, doc["ntpServer"] | kDefaultNtpServer, sizeof(newConfig.ntpServer));
+    
+    if (saveTimeConfig(newConfig)) {
+        timeConfig = newConfig;
+        initTimeSync(timeConfig.ntpServer);
+        request->send(200, "application/json", "{\"status\":\"success\"}");
+    } else {
+        sendErrorResponse(request, "Failed to save time config");
+    }
+}
+
+void handleGetTimeConfig(AsyncWebServerRequest* request) {
+    JsonDocument doc;
+    doc["ntpServer"] = timeConfig.ntpServer;
+    doc["timeSynced"] = isTimeSynced();
+    doc["syncAge"] = getTimeSyncAge();
+    
+    sendJsonResponse(request, doc);
+}
+
+void handleGetQueueStats(AsyncWebServerRequest* request) {
+    const PublishQueueStats& stats = getPublishQueueStats();
+    
+    JsonDocument doc;
+    doc["policy"] = getQueuePolicyName(mqttConfig.queuePolicy);
+    doc["capacityBytes"] = kPublishQueueBytes;
+    doc["depth"] = stats.depth;
+    doc["bytesUsed"] = stats.bytesUsed;
+    doc["highWaterBytes"] = stats.highWaterBytes;
+    doc["enqueued"] = stats.enqueued;
+    doc["published"] = stats.published;
+    doc["dropped"] = stats.dropped;
+    doc["coalesced"] = stats.coalesced;
+    doc["lastLatencyMs"] = stats.lastLatencyMs;
+    doc["maxLatencyMs"] = stats.maxLatencyMs;
+    doc["avgLatencyMs"] = stats.published > 0 ? stats.totalLatencyMs / stats.published : 0;
+    doc["lastSampleLatencyMs"] = stats.lastSampleAgeMs;
+    doc["maxSampleLatencyMs"] = stats.maxSampleAgeMs;
+    doc["avgSampleLatencyMs"] = stats.samplesPublished > 0 ? stats.totalSampleAgeMs / stats.samplesPublished : 0;
+    
+    sendJsonResponse(request, doc);
 }
 
 // ==================== STATISTICS HANDLERS ====================
 
-void handleGetStatistics() {
+void handleGetStatistics(AsyncWebServerRequest* request) {
     Serial.println("📊 Returning query statistics");
     
-    String statsJson = getStatisticsJson();
-    server.send(200, "application/json", statsJson);
+    sendJsonArrayStream(request, appendStatisticRecord);
 }
 
-void handleRemoveSlaveStats() {
+void handleRemoveSlaveStats(AsyncWebServerRequest* request) {
     Serial.println("🗑️ Removing slave statistics");
     
     JsonDocument doc;
-    if (!parseJsonBody(doc)) return;
+    if (!parseJsonBody(request, doc)) return;
     
     uint8_t slaveId = doc["slaveId"];
     const char* slaveName = doc["slaveName"];
     
     removeSlaveStatistic(slaveId, slaveName);
-    server.send(200, "application/json", "{\"status\":\"success\"}");
+    request->send(200, "application/json", "{\"status\":\"success\"}");
+}
+
+// ==================== HISTORY HANDLERS ====================
+
+void handleGetHistory(AsyncWebServerRequest* request) {
+    if (!request->hasParam("slave") || !request->hasParam("channel")) {
+        sendErrorResponse(request, "slave and channel are required");
+        return;
+    }
+    
+    uint8_t slaveId = request->getParam("slave")->value().toInt();
+    String channel = request->getParam("channel")->value();
+    String slaveName = request->hasParam("name") ? request->getParam("name")->value() : String();
+    
+    // Stored on uptime; shifted onto the wall clock once it is set
+    int64_t clockOffset = isTimeSynced() ? (int64_t)(getTimestampMillis() - getHistoryClockMillis()) : 0;
+    int64_t fromMillis = request->hasParam("from") ? strtoull(request->getParam("from")->value().c_str(), nullptr, 10) : 0;
+    uint32_t fromTime = (fromMillis > clockOffset) ? (fromMillis - clockOffset) / 1000 : 0;
+    
+    int series = findHistorySeries(slaveId, slaveName.length() > 0 ? slaveName.c_str() : nullptr, channel.c_str());
+    auto cursor = std::make_shared<HistoryCursor>();
+    if (!openHistoryCursor(series, fromTime, *cursor)) {
+        request->send(404, "application/json", "{\"status\":\"error\",\"message\":\"No history for this channel\"}");
+        return;
+    }
+    
+    // Decoded a point at a time as the response drains: [[ts_ms,value],...]
+    sendJsonArrayStream(request, [cursor, fromTime, clockOffset](size_t, String& out) {
+        uint32_t time;
+        float value;
+        do {
+            if (!nextHistoryPoint(*cursor, time, value)) return false;
+        } while (time < fromTime);
+        
+        char timestamp[24];
+        formatUint64((uint64_t)time * 1000 + clockOffset, timestamp, sizeof(timestamp));
+        
+        char point[48];
+        if (isnan(value) || isinf(value)) {
+            snprintf(point, sizeof(point), "[%s,null]", timestamp);
+        } else {
+            snprintf(point, sizeof(point), "[%s,%.6g]", timestamp, value);
+        }
+        out += point;
+        return true;
+    });
+}
+
+void handleGetArchive(AsyncWebServerRequest* request) {
+    if (!request->hasParam("slave") || !request->hasParam("channel")) {
+        sendErrorResponse(request, "slave and channel are required");
+        return;
+    }
+    
+    uint8_t slaveId = request->getParam("slave")->value().toInt();
+    String channel = request->getParam("channel")->value();
+    String slaveName = request->hasParam("name") ? request->getParam("name")->value() : String();
+    uint32_t fromTime = request->hasParam("from") ? strtoull(request->getParam("from")->value().c_str(), nullptr, 10) / 1000 : 0;
+    uint32_t toTime = request->hasParam("to") ? strtoull(request->getParam("to")->value().c_str(), nullptr, 10) / 1000 : UINT32_MAX;
+    
+    auto cursor = std::make_shared<ArchiveCursor>();
+    if (!openArchiveQuery(cursor, slaveId, slaveName.length() > 0 ? slaveName.c_str() : nullptr, channel.c_str(),
+                          fromTime, toTime)) {
+        request->send(503, "application/json", "{\"status\":\"error\",\"message\":\"Archive busy\"}");
+        return;
+    }
+    
+    // [[ts_ms,value,samples],...] - compacted points carry the bucket mean and size.
+    // Flash is read by loop() ahead of the response; this only drains what is ready.
+    sendJsonArrayStream(request, [cursor](size_t, String& out) {
+        ArchiveRecord record;
+        if (!takeArchiveRecord(*cursor, record)) return !isArchiveQueryDone(*cursor);
+        
+        char point[48];
+        if (isnan(record.value) || isinf(record.value)) {
+            snprintf(point, sizeof(point), "[%lu000,null,%u]", (unsigned long)record.time, record.count);
+        } else {
+            snprintf(point, sizeof(point), "[%lu000,%.6g,%u]", (unsigned long)record.time, record.value,
+                     record.count);
+        }
+        out += point;
+        return true;
+    });
 }
 
 // ==================== DEBUG MANAGEMENT HANDLERS ====================
 
-void handleToggleDebug() {
+void handleToggleDebug(AsyncWebServerRequest* request) {
     JsonDocument doc;
-    if (!parseJsonBody(doc)) return;
+    if (!parseJsonBody(request, doc)) return;
     
     debugEnabled = doc["enabled"] | false;
-    server.send(200, "application/json", "{\"status\":\"success\"}");
+    bumpStatusVersion(STATUS_DEBUG);
+    request->send(200, "application/json", "{\"status\":\"success\"}");
 }
 
-void handleGetDebugState() {
+void handleGetDebugState(AsyncWebServerRequest* request) {
     JsonDocument doc;
     doc["enabled"] = debugEnabled;
-    sendJsonResponse(doc);
+    sendJsonResponse(request, doc);
 }
 
-void handleGetDebugMessages() {
-    String response = "[";
-    for (int i = 0; i < debugMessageCount; i++) {
-        response += debugMessages[i];
-        if (i < debugMessageCount - 1) response += ",";
+void handleGetDebugMessages(AsyncWebServerRequest* request) {
+    // Non-destructive: each reader asks for what came after the last seq it saw
+    uint32_t since = request->hasParam("since") ? strtoul(request->getParam("since")->value().c_str(), nullptr, 10) : 0;
+    uint32_t latest = getLatestDebugSeq();
+    
+    // A cursor ahead of the ring means the gateway restarted; replay from the start
+    if (since > latest) {
+        since = 0;
     }
-    response += "]";
     
-    debugMessageCount = 0;
-    debugMessageIndex = 0;
-    
-    server.send(200, "application/json", response);
+    uint32_t next = since + 1;
+    sendJsonArrayStream(request, [next, latest](size_t, String& out) mutable {
+        uint32_t seq = 0;
+        if (!appendDebugRecordJson(next, latest, out, seq)) return false;
+        next = seq + 1;
+        return true;
+    });
 }
 
-void addDebugMessage(const char* topic, const char* message, const char* timeDelta, const char* sameDeviceDelta) {
+void addDebugMessage(const char* topic, const char* message, const char* timeDelta, const char* sameDeviceDelta,
+                     uint8_t slaveId, const char* slaveName) {
     if (!debugEnabled) return;
     
-    JsonDocument doc;
-    doc["topic"] = topic;
-    doc["message"] = message;
-    doc["timestamp"] = millis();
-    doc["timeDelta"] = timeDelta;
-    doc["sameDeviceDelta"] = sameDeviceDelta;
-    doc["realTime"] = getCurrentTimeString();
-    
-    String jsonMessage;
-    serializeJson(doc, jsonMessage);
+    char realTime[kDebugTimeLength + 1];
+    formatCurrentTime(realTime, sizeof(realTime));
     
-    debugMessages[debugMessageIndex] = jsonMessage;
-    debugMessageIndex = (debugMessageIndex + 1) % kMaxDebugMessages;
+    uint32_t seq = pushDebugRecord(topic, message, timeDelta, sameDeviceDelta, slaveId, slaveName, realTime);
+    if (seq == 0 || !hasEventClients()) return;
     
-    if (debugMessageCount < kMaxDebugMessages) {
-        debugMessageCount++;
+    // Formatted in place; a record too big for the buffer only announces its seq
+    static char event[kMaxDebugEventBytes];
+    if (formatDebugRecordJson(seq, event, sizeof(event)) == 0) {
+        snprintf(event, sizeof(event), "{\"seq\":%lu,\"more\":true}", (unsigned long)seq);
     }
+    emitEvent("debug", event);
 }
 
-void handleClearTable() {
+void handleClearTable(AsyncWebServerRequest* request) {
     Serial.println("🗑️ Clearing table and resetting timing data");
     resetAllTiming();
+    clearDebugRing();
     
-    debugMessageCount = 0;
-    debugMessageIndex = 0;
-    
-    server.send(200, "application/json", "{\"status\":\"success\",\"message\":\"Table cleared and timing reset\"}");
+    request->send(200, "application/json", "{\"status\":\"success\",\"message\":\"Table cleared and timing reset\"}");
 }
 
 // ==================== ENHANCED TIMING FUNCTIONS ====================
@@ -616,16 +1147,36 @@ String formatTimeDelta(unsigned long deltaMs) {
     return "+" + String(deltaMs / 1000.0, 1) + "s";
 }
 
-String getCurrentTimeString() {
+void formatCurrentTime(char* buffer, size_t size) {
+    if (isWallClockSet()) {
+        time_t now = time(nullptr);
+        struct tm utc;
+        gmtime_r(&now, &utc);
+        strftime(buffer, size, "%H:%M:%S", &utc);
+        return;
+    }
+    
+    // Uptime until SNTP has set the clock
     unsigned long elapsedMs = millis() - systemStartTime;
     unsigned long seconds = elapsedMs / 1000;
     unsigned long hours = (seconds % 86400) / 3600;
     unsigned long minutes = (seconds % 3600) / 60;
     unsigned long secs = seconds % 60;
     
-    char timeBuffer[9];
-    snprintf(timeBuffer, sizeof(timeBuffer), "%02lu:%02lu:%02lu", hours, minutes, secs);
-    return String(timeBuffer);
+    snprintf(buffer, size, "%02lu:%02lu:%02lu", hours, minutes, secs);
+}
+
+bool isWallClockSet() {
+    return time(nullptr) > kMinValidEpoch;
+}
+
+uint64_t getTimestampMillis() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    if (tv.tv_sec > kMinValidEpoch) {
+        return (uint64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+    }
+    return millis();   // No wall clock yet - uptime keeps ordering intact
 }
 
 String calculateSameDeviceDelta(uint8_t slaveId, const char* slaveName) {
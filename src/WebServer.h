@@ -1,8 +1,9 @@
 #pragma once
 
 #include <Arduino.h>
-#include <ESP8266WebServer.h>
+#include <ESPAsyncWebServer.h>
 #include <ArduinoJson.h>
+#include <functional>
 
 #include "EEEProm.h"
 #include "FSHandler.h"
@@ -11,7 +12,7 @@
 
 // ==================== EXTERNAL DECLARATIONS ====================
 
-extern ESP8266WebServer server;
+extern AsyncWebServer server;
 extern bool debugEnabled;
 extern bool modbusQueriesEnabled;
 
@@ -29,6 +30,41 @@ struct DeviceTiming {
     unsigned long messageCount;
 };
 
+/**
+ * @brief Last /getslaveconfig response, valid for one config version and template generation
+ */
+struct MergedSlaveView {
+    bool valid;
+    uint8_t slaveId;
+    String slaveName;
+    uint32_t configVersion;
+    uint32_t templateGeneration;
+    String json;
+};
+
+/**
+ * @brief Pre-compressed web asset found in /www at boot
+ */
+struct StaticAsset {
+    char url[40];
+    char path[56];
+    char etag[12];      // Quoted content hash from the file name
+    bool immutable;     // Hash is part of the URL - cache forever
+};
+
+// ==================== DEFERRED REQUESTS ====================
+constexpr uint8_t kMaxDeferredRequests = 4;
+
+typedef void (*DeferredHandler)(AsyncWebServerRequest* request);
+
+/**
+ * @brief Request accepted in the network callback, answered from loop()
+ */
+struct DeferredRequest {
+    AsyncWebServerRequest* request;     // nullptr once the client disconnected
+    DeferredHandler handler;
+};
+
 // ==================== GLOBAL TIMING VARIABLES ====================
 
 extern DeviceTiming deviceTiming[]; // Max 12 devices
@@ -41,50 +77,81 @@ unsigned long calculateTimeDelta(uint8_t slaveId, const char* slaveName);
 String getSameDeviceDelta(uint8_t slaveId, const char* slaveName, bool resetTimer = false);
 void updateDeviceTiming(uint8_t slaveId, const char* slaveName, unsigned long currentTime);
 String formatTimeDelta(unsigned long deltaMs);
-String getCurrentTimeString();
+void formatCurrentTime(char* buffer, size_t size);
+bool isWallClockSet();
+uint64_t getTimestampMillis();
 void resetAllTiming();
 
 // ==================== WEB SERVER MANAGEMENT ====================
 
 void setupWebServer();
+bool hasDeferredRequests();
+void serviceDeferredRequests();
 
 // ==================== REQUEST HANDLERS ====================
 
-void handleRoot();
-void handleStaticFiles();
-void handleGetIpInfo();
+void handleStaticFiles(AsyncWebServerRequest* request);
+void loadStaticAssets();
+const StaticAsset* findStaticAsset(const String& url);
+void serveStaticAsset(AsyncWebServerRequest* request, const StaticAsset& asset);
+void serveStaticPath(AsyncWebServerRequest* request, const String& path);
+void handleGetIpInfo(AsyncWebServerRequest* request);
+void buildIpInfo(JsonDocument& doc);
 
 // ==================== WIFI CONFIGURATION HANDLERS ====================
 
-void handleSaveWifi();
-void handleGetWifi();
-void handleControlSTA();
+void handleSaveWifi(AsyncWebServerRequest* request);
+void handleGetWifi(AsyncWebServerRequest* request);
+void handleControlSTA(AsyncWebServerRequest* request);
 
 // ==================== SLAVE CONFIGURATION HANDLERS ====================
 
-void handleSaveSlaves();
-void handleGetSlaves();
-void handleGetSlaveConfig();
-void handleUpdateSlaveConfig();
-void handleSetQueryState();
+void handleSaveSlaves(AsyncWebServerRequest* request);
+void handleGetSlaves(AsyncWebServerRequest* request);
+void handleGetSlaveConfig(AsyncWebServerRequest* request);
+void handleUpdateSlaveConfig(AsyncWebServerRequest* request);
+void handlePatchSlave(AsyncWebServerRequest* request);
+void handleSetQueryState(AsyncWebServerRequest* request);
+
+// ==================== TEMPLATE HANDLERS ====================
+
+void handleGetTemplates(AsyncWebServerRequest* request);
+void handleSaveTemplate(AsyncWebServerRequest* request);
 
 // ==================== POLLING CONFIGURATION HANDLERS ====================
 
-void handleSavePollingConfig();
-void handleGetPollingConfig();
+void handleSavePollingConfig(AsyncWebServerRequest* request);
+void handleGetPollingConfig(AsyncWebServerRequest* request);
+
+// ==================== MQTT CONFIGURATION HANDLERS ====================
+
+void handleSaveMqttConfig(AsyncWebServerRequest* request);
+void handleGetMqttConfig(AsyncWebServerRequest* request);
+void handleGetQueueStats(AsyncWebServerRequest* request);
+
+// ==================== TIME CONFIGURATION HANDLERS ====================
+
+void handleSaveTimeConfig(AsyncWebServerRequest* request);
+void handleGetTimeConfig(AsyncWebServerRequest* request);
 
 // ==================== STATISTICS HANDLERS ====================
 
-void handleGetStatistics();
-void handleRemoveSlaveStats();
+void handleGetStatistics(AsyncWebServerRequest* request);
+void handleRemoveSlaveStats(AsyncWebServerRequest* request);
+
+// ==================== HISTORY HANDLERS ====================
+
+void handleGetHistory(AsyncWebServerRequest* request);
+void handleGetArchive(AsyncWebServerRequest* request);
 
 // ==================== DEBUG MANAGEMENT HANDLERS ====================
 
-void handleToggleDebug();
-void handleGetDebugState();
-void handleGetDebugMessages();
-void handleClearTable();
-void addDebugMessage(const char* topic, const char* message, const char* timeDelta, const char* sameDeviceDelta);
+void handleToggleDebug(AsyncWebServerRequest* request);
+void handleGetDebugState(AsyncWebServerRequest* request);
+void handleGetDebugMessages(AsyncWebServerRequest* request);
+void handleClearTable(AsyncWebServerRequest* request);
+void addDebugMessage(const char* topic, const char* message, const char* timeDelta, const char* sameDeviceDelta,
+                     uint8_t slaveId = 0, const char* slaveName = nullptr);
 
 // ==================== UTILITY FUNCTIONS ====================
 
@@ -92,6 +159,19 @@ String getContentType(const String& filename);
 
 // ==================== HELPER FUNCTIONS ====================
 
-void serveHtmlFile(const String& filename);
-void sendJsonResponse(const JsonDocument& doc);
-bool parseJsonBody(JsonDocument& doc);
\ No newline at end of file
+void sendJsonResponse(AsyncWebServerRequest* request, const JsonDocument& doc);
+void sendErrorResponse(AsyncWebServerRequest* request, const char* message);
+bool parseJsonBody(AsyncWebServerRequest* request, JsonDocument& doc);
+void collectRequestBody(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total);
+void releaseSlavesUpload(AsyncWebServerRequest* request);
+void streamSlavesUpload(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total);
+void deferRequest(AsyncWebServerRequest* request, DeferredHandler handler);
+void redeferRequest(AsyncWebServerRequest* request, DeferredHandler handler);
+
+// ==================== STREAMED RESPONSES ====================
+
+// Writes record `index` into out (separators are added by the stream); false once past the last record.
+// Leaving out empty and returning true means the record is not ready yet.
+typedef std::function<bool(size_t index, String& out)> JsonRecordSource;
+
+void sendJsonArrayStream(AsyncWebServerRequest* request, JsonRecordSource source, void (*onComplete)() = nullptr);
\ No newline at end of file
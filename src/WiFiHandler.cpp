@@ -1,5 +1,7 @@
 #include "WiFiHandler.h"
 #include "EEEProm.h"
+#include "ConfigStore.h"
+#include "SampleArchive.h"
 #include <ArduinoOTA.h>
 
 // ==================== GLOBAL VARIABLES ====================
@@ -17,6 +19,8 @@ void initializeOTA() {
     
     ArduinoOTA.onStart([]() {
         Serial.println("📦 OTA update started");
+        flushSlaveConfig();  // Pending edits must reach flash before the reboot
+        flushSampleArchive();
     });
     
     ArduinoOTA.onEnd([]() {
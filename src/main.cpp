@@ -8,6 +8,13 @@
 #include "MQTTHandler.h"
 #include "ModBusHandler.h"
 #include "TemplateInitializer.h"
+#include "HealthMonitor.h"
+#include "EventStream.h"
+#include "ConfigStore.h"
+#include "SampleArchive.h"
+#include "TaskScheduler.h"
+#include "TimeSync.h"
+#include "ConfigBlob.h"
 
 // ==================== SYSTEM INITIALIZATION ====================
 
@@ -36,31 +43,41 @@ void forceResetEEPROM() {
 
 void initializeSystem() {
     Serial.println("🎯 Starting ESP8266 System Initialization...");
+    markBootPhase("core");    // Reset to here: ROM, SDK and Serial
     
     // Phase 1: Core Storage & Filesystem
     Serial.println("📝 Phase 1: Initializing EEPROM...");
     initEEEPROM();
     loadWifi();
+    markBootPhase("eeprom");
     
     Serial.println("📁 Phase 2: Initializing File System...");
     if (!initFileSystem()) {
         Serial.println("❌ CRITICAL: File system initialization failed!");
         return;
     }
+    loadMqttConfig(mqttConfig);
+    loadTimeConfig(timeConfig);
+    initTimeSync(timeConfig.ntpServer);   // Syncs once STA is up; until then timestamps are uptime
+    initSampleArchive();
+    markBootPhase("fs");
     
     // Phase 2: Network Services  
     Serial.println("🌐 Phase 3: Starting Web Server...");
     setupWebServer();
+    markBootPhase("web");
     
     Serial.println("📡 Phase 4: Setting up WiFi (AP+STA mode, STA disconnected)...");
     setupWiFi();  // Now starts in AP_STA mode but STA is disconnected
     connectSTA();
+    markBootPhase("wifi");
     
     // Phase 3: Application Logic
     Serial.println("🔧 Phase 5: Initializing ModBus...");
     if (!initModbus()) {
         Serial.println("❌ ModBus initialization failed!");
     }
+    markBootPhase("modbus");
     
     // ✅ OPTIMIZED: Only create templates if they don't exist
     if (templatesNeedCreation()) {
@@ -69,17 +86,82 @@ void initializeSystem() {
             Serial.println("❌ Template creation failed!");
         }
     } else {
-        Serial.printf("📋 Phase 6: Templates already exist (%d templates)\n", getTemplateCount());
+        Serial.println("📋 Phase 6: Templates already exist");
     }
+    markBootPhase("templates");
     
+    // The compiled blob skips parsing slaves.json/templates.json; JSON is the fallback
     Serial.println("🔄 Phase 7: Loading slave configurations...");
-    if (!modbusReloadSlaves()) {
+    if (loadConfigBlob()) {
+        recordSlavesReady(true);
+    } else if (modbusReloadSlaves()) {
+        recordSlavesReady(false);
+        markConfigBlobStale();   // Compiled on the first config task pass
+    } else {
         Serial.println("⚠️  No slave configurations loaded");
     }
+    markBootPhase("slaves");
     
     Serial.println("✅ System fully initialized!");
     Serial.println("📍 AP Mode: Active - Connect to configure device");
     Serial.println("🔌 STA Mode: Ready - Use web interface to connect manually");
+    if (modbusQueriesEnabled && slaveCount > 0) {
+        Serial.println("▶️  Polling resumes now - readings queue until MQTT is up");
+    }
+}
+
+// ==================== SCHEDULED TASKS ====================
+
+unsigned long modbusDueIn(unsigned long now) {
+    // ✅ EFFICIENT: Only process ModBus if slaves are configured
+    if (slaveCount == 0 || !modbusQueriesEnabled) return hasPendingBusCommand() ? 0 : kTaskNeverDue;
+    return getModbusDueIn(now);
+}
+
+void serviceModbusTask() {
+    // Polling off: the bus is idle, so a remote command runs on its own
+    if (slaveCount == 0 || !modbusQueriesEnabled) {
+        if (hasPendingBusCommand()) serviceBusCommand();
+        return;
+    }
+    updateNonBlockingQuery();
+}
+
+unsigned long deferredRequestsDueIn(unsigned long now) {
+    return hasDeferredRequests() ? 0 : kTaskNeverDue;
+}
+
+void serviceMQTTTask() {
+    // ✅ USE HELPER: Only check MQTT if WiFi is up
+    if (isWiFiConnected()) {
+        checkMQTT();
+    }
+}
+
+void serviceConfigTask() {
+    serviceConfigStore();
+    serviceConfigBlob();
+}
+
+void serviceHealthTask() {
+    if (isWiFiConnected()) {
+        serviceHealthMonitor();
+    }
+}
+
+void setupTasks() {
+    // The bus comes first: once a poll slot or response is due, web work waits for the next pass
+    addDeadlineTask("modbus", serviceModbusTask, TASK_PRIORITY_HIGH, modbusDueIn, 400000);
+    
+    addDeadlineTask("web", serviceDeferredRequests, TASK_PRIORITY_NORMAL, deferredRequestsDueIn, 20000);
+    addPeriodicTask("mqtt", serviceMQTTTask, TASK_PRIORITY_NORMAL, 5, 10000);
+    addPeriodicTask("ota", handleOTA, TASK_PRIORITY_NORMAL, 20, 2000);
+    addPeriodicTask("wifi", checkWiFi, TASK_PRIORITY_NORMAL, 100, 5000);
+    
+    addPeriodicTask("events", serviceEventStream, TASK_PRIORITY_LOW, 250, 5000);
+    addPeriodicTask("config", serviceConfigTask, TASK_PRIORITY_LOW, 250, 50000);
+    addPeriodicTask("archive", serviceSampleArchive, TASK_PRIORITY_LOW, 100, 20000);
+    addPeriodicTask("health", serviceHealthTask, TASK_PRIORITY_LOW, 1000, 10000);
 }
 
 // ==================== ARDUINO MAIN FUNCTIONS ====================
@@ -90,6 +172,8 @@ void setup() {
     Serial.printf("📊 Free Heap: %d bytes\n", ESP.getFreeHeap());
     
     initializeSystem();
+    setupTasks();
+    markBootPhase("tasks");
 
     //forceResetEEPROM();  // ⬅️ UNCOMMENT THIS LINE FOR FIRST RUN
     
@@ -97,21 +181,5 @@ void setup() {
 }
 
 void loop() {
-    server.handleClient();    // Handle web requests
-    checkWiFi();              // Maintain WiFi connection (non-blocking STA checks)
-    handleOTA(); 
-
-    // ✅ USE HELPER: Only check MQTT if WiFi is up
-    if (isWiFiConnected()) {  
-        checkMQTT();          // Maintain MQTT connection
-    }
-    
-    // ✅ EFFICIENT: Only process ModBus if slaves are configured
-    if (slaveCount > 0 && modbusQueriesEnabled) {
-        updateNonBlockingQuery(); // Process ModBus queries
-    }
-    
-    // OTA handled inside checkWiFi() when STA is connected
-
-    delay(10); // Small delay for stability
-}
\ No newline at end of file
+    runSchedulerPass();   // Due tasks by priority, then sleep until the next deadline
+}
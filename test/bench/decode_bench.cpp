@@ -0,0 +1,101 @@
+// Decode hot path: the hand-written per-device decoders of 7295312 vs
+// runDecodeProgram over the built-in register maps, on the same registers.
+// Build with -DOLD_PATH for the old tree; run_decode_bench.sh does both.
+#include "ModBusHandler.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <algorithm>
+#include <vector>
+
+size_t allocCount = 0;
+void* operator new(size_t n) { allocCount++; void* p = malloc(n); if (!p) throw std::bad_alloc(); return p; }
+void* operator new[](size_t n) { allocCount++; void* p = malloc(n); if (!p) throw std::bad_alloc(); return p; }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+constexpr int kMaxResponse = 64;
+uint16_t response[kMaxResponse];
+ModbusMaster node;
+uint16_t ModbusMaster::getResponseBuffer(uint8_t i) { return response[i]; }
+
+#ifdef OLD_PATH
+#define CLEANUP(ptr) do { if(ptr) { delete[] ptr; ptr = nullptr; } } while(0)
+const DeviceParams kDefaultDeviceParams = {};
+#include "old_decode.body"
+#else
+#include "new_decode.body"
+#endif
+
+struct Case { const char* type; int device; int fields; int regSize; };
+const Case kCases[] = {
+    { "G01S", 0, 2, 1 }, { "HeylaParam", 1, 20, 1 }, { "HeylaParam", 1, 20, 2 },
+    { "HeylaVoltage", 2, 5, 2 }, { "HeylaEnergy9", 3, 6, 2 }, { "HeylaEnergy27", 4, 3, 2 }
+};
+
+int main(int argc, char** argv) {
+    const int kIterations = 200000;
+    uint32_t seed = 12345;
+    for (int i = 0; i < kMaxResponse; i++) { seed = seed * 1103515245 + 12345; response[i] = seed >> 16; }
+
+    for (int sink = 0; sink < 2; sink++) {
+        for (const Case& c : kCases) {
+            SensorSlave slave;
+            slave.registerCount = c.fields * c.regSize;
+            slave.ct = 1.0f;
+            slave.pt = 1.0f;
+#ifdef OLD_PATH
+            static DeviceParams params;
+            float* p = reinterpret_cast<float*>(&params);
+            for (size_t i = 0; i < sizeof(params) / sizeof(float); i++) p[i] = 1.0f;
+            slave.config = &params;
+            slave.deviceType = (DeviceType)c.device;
+            slave.registerSize = (RegisterSize)c.regSize;
+#else
+            static DeviceParams params;
+            for (float& v : params.values) v = 1.0f;
+            uint8_t count;
+            const RegisterField* builtin = findBuiltinRegisterMap(c.type, count);
+            std::vector<RegisterField> fields(builtin, builtin + count);
+            for (RegisterField& f : fields) f.param = 0;
+            size_t namesLength = 0;
+            for (RegisterField& f : fields) namesLength += strlen(f.name) + 1;
+            DecodeProgram* program = new DecodeProgram();
+            program->ops = new DecodeOp[count];
+            program->names = new char[namesLength];
+            program->opCount = count;
+            program->registerSize = c.regSize;
+            buildDecodeOps(fields.data(), count, c.regSize, program->ops, program->names);
+            slave.program = program;
+            slave.config = &params;
+            slave.registerSize = (RegisterSize)c.regSize;
+#endif
+            JsonVariant::sinkMode = sink;
+            std::vector<double> perDecode;
+            double checksum = 0;
+            size_t allocs = 0;
+            for (int round = 0; round < 21; round++) {
+                JsonVariant::sinkSum = 0;
+                size_t before = allocCount;
+                auto start = std::chrono::steady_clock::now();
+                for (int i = 0; i < kIterations / 20; i++) {
+                    JsonDocument doc;
+                    JsonObject root = doc.to<JsonObject>();
+                    decodeSlaveData(slave, root);
+                    if (!sink && i == 0 && round == 0) { for (JsonPair kv : root) checksum += kv.value().as<float>(); }
+                }
+                auto end = std::chrono::steady_clock::now();
+                allocs = (allocCount - before) / (kIterations / 20);
+                perDecode.push_back(std::chrono::duration<double, std::nano>(end - start).count() / (kIterations / 20));
+                if (sink) checksum = JsonVariant::sinkSum / (kIterations / 20);
+            }
+            std::sort(perDecode.begin(), perDecode.end());
+            printf("%-5s %-14s size %d: median %7.1f ns/decode  allocs/decode %zu  checksum %.4f\n",
+                   sink ? "sink" : "dom", c.type, c.regSize, perDecode[perDecode.size() / 2], allocs, checksum);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,41 @@
+#!/usr/bin/env python3
+"""Pull free functions out of a firmware source file so a host bench can link
+them without the rest of the module (WiFi, MQTT, LittleFS).
+
+  extract_functions.py FILE NAME...     print the named functions
+  extract_functions.py --no-fs IN OUT   copy IN with loadTemplates() stubbed out
+"""
+import re
+import sys
+
+
+def extract(path, names):
+    lines = open(path).read().split('\n')
+    out = []
+    for name in names:
+        pattern = re.compile(r'^\w[\w:<>&\* ]*\b' + re.escape(name) + r'\(')
+        for i, line in enumerate(lines):
+            if pattern.match(line) and line.rstrip().endswith('{'):
+                j = i
+                while lines[j] != '}':
+                    j += 1
+                out.append('\n'.join(lines[i:j + 1]))
+                break
+        else:
+            sys.exit('missing ' + name)
+    return '\n\n'.join(out)
+
+
+def strip_fs(source, target):
+    text = open(source).read()
+    # The bench fills the template cache itself; loadTemplates() never reads flash
+    text = re.sub(r'(bool loadTemplates\(JsonDocument& templates\) \{).*?\n\}',
+                  r'\1\n    return false;\n}', text, flags=re.S)
+    open(target, 'w').write(text)
+
+
+if __name__ == '__main__':
+    if sys.argv[1] == '--no-fs':
+        strip_fs(sys.argv[2], sys.argv[3])
+    else:
+        print(extract(sys.argv[1], sys.argv[2:]))
@@ -0,0 +1,69 @@
+#pragma once
+#include <math.h>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <ctime>
+#include <sys/time.h>
+#include <algorithm>
+#include <functional>
+#include <utility>
+typedef uint8_t byte;
+#define HIGH 1
+#define LOW 0
+#define OUTPUT 1
+#define INPUT 0
+#define PROGMEM
+#define F(x) x
+#define PSTR(x) x
+#define FPSTR(x) x
+#define ICACHE_RAM_ATTR
+#define IRAM_ATTR
+class __FlashStringHelper;
+#include <string>
+class String {
+public:
+  std::string v;
+  String() {} String(const char* s) : v(s ? s : "") {} String(const String& o) : v(o.v) {} String(char c) : v(1, c) {}
+  String(int n, unsigned char = 10) : v(std::to_string(n)) {} String(unsigned int n, unsigned char = 10) : v(std::to_string(n)) {}
+  String(long n, unsigned char = 10) : v(std::to_string(n)) {} String(unsigned long n, unsigned char = 10) : v(std::to_string(n)) {}
+  String(long long n) : v(std::to_string(n)) {} String(unsigned long long n) : v(std::to_string(n)) {}
+  String(float f, unsigned char = 2) : v(std::to_string(f)) {} String(double f, unsigned char = 2) : v(std::to_string(f)) {}
+  String& operator=(const String& o) { v = o.v; return *this; } String& operator=(const char* s) { v = s ? s : ""; return *this; }
+  const char* c_str() const { return v.c_str(); } unsigned int length() const { return v.size(); } bool reserve(unsigned int n) { v.reserve(n); return true; }
+  String& operator+=(const String& o) { v += o.v; return *this; } String& operator+=(const char* s) { v += s; return *this; } String& operator+=(char c) { v += c; return *this; }
+  String& operator+=(int n) { v += std::to_string(n); return *this; } String& operator+=(unsigned long n) { v += std::to_string(n); return *this; }
+  String& operator+=(unsigned int n) { v += std::to_string(n); return *this; } String& operator+=(long n) { v += std::to_string(n); return *this; }
+  bool concat(const char* s, unsigned int n) { v.append(s, n); return true; } bool concat(const String& o) { v += o.v; return true; } bool concat(char c) { v += c; return true; }
+  bool isEmpty() const { return v.empty(); } void clear() { v.clear(); }
+  bool operator==(const String& o) const { return v == o.v; } bool operator==(const char* s) const { return v == s; }
+  bool operator!=(const String& o) const { return v != o.v; } bool operator!=(const char* s) const { return v != s; }
+  bool operator<(const String& o) const { return v < o.v; }
+  char operator[](unsigned int i) const { return v[i]; } char& operator[](unsigned int i) { return v[i]; }
+};
+inline String operator+(const String& a, const String& b) { String r(a); r += b; return r; }
+inline String operator+(const char* a, const String& b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, const char* b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, char b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, int b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, unsigned long b) { String r(a); r += b; return r; }
+class Print { public:
+  // Logging is discarded on the host so it does not skew timings
+  template<class... A> size_t printf(const char*, A...) { return 0; } template<class T> size_t print(const T&) { return 0; }
+  template<class T> size_t print(const T&, int) { return 0; } template<class T> size_t println(const T&) { return 0; }
+  template<class T> size_t println(const T&, int) { return 0; } size_t println() { return 0; }
+  virtual size_t write(uint8_t); virtual size_t write(const uint8_t*, size_t); size_t write(const char*, size_t); virtual void flush(); };
+class Stream : public Print { public: virtual int available(); virtual int read(); virtual int peek(); size_t readBytes(char*, size_t); size_t readBytes(uint8_t*, size_t); String readString(); String readStringUntil(char); void setTimeout(unsigned long); };
+class HardwareSerial : public Stream { public: void begin(unsigned long); operator bool() const; };
+extern HardwareSerial Serial;
+class EspClass { public: uint32_t getFreeHeap(); uint8_t getHeapFragmentation(); uint32_t getMaxFreeBlockSize(); uint32_t getChipId(); void restart(); void getHeapStats(uint32_t*, uint16_t*, uint8_t*); uint32_t getCycleCount(); uint32_t random(); String getResetReason(); };
+extern EspClass ESP;
+unsigned long millis(); unsigned long micros(); void delay(unsigned long); void delayMicroseconds(unsigned int); void yield(); void pinMode(uint8_t,uint8_t); void digitalWrite(uint8_t,uint8_t);
+void configTime(int, int, const char*, const char* = nullptr, const char* = nullptr); void configTime(const char*, const char*, const char* = nullptr, const char* = nullptr);
+void settimeofday_cb(std::function<void()>);
+template<class T> T constrain(T a, T l, T h){return a<l?l:(a>h?h:a);}
+size_t strlcpy(char*, const char*, size_t);
+using std::min; using std::max;
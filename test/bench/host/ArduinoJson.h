@@ -0,0 +1,322 @@
+#pragma once
+// Host stand-in for the ArduinoJson v7 subset the template code uses. Objects are
+// member lists searched linearly, as in ArduinoJson; every node is a heap
+// allocation (counted by the benchmark's operator new).
+#include <Arduino.h>
+#include <cstring>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+#include <type_traits>
+
+struct JNode {
+    enum Type { Null, Obj, Arr, Bool, Int, Flt, Str } type = Null;
+    bool b = false; long long i = 0; double f = 0; std::string s;
+    std::vector<std::pair<std::string, JNode*>> members;
+    std::vector<JNode*> items;
+    void reset() { for (auto& m : members) delete m.second; for (auto* n : items) delete n; members.clear(); items.clear(); s.clear(); type = Null; }
+    ~JNode() { reset(); }
+    JNode* find(const char* k) const { for (auto& m : members) if (m.first == k) return m.second; return nullptr; }
+    void copyFrom(const JNode* o) {
+        reset(); if (!o) return; type = o->type; b = o->b; i = o->i; f = o->f; s = o->s;
+        for (auto& m : o->members) { JNode* n = new JNode(); n->copyFrom(m.second); members.push_back({m.first, n}); }
+        for (auto* it : o->items) { JNode* n = new JNode(); n->copyFrom(it); items.push_back(n); }
+    }
+};
+
+// Lazily-created location: an existing node, or a key/index under a parent location
+struct JRef {
+    JNode* node = nullptr;
+    std::shared_ptr<JRef> parent; std::string key; long index = -1;
+    JNode* resolve() const {
+        if (node || !parent) return node;
+        JNode* p = parent->resolve();
+        if (!p) return nullptr;
+        if (index >= 0) return (p->type == JNode::Arr && (size_t)index < p->items.size()) ? p->items[index] : nullptr;
+        return p->type == JNode::Obj ? p->find(key.c_str()) : nullptr;
+    }
+    JNode* materialize() {
+        JNode* n = resolve();
+        if (n) return node = n;
+        if (!parent) return nullptr;
+        JNode* p = parent->materialize();
+        if (!p) return nullptr;
+        if (index >= 0) {
+            if (p->type == JNode::Null) p->type = JNode::Arr;
+            if (p->type != JNode::Arr) return nullptr;
+            while (p->items.size() <= (size_t)index) p->items.push_back(new JNode());
+            return node = p->items[index];
+        }
+        if (p->type == JNode::Null) p->type = JNode::Obj;
+        if (p->type != JNode::Obj) return nullptr;
+        n = new JNode(); p->members.push_back({key, n});
+        return node = n;
+    }
+};
+
+// Handles are stack values in ArduinoJson; keep their control blocks out of the heap counts
+template <typename T> struct JUncounted {
+    typedef T value_type;
+    JUncounted() {}
+    template <typename U> JUncounted(const JUncounted<U>&) {}
+    T* allocate(size_t n) { return static_cast<T*>(malloc(n * sizeof(T))); }
+    void deallocate(T* p, size_t) { free(p); }
+    template <typename U> bool operator==(const JUncounted<U>&) const { return true; }
+    template <typename U> bool operator!=(const JUncounted<U>&) const { return false; }
+};
+inline std::shared_ptr<JRef> newRef() { return std::allocate_shared<JRef>(JUncounted<JRef>()); }
+
+class JsonObject; class JsonArray; class JsonObjectConst; class JsonArrayConst; class JsonDocument;
+struct JsonPair; struct JsonPairIt; struct JsonVarIt;
+
+class JsonString {
+public:
+    const char* str = nullptr;
+    JsonString() {}
+    JsonString(const char* s) : str(s) {}
+    const char* c_str() const { return str; }
+    size_t size() const { return str ? strlen(str) : 0; }
+    bool operator==(const char* o) const { return strcmp(str, o) == 0; }
+};
+
+class JsonVariant {
+public:
+    std::shared_ptr<JRef> ref;
+    JsonVariant() : ref(newRef()) {}
+    explicit JsonVariant(JNode* n) : ref(newRef()) { ref->node = n; }
+    JNode* node() const { return ref->resolve(); }
+
+    // Bench sink: decoders write every value through root[...] = float; in sink mode the
+    // write only folds the value into a checksum, so the DOM cost drops out.
+    static inline bool sinkMode = false;
+    static inline double sinkSum = 0;
+    static inline unsigned long sinkWrites = 0;
+    static const JsonVariant& sinkVariant() { static JsonVariant v; return v; }
+
+    JsonVariant child(const char* key) const {
+        if (sinkMode) return sinkVariant();
+        JsonVariant v; v.ref->parent = ref; v.ref->key = key;
+        JNode* n = node();
+        if (n && n->type == JNode::Obj) v.ref->node = n->find(key);
+        return v;
+    }
+    JsonVariant operator[](const char* key) const { return child(key); }
+    JsonVariant operator[](char* key) const { return child(key); }
+    JsonVariant operator[](const String& key) const { return child(key.c_str()); }
+    JsonVariant operator[](JsonString key) const { return child(key.c_str()); }
+    template <typename I, typename = typename std::enable_if<std::is_integral<I>::value>::type>
+    JsonVariant operator[](I index) const {
+        JsonVariant v; v.ref->parent = ref; v.ref->index = (long)index;
+        JNode* n = node();
+        if (n && n->type == JNode::Arr && (size_t)index < n->items.size()) v.ref->node = n->items[index];
+        return v;
+    }
+
+    bool isNull() const { JNode* n = node(); return !n || n->type == JNode::Null; }
+    size_t size() const { JNode* n = node(); if (!n) return 0; return n->type == JNode::Obj ? n->members.size() : n->type == JNode::Arr ? n->items.size() : 0; }
+    void clear() { JNode* n = node(); if (n) n->reset(); }
+    void remove(const char* key) {
+        JNode* n = node(); if (!n || n->type != JNode::Obj) return;
+        for (auto it = n->members.begin(); it != n->members.end(); ++it) if (it->first == key) { delete it->second; n->members.erase(it); return; }
+    }
+    void remove(const String& key) { remove(key.c_str()); }
+
+    template <typename T> bool is() const;
+    template <typename T> T as() const;
+    template <typename T> T to();
+    template <typename T> operator T() const { return as<T>(); }
+
+    bool set(const JsonVariant& other) {
+        JNode* n = ref->materialize(); if (!n) return false;
+        JNode* src = other.node();
+        if (src == n) return true;
+        JNode tmp; tmp.copyFrom(src); n->copyFrom(&tmp); return true;
+    }
+    template <typename T> bool set(const T& value) { return assign(value); }
+    // Copy-assignment rebinds the handle, as in ArduinoJson; assigning another type copies the value
+    JsonVariant(const JsonVariant&) = default;
+    JsonVariant& operator=(const JsonVariant&) = default;
+    template <typename T> JsonVariant& operator=(const T& value) { assign(value); return *this; }
+
+    template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+    T operator|(T fallback) const { return is<T>() ? as<T>() : fallback; }
+    const char* operator|(const char* fallback) const { return is<const char*>() ? as<const char*>() : fallback; }
+    String operator|(const String& fallback) const { return is<const char*>() ? String(as<const char*>()) : fallback; }
+    JsonVariant operator|(const JsonVariant& fallback) const { return isNull() ? fallback : *this; }
+
+    template <typename T> T add();
+    template <typename T> bool add(const T& value) {
+        JNode* n = ref->materialize(); if (!n) return false;
+        if (n->type == JNode::Null) n->type = JNode::Arr;
+        JsonVariant v; v.ref->parent = ref; v.ref->index = n->items.size();
+        return v.assign(value);
+    }
+
+private:
+    template <typename T> bool assign(const T& value) {
+        if constexpr (std::is_base_of<JsonVariant, T>::value) return set(static_cast<const JsonVariant&>(value));
+        if constexpr (std::is_arithmetic<T>::value) { if (sinkMode) { sinkSum += value; sinkWrites++; return true; } }
+        JNode* n = ref->materialize(); if (!n) return false;
+        n->reset();
+        if constexpr (std::is_same<T, bool>::value) { n->type = JNode::Bool; n->b = value; }
+        else if constexpr (std::is_integral<T>::value) { n->type = JNode::Int; n->i = value; }
+        else if constexpr (std::is_floating_point<T>::value) { n->type = JNode::Flt; n->f = value; }
+        else if constexpr (std::is_same<T, String>::value) { n->type = JNode::Str; n->s = value.c_str(); }
+        else if constexpr (std::is_convertible<T, const char*>::value) {
+            const char* s = value; if (s) { n->type = JNode::Str; n->s = s; }
+        } else if constexpr (!std::is_base_of<JsonVariant, T>::value) static_assert(sizeof(T) == 0, "unsupported");
+        return true;
+    }
+};
+
+inline bool operator==(const JsonVariant& a, const JsonVariant& b) {
+    JNode* x = a.node(); JNode* y = b.node();
+    if (!x || !y) return x == y;
+    if ((x->type == JNode::Int || x->type == JNode::Flt) && (y->type == JNode::Int || y->type == JNode::Flt))
+        return (x->type == JNode::Int ? (double)x->i : x->f) == (y->type == JNode::Int ? (double)y->i : y->f);
+    if (x->type != y->type) return false;
+    return x->type == JNode::Str ? x->s == y->s : x->type == JNode::Bool ? x->b == y->b : x == y;
+}
+class JsonVariantConst : public JsonVariant { public: JsonVariantConst() {} JsonVariantConst(const JsonVariant& v) : JsonVariant(v) {} };
+
+struct JsonPair {
+    JsonString k; JsonVariant v;
+    JsonString key() const { return k; }
+    JsonVariant value() const { return v; }
+};
+typedef JsonPair JsonPairConst;
+
+struct JsonPairIt {
+    JNode* obj; size_t pos;
+    JsonPair operator*() const { JsonPair p; p.k = JsonString(obj->members[pos].first.c_str()); p.v = JsonVariant(obj->members[pos].second); return p; }
+    JsonPairIt& operator++() { pos++; return *this; }
+    bool operator!=(const JsonPairIt& o) const { return pos != o.pos; }
+};
+struct JsonVarIt {
+    JNode* arr; size_t pos;
+    JsonVariant operator*() const { return JsonVariant(arr->items[pos]); }
+    JsonVarIt& operator++() { pos++; return *this; }
+    bool operator!=(const JsonVarIt& o) const { return pos != o.pos; }
+};
+
+class JsonObject : public JsonVariant {
+public:
+    JsonObject() {}
+    JsonObject(const JsonVariant& v) : JsonVariant(v) { JNode* n = node(); if (n && n->type != JNode::Obj) ref = newRef(); }
+    JsonPairIt begin() const { JNode* n = node(); return { n, 0 }; }
+    JsonPairIt end() const { JNode* n = node(); return { n, n ? n->members.size() : 0 }; }
+};
+class JsonObjectConst : public JsonObject { public: JsonObjectConst() {} JsonObjectConst(const JsonVariant& v) : JsonObject(v) {} };
+class JsonArray : public JsonVariant {
+public:
+    JsonArray() {}
+    JsonArray(const JsonVariant& v) : JsonVariant(v) { JNode* n = node(); if (n && n->type != JNode::Arr) ref = newRef(); }
+    JsonVarIt begin() const { JNode* n = node(); return { n, 0 }; }
+    JsonVarIt end() const { JNode* n = node(); return { n, n ? n->items.size() : 0 }; }
+};
+class JsonArrayConst : public JsonArray { public: JsonArrayConst() {} JsonArrayConst(const JsonVariant& v) : JsonArray(v) {} };
+
+template <typename T> bool JsonVariant::is() const {
+    JNode* n = node(); if (!n) return false;
+    if constexpr (std::is_base_of<JsonObject, T>::value) return n->type == JNode::Obj;
+    else if constexpr (std::is_base_of<JsonArray, T>::value) return n->type == JNode::Arr;
+    else if constexpr (std::is_same<T, bool>::value) return n->type == JNode::Bool;
+    else if constexpr (std::is_integral<T>::value) return n->type == JNode::Int;
+    else if constexpr (std::is_floating_point<T>::value) return n->type == JNode::Int || n->type == JNode::Flt;
+    else if constexpr (std::is_same<T, const char*>::value || std::is_same<T, String>::value) return n->type == JNode::Str;
+    else return false;
+}
+template <typename T> T JsonVariant::as() const {
+    JNode* n = node();
+    if constexpr (std::is_base_of<JsonVariant, T>::value) return T(*this);
+    else if constexpr (std::is_same<T, bool>::value) return n && n->type == JNode::Bool && n->b;
+    else if constexpr (std::is_arithmetic<T>::value) {
+        if (!n) return T(0);
+        if (n->type == JNode::Int) return (T)n->i;
+        if (n->type == JNode::Flt) return (T)n->f;
+        return T(0);
+    }
+    else if constexpr (std::is_same<T, const char*>::value) return (n && n->type == JNode::Str) ? n->s.c_str() : nullptr;
+    else if constexpr (std::is_same<T, String>::value) return (n && n->type == JNode::Str) ? String(n->s.c_str()) : String("null");
+    else static_assert(sizeof(T) == 0, "unsupported");
+}
+template <typename T> T JsonVariant::to() {
+    JNode* n = ref->materialize();
+    if (n) { n->reset(); n->type = std::is_base_of<JsonArray, T>::value ? JNode::Arr : JNode::Obj; }
+    return T(*this);
+}
+template <typename T> T JsonVariant::add() {
+    JNode* n = ref->materialize();
+    if (n->type == JNode::Null) n->type = JNode::Arr;
+    JsonVariant v; v.ref->parent = ref; v.ref->index = n->items.size();
+    return v.to<T>();
+}
+
+class JsonDocument : public JsonVariant {
+public:
+    std::unique_ptr<JNode> root;
+    JsonDocument() : root(new JNode()) { ref->node = root.get(); }
+    JsonDocument(const JsonDocument& o) : JsonDocument() { root->copyFrom(o.root.get()); }
+    JsonDocument& operator=(const JsonDocument& o) { root->copyFrom(o.root.get()); return *this; }
+    template <typename T> JsonDocument& operator=(const T& v) { JsonVariant::operator=(v); return *this; }
+    void clear() { root->reset(); }
+};
+
+struct DeserializationError {
+    enum Code { Ok, EmptyInput, IncompleteInput, InvalidInput, NoMemory, TooDeep } code_ = Ok;
+    explicit operator bool() const { return code_ != Ok; }
+    const char* c_str() const { return code_ == Ok ? "Ok" : "InvalidInput"; }
+    Code code() const { return code_; }
+    bool operator==(Code c) const { return code_ == c; }
+    bool operator!=(Code c) const { return code_ != c; }
+};
+
+namespace jsonmini {
+inline void ws(const char*& p) { while (*p == ' ' || *p == '\n' || *p == '\t' || *p == '\r') p++; }
+inline bool parse(const char*& p, JNode* n) {
+    ws(p);
+    if (*p == '{') {
+        n->type = JNode::Obj; p++; ws(p);
+        if (*p == '}') { p++; return true; }
+        for (;;) {
+            ws(p); if (*p != '"') return false;
+            const char* e = strchr(p + 1, '"'); std::string key(p + 1, e); p = e + 1; ws(p);
+            if (*p++ != ':') return false;
+            JNode* c = new JNode(); n->members.push_back({key, c});
+            if (!parse(p, c)) return false;
+            ws(p); if (*p == ',') { p++; continue; } if (*p == '}') { p++; return true; } return false;
+        }
+    }
+    if (*p == '[') {
+        n->type = JNode::Arr; p++; ws(p);
+        if (*p == ']') { p++; return true; }
+        for (;;) {
+            JNode* c = new JNode(); n->items.push_back(c);
+            if (!parse(p, c)) return false;
+            ws(p); if (*p == ',') { p++; continue; } if (*p == ']') { p++; return true; } return false;
+        }
+    }
+    if (*p == '"') { const char* e = strchr(p + 1, '"'); n->type = JNode::Str; n->s.assign(p + 1, e); p = e + 1; return true; }
+    if (!strncmp(p, "true", 4)) { n->type = JNode::Bool; n->b = true; p += 4; return true; }
+    if (!strncmp(p, "false", 5)) { n->type = JNode::Bool; n->b = false; p += 5; return true; }
+    if (!strncmp(p, "null", 4)) { p += 4; return true; }
+    char* end; const char* start = p;
+    long long iv = strtoll(p, &end, 10);
+    if (*end == '.' || *end == 'e' || *end == 'E') { n->type = JNode::Flt; n->f = strtod(start, &end); }
+    else { n->type = JNode::Int; n->i = iv; }
+    if (end == start) return false;
+    p = end; return true;
+}
+}
+
+inline DeserializationError deserializeJson(JsonDocument& doc, const char* text) {
+    DeserializationError err; doc.root->reset(); const char* p = text;
+    if (!jsonmini::parse(p, doc.root.get())) err.code_ = DeserializationError::InvalidInput;
+    return err;
+}
+inline DeserializationError deserializeJson(JsonDocument& doc, const String& text) { return deserializeJson(doc, text.c_str()); }
+template <typename T> DeserializationError deserializeJson(JsonDocument&, T&) { DeserializationError e; e.code_ = DeserializationError::InvalidInput; return e; }
+template <typename T> size_t serializeJson(const JsonVariant&, T&) { return 0; }
+inline size_t serializeJson(const JsonVariant&, char*, size_t) { return 0; }
+inline size_t measureJson(const JsonVariant&) { return 0; }
@@ -0,0 +1,5 @@
+#pragma once
+#include <Arduino.h>
+typedef int ota_error_t;
+class ArduinoOTAClass { public: void onStart(std::function<void()>); void onEnd(std::function<void()>); void onProgress(std::function<void(unsigned,unsigned)>); void onError(std::function<void(ota_error_t)>); void begin(); void handle(); };
+extern ArduinoOTAClass ArduinoOTA;
@@ -0,0 +1,4 @@
+#pragma once
+#include <Arduino.h>
+class EEPROMClass { public: void begin(size_t); template<class T> T& get(int, T&); template<class T> const T& put(int, const T&); bool commit(); bool end(); uint8_t read(int); void write(int, uint8_t); };
+extern EEPROMClass EEPROM;
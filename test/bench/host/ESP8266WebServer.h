@@ -0,0 +1,16 @@
+#pragma once
+#include <ESP8266WiFi.h>
+#include <FS.h>
+enum HTTPMethod { HTTP_ANY, HTTP_GET, HTTP_HEAD, HTTP_POST, HTTP_PUT, HTTP_PATCH, HTTP_DELETE, HTTP_OPTIONS };
+enum HTTPUploadStatus { UPLOAD_FILE_START, UPLOAD_FILE_WRITE, UPLOAD_FILE_END, UPLOAD_FILE_ABORTED };
+enum HTTPRawStatus { RAW_START, RAW_WRITE, RAW_END, RAW_ABORTED };
+struct HTTPUpload { HTTPUploadStatus status; String type, filename, name; size_t totalSize, currentSize, contentLength; uint8_t buf[2048]; };
+struct HTTPRaw { HTTPRawStatus status; size_t totalSize, currentSize; uint8_t buf[1460]; void* data; };
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+#define CONTENT_LENGTH_NOT_SET ((size_t)-2)
+class ESP8266WebServer { public: typedef std::function<void()> THandlerFunction; ESP8266WebServer(int);
+  void on(const char*, THandlerFunction); void on(const char*, HTTPMethod, THandlerFunction); void on(const char*, HTTPMethod, THandlerFunction, THandlerFunction); void onNotFound(THandlerFunction);
+  void send(int, const char*, const String&); void send(int, const String&, const String&); void send(int, const char*, const char*); void send(int, const char*, const char*, size_t); void send(int); void send(int, const char*); void send_P(int, const char*, const char*, size_t);
+  String arg(const String&); String arg(int); bool hasArg(const String&); int args(); String uri(); HTTPMethod method(); String header(const String&); bool hasHeader(const String&); void collectHeaders(const char**, size_t);
+  template<class T> size_t streamFile(T&, const String&, int code=200); void sendHeader(const String&, const String&, bool first=false); void setContentLength(size_t); void sendContent(const String&); void sendContent(const char*, size_t); void sendContent(const char*);
+  void begin(); void handleClient(); HTTPUpload& upload(); HTTPRaw& raw(); WiFiClient& client(); };
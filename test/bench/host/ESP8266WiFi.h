@@ -0,0 +1,6 @@
+#pragma once
+#include <WiFiClient.h>
+enum WiFiMode_t { WIFI_OFF, WIFI_STA, WIFI_AP, WIFI_AP_STA };
+enum wl_status_t { WL_IDLE_STATUS, WL_CONNECTED, WL_DISCONNECTED };
+class ESP8266WiFiClass { public: wl_status_t status(); IPAddress localIP(); IPAddress subnetMask(); IPAddress gatewayIP(); IPAddress softAPIP(); uint8_t softAPgetStationNum(); int32_t RSSI(); bool mode(WiFiMode_t); bool softAP(const char*, const char*); wl_status_t begin(const char*, const char*); bool disconnect(bool=false); String macAddress(); String hostname(); void setSleepMode(int); void setAutoReconnect(bool); };
+extern ESP8266WiFiClass WiFi;
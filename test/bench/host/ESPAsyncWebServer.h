@@ -0,0 +1,45 @@
+#pragma once
+#define RESPONSE_TRY_AGAIN 0xFFFFFFFF
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <FS.h>
+#include <functional>
+typedef enum { HTTP_GET=0b1, HTTP_POST=0b10, HTTP_DELETE=0b100, HTTP_PUT=0b1000, HTTP_PATCH=0b10000, HTTP_HEAD=0b100000, HTTP_OPTIONS=0b1000000, HTTP_ANY=0b1111111 } WebRequestMethod;
+typedef uint8_t WebRequestMethodComposite;
+class AsyncWebServerRequest;
+class AsyncWebHeader { public: const String& name() const; const String& value() const; };
+class AsyncWebParameter { public: const String& name() const; const String& value() const; };
+class AsyncWebServerResponse { public: virtual ~AsyncWebServerResponse(); void addHeader(const String&, const String&); void setCode(int); void setContentLength(size_t); };
+class AsyncResponseStream : public AsyncWebServerResponse, public Print { public: size_t write(uint8_t) override; size_t write(const uint8_t*, size_t) override; using Print::write; };
+typedef std::function<size_t(uint8_t*, size_t, size_t)> AwsResponseFiller;
+typedef std::function<void(void)> ArDisconnectHandler;
+class AsyncWebServerRequest { public: void* _tempObject; File _tempFile;
+  const String& url() const; WebRequestMethodComposite method() const; const char* methodToString() const;
+  void send(int code, const String& contentType=String(), const String& content=String());
+  void send(AsyncWebServerResponse*); void send(File, const String&, const String& contentType=String(), bool download=false);
+  void send(FS&, const String&, const String& contentType=String(), bool download=false);
+  AsyncWebServerResponse* beginResponse(int code, const String& contentType=String(), const String& content=String());
+  AsyncWebServerResponse* beginResponse(FS&, const String&, const String& contentType=String(), bool download=false);
+  AsyncWebServerResponse* beginResponse(File, const String&, const String& contentType=String(), bool download=false);
+  AsyncWebServerResponse* beginChunkedResponse(const String& contentType, AwsResponseFiller callback);
+  AsyncWebServerResponse* beginResponse(const String& contentType, size_t len, AwsResponseFiller callback);
+  AsyncResponseStream* beginResponseStream(const String& contentType, size_t bufferSize=1460);
+  bool hasHeader(const String&) const; AsyncWebHeader* getHeader(const String&) const;
+  bool hasParam(const String&, bool post=false, bool file=false) const; AsyncWebParameter* getParam(const String&, bool post=false, bool file=false) const;
+  bool hasArg(const char*) const; const String& arg(const String&) const; size_t contentLength() const;
+  void onDisconnect(ArDisconnectHandler fn); IPAddress client();
+};
+typedef std::function<void(AsyncWebServerRequest*)> ArRequestHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest*, const String&, size_t, uint8_t*, size_t, bool)> ArUploadHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest*, uint8_t*, size_t, size_t, size_t)> ArBodyHandlerFunction;
+class AsyncWebHandler { public: virtual ~AsyncWebHandler(); };
+class AsyncCallbackWebHandler : public AsyncWebHandler {};
+class AsyncEventSourceClient { public: void send(const char*, const char* event=nullptr, uint32_t id=0, uint32_t reconnect=0); void close(); bool connected() const; uint32_t lastId() const; size_t packetsWaiting() const; };
+typedef std::function<void(AsyncEventSourceClient*)> ArEventHandlerFunction;
+class AsyncEventSource : public AsyncWebHandler { public: AsyncEventSource(const String&); void onConnect(ArEventHandlerFunction); void send(const char*, const char* event=nullptr, uint32_t id=0, uint32_t reconnect=0); size_t count() const; size_t avgPacketsWaiting() const; void close(); };
+class AsyncWebServer { public: AsyncWebServer(uint16_t); void begin(); void end();
+  AsyncCallbackWebHandler& on(const char*, ArRequestHandlerFunction);
+  AsyncCallbackWebHandler& on(const char*, WebRequestMethodComposite, ArRequestHandlerFunction);
+  AsyncCallbackWebHandler& on(const char*, WebRequestMethodComposite, ArRequestHandlerFunction, ArUploadHandlerFunction);
+  AsyncCallbackWebHandler& on(const char*, WebRequestMethodComposite, ArRequestHandlerFunction, ArUploadHandlerFunction, ArBodyHandlerFunction);
+  AsyncWebHandler& addHandler(AsyncWebHandler*); void onNotFound(ArRequestHandlerFunction); void onRequestBody(ArBodyHandlerFunction); };
@@ -0,0 +1,7 @@
+#pragma once
+#include <Arduino.h>
+enum SeekMode { SeekSet, SeekCur, SeekEnd };
+class File : public Stream { public: File(); operator bool() const; size_t size() const; void close(); size_t write(uint8_t) override; size_t write(const uint8_t*, size_t) override; size_t write(const char*, size_t); int available() override; int read() override; size_t read(uint8_t*, size_t); int peek() override; bool seek(uint32_t, SeekMode = SeekSet); size_t position() const; const char* name() const; const char* fullName() const; bool isDirectory() const; void flush() override; bool truncate(uint32_t); };
+class Dir { public: bool next(); String fileName(); size_t fileSize(); File openFile(const char*); bool isFile() const; };
+struct FSInfo { size_t totalBytes, usedBytes, blockSize, pageSize, maxOpenFiles, maxPathLength; };
+class FS { public: bool begin(); File open(const String&, const char*); File open(const char*, const char*); bool exists(const String&); bool exists(const char*); bool remove(const String&); bool remove(const char*); bool rename(const String&, const String&); bool rename(const char*, const char*); Dir openDir(const String&); Dir openDir(const char*); bool info(FSInfo&); bool mkdir(const char*); bool mkdir(const String&); bool rmdir(const char*); };
@@ -0,0 +1,3 @@
+#pragma once
+#include <Arduino.h>
+class IPAddress { public: IPAddress(); IPAddress(uint8_t,uint8_t,uint8_t,uint8_t); String toString() const; operator uint32_t() const; bool isSet() const; };
@@ -0,0 +1,3 @@
+#pragma once
+#include <Arduino.h>
+class ModbusMaster { public: static const uint8_t ku8MBSuccess = 0; static const uint8_t ku8MBResponseTimedOut = 0xE2; void begin(uint8_t, Stream&); void preTransmission(void(*)()); void postTransmission(void(*)()); void clearResponseBuffer(); void clearTransmitBuffer(); uint8_t readHoldingRegisters(uint16_t, uint16_t); uint8_t readInputRegisters(uint16_t, uint16_t); uint16_t getResponseBuffer(uint8_t); uint8_t writeSingleRegister(uint16_t, uint16_t); uint8_t writeMultipleRegisters(uint16_t, uint16_t); uint8_t setTransmitBuffer(uint8_t, uint16_t); };
@@ -0,0 +1,9 @@
+#pragma once
+#include <WiFiClient.h>
+#define MQTT_MAX_PACKET_SIZE 256
+#define MQTT_CALLBACK_SIGNATURE std::function<void(char*, uint8_t*, unsigned int)> callback
+class PubSubClient { public: PubSubClient(Client&); PubSubClient& setServer(const char*, uint16_t); PubSubClient& setCallback(MQTT_CALLBACK_SIGNATURE); bool setBufferSize(uint16_t); uint16_t getBufferSize(); PubSubClient& setKeepAlive(uint16_t); PubSubClient& setSocketTimeout(uint16_t);
+  bool connect(const char*); bool connect(const char*, const char*, const char*); bool connect(const char*, const char*, uint8_t, bool, const char*); bool connect(const char*, const char*, const char*, const char*, uint8_t, bool, const char*); bool connect(const char*, const char*, const char*, const char*, uint8_t, bool, const char*, bool);
+  bool publish(const char*, const char*); bool publish(const char*, const char*, bool); bool publish(const char*, const uint8_t*, unsigned int); bool publish(const char*, const uint8_t*, unsigned int, bool);
+  bool beginPublish(const char*, unsigned int, bool); int endPublish(); size_t write(uint8_t); size_t write(const uint8_t*, size_t);
+  bool subscribe(const char*); bool subscribe(const char*, uint8_t); bool unsubscribe(const char*); bool loop(); bool connected(); int state(); void disconnect(); };
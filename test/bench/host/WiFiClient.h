@@ -0,0 +1,6 @@
+#pragma once
+#include <Arduino.h>
+#include <IPAddress.h>
+class Client : public Stream { public: virtual int connect(IPAddress, uint16_t); virtual int connect(const char*, uint16_t); virtual uint8_t connected(); virtual void stop(); virtual operator bool(); };
+class WiFiClient : public Client { public: WiFiClient(); size_t availableForWrite(); void setNoDelay(bool); void setTimeout(unsigned long); IPAddress remoteIP(); uint16_t remotePort(); bool flush(unsigned int maxWaitMs); using Print::write; size_t write(uint8_t) override; size_t write(const uint8_t*, size_t) override; void keepAlive(uint16_t=7200,uint16_t=75,uint8_t=9); };
+class WiFiServer { public: WiFiServer(uint16_t); void begin(); WiFiClient available(); WiFiClient accept(); bool hasClient(); void setNoDelay(bool); };
@@ -0,0 +1,8 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <functional>
+void esp_delay(unsigned long ms, const std::function<bool()>& blocked, unsigned long intvl_ms);
+void esp_delay(unsigned long ms);
+void settimeofday_cb(const std::function<void(bool)>& cb);
+uint32_t crc32(const void* data, size_t length, uint32_t crc = 0xffffffff);
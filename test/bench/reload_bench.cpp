@@ -0,0 +1,119 @@
+// 100-slave reload: the per-slave build step of modbusReloadSlaves(), old JSON merge
+// (f9ed4d5) vs compiled slots and patches. Build with -DOLD_PATH for the old tree.
+#include "ModBusHandler.h"
+#include "TemplateManager.h"
+#include <chrono>
+#include <cstdio>
+#include <new>
+#include <vector>
+#include <algorithm>
+
+size_t allocCount = 0, allocBytes = 0;
+void* operator new(size_t n) { allocCount++; allocBytes += n; void* p = malloc(n); if (!p) throw std::bad_alloc(); return p; }
+void* operator new[](size_t n) { allocCount++; allocBytes += n; void* p = malloc(n); if (!p) throw std::bad_alloc(); return p; }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+extern JsonDocument templatesCache;
+extern bool cacheLoaded;
+bool buildSlaveFromConfig(SensorSlave& slave, JsonObject slaveObj);
+#ifndef OLD_PATH
+void freeCompiledTemplates();
+int getParamSetCount();
+#endif
+
+const char* kTemplates = R"({
+ "G01S": {"sensor": {"tempdivider": 1.0, "humiddivider": 1.0}},
+ "HeylaParam": {"meter": {"Current": {"divider": 1.0}, "zeroPhaseCurrent": {"divider": 1.0},
+   "ActivePower": {"divider": 1000.0}, "totalActivePower": {"divider": 10000.0},
+   "ReactivePower": {"divider": 1000.0}, "totalReactivePower": {"divider": 10000.0},
+   "ApparentPower": {"divider": 1000.0}, "totalApparentPower": {"divider": 10000.0},
+   "PowerFactor": {"divider": 1.0}, "totalPowerFactor": {"divider": 1.0}}},
+ "HeylaVoltage": {"voltage": {"Voltage": {"divider": 1.0}, "phaseVoltageMean": {"divider": 1.0}, "zeroSequenceVoltage": {"divider": 1.0}}},
+ "HeylaEnergy9": {"energy": {"totalActiveEnergy": {"divider": 1.0}, "importActiveEnergy": {"divider": 1.0},
+   "exportActiveEnergy": {"divider": 1.0}, "totalReactiveEnergy": {"divider": 1.0}, "importReactiveEnergy": {"divider": 1.0},
+   "exportReactiveEnergy": {"divider": 1.0}}},
+ "HeylaEnergy27": {"energy": {"totalActiveEnergy": {"divider": 1.0}, "importActiveEnergy": {"divider": 1.0}, "exportActiveEnergy": {"divider": 1.0}}}
+})";
+
+const char* kTypes[] = { "G01S", "HeylaParam", "HeylaVoltage", "HeylaEnergy9", "HeylaEnergy27" };
+const char* kOverrides[] = {
+    R"({"sensor": {"tempdivider": 10.0}})",
+    R"({"meter": {"ActivePower": {"divider": 100.0}, "Current": {"divider": 10.0}}})",
+    R"({"voltage": {"Voltage": {"divider": 10.0}}})",
+    R"({"energy": {"totalActiveEnergy": {"divider": 100.0}}})",
+    R"({"energy": {"importActiveEnergy": {"divider": 10.0}}})"
+};
+
+String buildSlavesJson(int count) {
+    String json = "[";
+    char entry[512];
+    for (int i = 0; i < count; i++) {
+        int type = i % 5;
+        snprintf(entry, sizeof(entry),
+                 "%s{\"id\": %d, \"name\": \"dev%03d\", \"deviceType\": \"%s\", \"startReg\": 0, \"numReg\": %d,"
+                 " \"mqttTopic\": \"site/dev%03d\", \"ct\": 1.0, \"pt\": 1.0, \"registerSize\": 1%s%s}",
+                 i ? "," : "", i % 247 + 1, i, kTypes[type], type == 1 ? 20 : 10, i,
+                 (i % 3 == 0) ? ", \"override\": " : "", (i % 3 == 0) ? kOverrides[type] : "");
+        json += entry;
+    }
+    return json + "]";
+}
+
+struct Result { double medianUs; size_t allocs; size_t bytes; };
+
+template <typename Prepare>
+Result measure(JsonArray slavesArray, int rounds, Prepare prepare) {
+    std::vector<double> times;
+    size_t allocs = 0, bytes = 0;
+    for (int r = 0; r < rounds; r++) {
+        prepare();
+        SensorSlave* table = new SensorSlave[slavesArray.size()]();
+        size_t a0 = allocCount, b0 = allocBytes;
+        auto t0 = std::chrono::steady_clock::now();
+        for (size_t j = 0; j < slavesArray.size(); j++) {
+            buildSlaveFromConfig(table[j], slavesArray[j]);
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        allocs = allocCount - a0; bytes = allocBytes - b0;
+        times.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+        delete[] table;
+    }
+    std::sort(times.begin(), times.end());
+    return { times[times.size() / 2], allocs, bytes };
+}
+
+int main() {
+    DeserializationError tErr = deserializeJson(templatesCache, kTemplates);
+    printf("templates %s, %zu types\n", tErr.c_str(), templatesCache.size());
+    cacheLoaded = true;
+    JsonDocument slavesDoc;
+    DeserializationError sErr = deserializeJson(slavesDoc, buildSlavesJson(100));
+    printf("slaves %s, %zu entries\n", sErr.c_str(), slavesDoc.size());
+    JsonArray slavesArray = slavesDoc.as<JsonArray>();
+
+    // Sanity: slave 6 is a HeylaParam with ActivePower=100 and Current=10 overrides
+    SensorSlave probe{};
+    buildSlaveFromConfig(probe, slavesArray[6]);
+#ifdef OLD_PATH
+    const MeterConfig& meter = probe.config.meter;
+    printf("probe dividers: Current %g ActivePower %g totalActivePower %g PowerFactor %g\n", meter.Current.divider,
+           meter.ActivePower.divider, meter.totalActivePower.divider, meter.PowerFactor.divider);
+    Result warm = measure(slavesArray, 401, [] {});
+    printf("old (merge per slave):      %8.1f us / 100 slaves, %5zu allocations, %7zu bytes\n",
+           warm.medianUs, warm.allocs, warm.bytes);
+#else
+    printf("probe dividers (by slot):");
+    for (float v : probe.config->values) if (v != 0) printf(" %g", v);
+    printf("\n");
+    Result cold = measure(slavesArray, 401, [] { freeCompiledTemplates(); });
+    Result warm = measure(slavesArray, 401, [] {});
+    printf("new, templates recompiled:  %8.1f us / 100 slaves, %5zu allocations, %7zu bytes\n",
+           cold.medianUs, cold.allocs, cold.bytes);
+    printf("new, compiled and cached:   %8.1f us / 100 slaves, %5zu allocations, %7zu bytes\n",
+           warm.medianUs, warm.allocs, warm.bytes);
+    printf("param sets %d\n", getParamSetCount());
+#endif
+}
@@ -0,0 +1,36 @@
+#!/bin/bash
+# Host benchmark of decodeSlaveData(): the hand-written decoders of 7295312
+# against the data-driven decode programs in src/. "sink" rows fold each
+# root[...] = value into a checksum so only the decode is timed; "dom" rows
+# write a real JSON tree.
+#
+#   test/bench/run_decode_bench.sh [baseline-commit]
+set -e
+
+BENCH="$(cd "$(dirname "$0")" && pwd)"
+REPO="$(cd "$BENCH/../.." && pwd)"
+BASELINE="${1:-7295312}"
+WORK="$(mktemp -d)"
+trap 'rm -rf "$WORK"' EXIT
+
+CXX="${CXX:-g++}"
+FLAGS="-std=gnu++17 -O2 -ffunction-sections -fdata-sections -Wl,--gc-sections -I$BENCH/host -I$WORK"
+EXTRACT="python3 $BENCH/extract_functions.py"
+
+mkdir -p "$WORK/old"
+git -C "$REPO" archive "$BASELINE" src | tar -x -C "$WORK/old"
+$EXTRACT "$WORK/old/src/ModBusHandler.cpp" convertRegisterToTemperature convertRegisterToHumidity \
+    calculateCurrent calculateSinglePhasePower calculateThreePhasePower calculatePowerFactor \
+    calculateVoltage readEnergyValue processSensorData processMeterData processVoltageData \
+    processEnergyData9 processEnergyData27 decodeSlaveData readAllRegistersIntoArray combineRegisters \
+    combineRegistersBySize convertToSigned > "$WORK/old_decode.body"
+$EXTRACT "$REPO/src/ModBusHandler.cpp" decodeSlaveData readAllRegistersIntoArray > "$WORK/new_decode.body"
+
+$CXX $FLAGS -DOLD_PATH -I"$WORK/old/src" "$BENCH/decode_bench.cpp" "$BENCH/host_shim.cpp" -o "$WORK/decode_old"
+$CXX $FLAGS -I"$REPO/src" "$BENCH/decode_bench.cpp" "$BENCH/host_shim.cpp" "$REPO/src/RegisterMap.cpp" \
+    -o "$WORK/decode_new"
+
+echo "== $BASELINE"
+"$WORK/decode_old"
+echo "== working tree"
+"$WORK/decode_new"
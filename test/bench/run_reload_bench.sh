@@ -0,0 +1,47 @@
+#!/bin/bash
+# Host benchmark of the per-slave build step of modbusReloadSlaves() for 100
+# slaves: the JSON merge of f9ed4d5 against the compiled templates in src/.
+# Needs g++ and git; the firmware libraries are replaced by the stand-ins in host/.
+#
+#   test/bench/run_reload_bench.sh [baseline-commit]
+set -e
+
+BENCH="$(cd "$(dirname "$0")" && pwd)"
+REPO="$(cd "$BENCH/../.." && pwd)"
+BASELINE="${1:-f9ed4d5}"
+WORK="$(mktemp -d)"
+trap 'rm -rf "$WORK"' EXIT
+
+CXX="${CXX:-g++}"
+FLAGS="-std=gnu++17 -O2 -ffunction-sections -fdata-sections -Wl,--gc-sections -I$BENCH/host"
+EXTRACT="python3 $BENCH/extract_functions.py"
+
+# Baseline: the old per-device parameter loaders and merge
+mkdir -p "$WORK/old"
+git -C "$REPO" archive "$BASELINE" src | tar -x -C "$WORK/old"
+{
+    echo '#include "ModBusHandler.h"'
+    echo '#include "TemplateManager.h"'
+    $EXTRACT "$WORK/old/src/ModBusHandler.cpp" determineDeviceTypeFromString loadDeviceParameters \
+        loadG01SParameters loadMeterParameters loadVoltageParameters loadEnergyParameters9 \
+        loadEnergyParameters27 buildSlaveFromConfig
+} > "$WORK/old_build.cpp"
+$EXTRACT --no-fs "$WORK/old/src/TemplateManager.cpp" "$WORK/old_tm.cpp"
+
+# Working tree: compiled templates, parameter slots and interned sets
+{
+    echo '#include "ModBusHandler.h"'
+    echo '#include "TemplateManager.h"'
+    echo '#include "ParamCache.h"'
+    $EXTRACT "$REPO/src/ModBusHandler.cpp" buildSlaveFromConfig
+} > "$WORK/new_build.cpp"
+$EXTRACT --no-fs "$REPO/src/TemplateManager.cpp" "$WORK/new_tm.cpp"
+
+$CXX $FLAGS -DOLD_PATH -I"$WORK/old/src" "$BENCH/reload_bench.cpp" "$BENCH/host_shim.cpp" \
+    "$WORK/old_build.cpp" "$WORK/old_tm.cpp" -o "$WORK/reload_old"
+$CXX $FLAGS -I"$REPO/src" "$BENCH/reload_bench.cpp" "$BENCH/host_shim.cpp" \
+    "$WORK/new_build.cpp" "$WORK/new_tm.cpp" "$REPO/src/ParamCache.cpp" "$REPO/src/RegisterMap.cpp" \
+    -o "$WORK/reload_new"
+
+"$WORK/reload_old"
+"$WORK/reload_new"